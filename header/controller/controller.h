@@ -8,6 +8,7 @@
 #include "model.h" // include Model
 #include "view.h" // include View
 #include "query.h"
+#include "evaluationjob.h" // queries processed off the frame loop
 
 class Controller {
 public:
@@ -15,6 +16,7 @@ public:
 
 	using sptrModel = std::shared_ptr<Model>;
 	using sptrView = std::shared_ptr<View>;
+	using sptrJob = std::shared_ptr<evaluationJob>;
 
 	// constructor and destructor
 
@@ -30,4 +32,5 @@ public:
 private:
 	sptrModel model_; // pointer to the only object of class Model
 	sptrView view_; // pointer to the only object of class View
+	sptrJob job_; // query being processed, null if none
 };
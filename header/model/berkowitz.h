@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "matrix.h"
+#include "parallel.h"
+
+// characteristic polynomial det(x I - A) of a square matrix by the berkowitz algorithm:
+// only additions and multiplications, so it works in any commutative ring; the
+// coefficients come highest degree first, the leading one is 1
+template <typename Field>
+std::vector<Field> berkowitz(const Matrix<Field>& matrix);
+
+
+//------------------------------------------------------------------
+
+
+// rows of a matrix-vector product before they are split between threads
+constexpr size_t BERKOWITZ_PARALLEL_ROWS = 64;
+
+// the polynomial of the leading (r + 1) x (r + 1) block is T c, c the polynomial of the
+// leading r x r block A_r and T the lower triangular toeplitz matrix with the first column
+// 1, -a, -R S, -R A_r S, ..., -R A_r^(r - 1) S; here S is the column above and R the row
+// left of the new diagonal entry a, and A_r^k S are repeated matrix-vector products
+template <typename Field>
+std::vector<Field> berkowitz(const Matrix<Field>& matrix) {
+	size_t n = matrix.getRow();
+	const Field zero(0);
+	std::vector<Field> coefficients = {Field(1), zero - matrix[0][0]};
+
+	std::vector<Field> column;
+	std::vector<Field> product;
+	std::vector<Field> toeplitz;
+	for (size_t r = 1; r < n; ++r) {
+		toeplitz.assign(r + 2, zero);
+		toeplitz[0] = Field(1);
+		toeplitz[1] = zero - matrix[r][r];
+
+		column.assign(r, zero);
+		for (size_t i = 0; i < r; ++i) {
+			column[i] = matrix[i][r];
+		}
+		product.assign(r, zero);
+		for (size_t k = 0; k < r; ++k) {
+			Field sum = zero;
+			for (size_t j = 0; j < r; ++j) {
+				sum += matrix[r][j] * column[j];
+			}
+			toeplitz[k + 2] = zero - sum;
+			if (k + 1 == r) {
+				break;
+			}
+
+			// column = A_r column
+			auto body = [&](size_t i) {
+				Field value = zero;
+				for (size_t j = 0; j < r; ++j) {
+					value += matrix[i][j] * column[j];
+				}
+				product[i] = value;
+			};
+			if (r >= BERKOWITZ_PARALLEL_ROWS) {
+				parallelFor(0, r, body);
+			}
+			else {
+				for (size_t i = 0; i < r; ++i) {
+					body(i);
+				}
+			}
+			column.swap(product);
+		}
+
+		std::vector<Field> next(r + 2, zero);
+		for (size_t i = 0; i < r + 2; ++i) {
+			for (size_t j = 0; j <= i && j <= r; ++j) {
+				next[i] += toeplitz[i - j] * coefficients[j];
+			}
+		}
+		coefficients.swap(next);
+	}
+
+	return coefficients;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class bigInteger {
+public:
+	// constructors and operator =
+
+	bigInteger(long long value = 0);
+	bigInteger(const bigInteger& other) = default;
+	bigInteger& operator=(const bigInteger& other) = default;
+	~bigInteger() = default;
+
+	// arithmetic assignments
+
+	bigInteger& operator+=(const bigInteger& rhs);
+	bigInteger& operator-=(const bigInteger& rhs);
+	bigInteger& operator*=(const bigInteger& rhs);
+	bigInteger& operator/=(const bigInteger& rhs);
+	bigInteger& operator%=(const bigInteger& rhs);
+
+	// unary minus
+
+	bigInteger operator-() const;
+
+	// quotient and remainder rounded towards zero
+
+	static void divide(const bigInteger& lhs, const bigInteger& rhs, bigInteger& quotient, bigInteger& remainder);
+
+	// remainder of the absolute value by a word size number
+
+	uint64_t modulo(uint64_t value) const;
+
+	// sign and size
+
+	bool isZero() const;
+	bool isNegative() const;
+	size_t bitLength() const;
+	bigInteger abs() const;
+
+	// compare absolute values, returns -1, 0 or 1
+
+	static int compareAbs(const bigInteger& lhs, const bigInteger& rhs);
+
+	// presentations
+
+	bool fitsInLongLong() const;
+	long long toLongLong() const;
+	double toDouble() const;
+	std::string toString() const;
+
+private:
+	// remove leading zero limbs
+
+	void trim();
+
+	// operations on absolute values
+
+	static std::vector<uint32_t> addAbs(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs);
+	static std::vector<uint32_t> subAbs(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs);
+	static uint32_t divideSmall(std::vector<uint32_t>& limbs, uint32_t value);
+
+	std::vector<uint32_t> limbs_; // absolute value in base 2^32, least significant limb first
+	bool negative_; // sign of the number
+};
+
+// more arithmetics
+
+bigInteger operator+(const bigInteger& lhs, const bigInteger& rhs);
+bigInteger operator-(const bigInteger& lhs, const bigInteger& rhs);
+bigInteger operator*(const bigInteger& lhs, const bigInteger& rhs);
+bigInteger operator/(const bigInteger& lhs, const bigInteger& rhs);
+bigInteger operator%(const bigInteger& lhs, const bigInteger& rhs);
+
+// greatest common divisor of absolute values
+
+bigInteger gcd(bigInteger lhs, bigInteger rhs);
+
+// comparisons
+
+bool operator==(const bigInteger& lhs, const bigInteger& rhs);
+bool operator!=(const bigInteger& lhs, const bigInteger& rhs);
+bool operator<(const bigInteger& lhs, const bigInteger& rhs);
+bool operator>(const bigInteger& lhs, const bigInteger& rhs);
+bool operator<=(const bigInteger& lhs, const bigInteger& rhs);
+bool operator>=(const bigInteger& lhs, const bigInteger& rhs);
+
+// output
+
+std::ostream& operator<<(std::ostream& out, const bigInteger& number);
@@ -10,7 +10,7 @@ class complexNumber {
 public:
 	// constructors and operator =
 
-	complexNumber(float re, float im);
+	complexNumber(float re = 0, float im = 0);
 	complexNumber(const std::string& number);
 	complexNumber(const complexNumber& other);
 	complexNumber& operator=(const complexNumber& other);
@@ -60,6 +60,10 @@ complexNumber operator/(const complexNumber& lhs, const complexNumber& rhs);
 bool operator==(const complexNumber& lhs, const complexNumber& rhs);
 bool operator!=(const complexNumber& lhs, const complexNumber& rhs);
 
+// parse numbers like "2", "-i" or "1.5-2i", false if the text is not a complex number
+
+bool parseComplex(const std::string& text, complexNumber& number);
+
 // input and output streams
 
 std::ostream& operator<<(std::ostream& out, const complexNumber& number);
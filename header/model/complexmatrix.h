@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "complex.h"
+#include "matrix.h"
+
+// complex matrix stored as two separate real planes, so that every kernel works
+// on contiguous float rows instead of interleaved (re, im) pairs
+class complexMatrix {
+public:
+	// constructors and destructor
+	complexMatrix(size_t row, size_t col);
+	complexMatrix(const Matrix<float>& re, const Matrix<float>& im);
+	complexMatrix(const std::vector<std::vector<complexNumber>>& matrix);
+	~complexMatrix() = default;
+	complexMatrix(const complexMatrix& other) = default;
+	complexMatrix& operator=(const complexMatrix& other) = default;
+
+	// accessibility
+	complexNumber get(size_t row, size_t col) const;
+	void set(size_t row, size_t col, const complexNumber& value);
+	const Matrix<float>& re() const;
+	const Matrix<float>& im() const;
+
+	// arithmetics
+	complexMatrix& operator+=(const complexMatrix& rhs);
+	complexMatrix& operator-=(const complexMatrix& rhs);
+	complexMatrix operator+(const complexMatrix& rhs) const;
+	complexMatrix operator-(const complexMatrix& rhs) const;
+	complexMatrix& operator*=(const complexNumber& rhs);
+	complexMatrix operator*(const complexNumber& rhs) const;
+	complexMatrix operator*(const complexMatrix& rhs) const;
+
+	// determinant
+	complexNumber det() const;
+
+	// transposition
+	complexMatrix transposed() const;
+
+	// rank
+	size_t rank() const;
+
+	// invert matrix
+	complexMatrix inverted() const;
+
+	// trace
+	complexNumber trace() const;
+
+	// reduced row echelon form
+	complexMatrix getReducedRowEchelonForm() const;
+
+	// getters
+	size_t getRow() const;
+	size_t getCol() const;
+	std::vector<std::vector<complexNumber>> getMatrix() const;
+
+private:
+	// gauss-jordan elimination with partial pivoting on the first limit columns,
+	// returns the pivot columns and accumulates the determinant of the eliminated part
+	std::vector<size_t> eliminate(size_t limit, complexNumber& determinant);
+
+	// swap 2 rows with each other
+	void swapRow(size_t first, size_t second);
+
+	// row target -= (koef_re + i * koef_im) * row source, starting from column start
+	void subtractRow(size_t target, size_t source, float koef_re, float koef_im, size_t start);
+
+	// row *= (koef_re + i * koef_im)
+	void scaleRow(size_t row, float koef_re, float koef_im);
+
+	Matrix<float> re_; // real plane
+	Matrix<float> im_; // imaginary plane
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+// eigenvalues of a square real matrix: balancing, householder reduction to upper
+// hessenberg form and francis double-shift qr with deflation;
+// false if the qr iteration does not converge
+bool realEigenvalues(const Matrix<double>& matrix, std::vector<std::complex<double>>& values, std::string& error);
+
+// eigenvalues of a square complex matrix given by its real and imaginary planes:
+// householder reduction to upper hessenberg form and single-shift qr with deflation
+bool complexEigenvalues(const Matrix<double>& re, const Matrix<double>& im,
+						std::vector<std::complex<double>>& values, std::string& error);
+
+// characteristic polynomial det(x I - A) from the upper hessenberg form, the coefficients
+// come highest degree first
+void realCharacteristicPolynomial(const Matrix<double>& matrix, std::vector<double>& coefficients);
+void complexCharacteristicPolynomial(const Matrix<double>& re, const Matrix<double>& im,
+									 std::vector<std::complex<double>>& coefficients);
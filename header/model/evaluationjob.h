@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "model.h"
+#include "progress.h"
+#include "query.h"
+
+// query processed by the model on a thread of its own, so that the interface keeps drawing
+// frames during a long computation and polls the job every frame for its progress and answer;
+// one job runs at a time, since the model keeps the variables and the answers between queries
+class evaluationJob {
+public:
+	evaluationJob(const std::shared_ptr<Model>& model, const Query& query);
+	evaluationJob(const evaluationJob& other) = delete;
+	evaluationJob& operator=(const evaluationJob& other) = delete;
+
+	// a job still running is cancelled and waited for
+	~evaluationJob();
+
+	bool isFinished() const;
+
+	// ask the kernels to stop at their next step, the answer then reports the cancellation
+	void cancel();
+	bool isCancelled() const;
+
+	// done of total steps of the kernel which reported last, total is 0 before any report
+	void getProgress(size_t& done, size_t& total) const;
+
+	// answer of the query, only valid once the job is finished
+	const Answer& getAnswer() const;
+
+private:
+	void process();
+
+	std::shared_ptr<Model> model_;
+	Query query_;
+	Answer answer_;
+	evaluationProgress progress_;
+	std::atomic<bool> is_finished_{false};
+	std::thread thread_; // started last, once the members it uses are set up
+};
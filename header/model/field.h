@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "complex.h"
+#include "rational.h"
+#include "residue.h"
+
+// everything the evaluator needs to know about a field besides its arithmetic:
+// parsing cells and numbers, printing, zero tests, pivot magnitudes and powers
+
+template <typename Field>
+struct fieldTraits;
+
+// parse a real number written as "a" or "a/b"
+template <typename Real>
+bool parseReal(const std::string& text, Real& value) {
+	size_t slash = text.find('/');
+	std::string first = text.substr(0, slash);
+	std::string second = slash == std::string::npos ? "" : text.substr(slash + 1);
+
+	char* pend;
+	value = std::strtod(first.c_str(), &pend);
+	if (first == "" || pend != first.c_str() + first.length()) {
+		return false;
+	}
+
+	if (slash != std::string::npos) {
+		Real denominator = std::strtod(second.c_str(), &pend);
+		if (second == "" || pend != second.c_str() + second.length() || denominator == 0) {
+			return false;
+		}
+		value /= denominator;
+	}
+
+	return true;
+}
+
+// real exponent of a real number
+template <typename Real>
+bool realPower(const Real& base, const Real& exponent, Real& result, std::string& error) {
+	result = std::pow(base, exponent);
+
+	return true;
+}
+
+// integer value of a real number, false if it has a fractional part
+template <typename Real>
+bool realToInteger(const Real& value, long long& integer) {
+	if (value != std::trunc(value) || std::abs(value) > 1e15) {
+		return false;
+	}
+	integer = static_cast<long long>(value);
+
+	return true;
+}
+
+template <>
+struct fieldTraits<float> {
+	static bool parse(const std::string& text, float& value) {
+		return parseReal(text, value);
+	}
+
+	static std::string toString(const float& value) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.7g", value);
+		return buffer;
+	}
+
+	static float magnitude(const float& value) {
+		return std::abs(value);
+	}
+
+	static bool isZero(const float& value) {
+		return value == 0;
+	}
+
+	static bool power(const float& base, const float& exponent, float& result, std::string& error) {
+		return realPower(base, exponent, result, error);
+	}
+
+	static bool toInteger(const float& value, long long& integer) {
+		return realToInteger(value, integer);
+	}
+};
+
+template <>
+struct fieldTraits<double> {
+	static bool parse(const std::string& text, double& value) {
+		return parseReal(text, value);
+	}
+
+	static std::string toString(const double& value) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+		return buffer;
+	}
+
+	static double magnitude(const double& value) {
+		return std::abs(value);
+	}
+
+	static bool isZero(const double& value) {
+		return value == 0;
+	}
+
+	static bool power(const double& base, const double& exponent, double& result, std::string& error) {
+		return realPower(base, exponent, result, error);
+	}
+
+	static bool toInteger(const double& value, long long& integer) {
+		return realToInteger(value, integer);
+	}
+};
+
+template <>
+struct fieldTraits<complexNumber> {
+	static bool parse(const std::string& text, complexNumber& value) {
+		return parseComplex(text, value);
+	}
+
+	static std::string toString(const complexNumber& value) {
+		return value.toString();
+	}
+
+	static float magnitude(const complexNumber& value) {
+		return value.length();
+	}
+
+	static bool isZero(const complexNumber& value) {
+		return value.re() == 0 && value.im() == 0;
+	}
+
+	// principal value through the polar form, only real exponents
+	static bool power(const complexNumber& base, const complexNumber& exponent, complexNumber& result, std::string& error) {
+		if (exponent.im() != 0) {
+			error = "Semantic error: can not take a complex power";
+			return false;
+		}
+
+		if (isZero(base)) {
+			result = complexNumber(exponent.re() == 0 ? 1 : 0, 0);
+			return true;
+		}
+
+		float length = std::pow(base.length(), exponent.re());
+		float angle = std::atan2(base.im(), base.re()) * exponent.re();
+		result = complexNumber(length * std::cos(angle), length * std::sin(angle));
+		return true;
+	}
+
+	static bool toInteger(const complexNumber& value, long long& integer) {
+		return value.im() == 0 && realToInteger(value.re(), integer);
+	}
+};
+
+template <>
+struct fieldTraits<rationalNumber> {
+	static bool parse(const std::string& text, rationalNumber& value) {
+		return parseRational(text, value);
+	}
+
+	static std::string toString(const rationalNumber& value) {
+		return value.toString();
+	}
+
+	// every nonzero pivot is exact, so any of them will do
+	static float magnitude(const rationalNumber& value) {
+		return value.isZero() ? 0 : 1;
+	}
+
+	static bool isZero(const rationalNumber& value) {
+		return value.isZero();
+	}
+
+	// only integer exponents keep the result rational
+	static bool power(const rationalNumber& base, const rationalNumber& exponent, rationalNumber& result, std::string& error) {
+		long long rest;
+		if (!toInteger(exponent, rest)) {
+			error = "Semantic error: can not take a rational number to a fractional power";
+			return false;
+		}
+		if (rest < 0 && base.isZero()) {
+			error = "Semantic error: can not divide by 0";
+			return false;
+		}
+
+		rationalNumber helper = rest < 0 ? rationalNumber(1) / base : base;
+		rest = rest < 0 ? -rest : rest;
+		result = rationalNumber(1);
+		while (rest != 0) {
+			if (rest & 1) {
+				result *= helper;
+			}
+			helper *= helper;
+			rest >>= 1;
+		}
+
+		return true;
+	}
+
+	static bool toInteger(const rationalNumber& value, long long& integer) {
+		bigInteger numerator = value.numerator();
+		if (!value.isInteger() || !numerator.fitsInLongLong()) {
+			return false;
+		}
+		integer = numerator.toLongLong();
+
+		return true;
+	}
+};
+
+template <size_t N>
+struct fieldTraits<residue<N>> {
+	// integers and fractions "a/b" of integers
+	static bool parse(const std::string& text, residue<N>& value) {
+		size_t slash = text.find('/');
+		residue<N> numerator;
+		if (!parseInteger(text.substr(0, slash), numerator)) {
+			return false;
+		}
+
+		if (slash == std::string::npos) {
+			value = numerator;
+			return true;
+		}
+
+		residue<N> denominator;
+		if (!parseInteger(text.substr(slash + 1), denominator) || isZero(denominator)) {
+			return false;
+		}
+		value = numerator / denominator;
+
+		return true;
+	}
+
+	static std::string toString(const residue<N>& value) {
+		return std::to_string(value.getValue());
+	}
+
+	static float magnitude(const residue<N>& value) {
+		return value.getValue() == 0 ? 0 : 1;
+	}
+
+	static bool isZero(const residue<N>& value) {
+		return value.getValue() == 0;
+	}
+
+	// the exponent is an integer written in the expression, a residue would have lost it to
+	// the modulus; negative exponents go through the inverse
+	static bool power(const residue<N>& base, long long exponent, residue<N>& result, std::string& error) {
+		if (exponent < 0 && isZero(base)) {
+			error = "Semantic error: can not divide by 0";
+			return false;
+		}
+
+		unsigned long long rest = exponent < 0 ? 0ULL - static_cast<unsigned long long>(exponent) : exponent;
+		residue<N> helper = exponent < 0 ? residue<N>(1) / base : base;
+		result = residue<N>(1);
+		while (rest != 0) {
+			if (rest & 1) {
+				result *= helper;
+			}
+			helper *= helper;
+			rest >>= 1;
+		}
+
+		return true;
+	}
+
+	// a residue stands for every integer of its class, so it has no integer value of its own
+	static bool toInteger(const residue<N>& value, long long& integer) {
+		return false;
+	}
+
+private:
+	static bool parseInteger(const std::string& text, residue<N>& value) {
+		if (text.empty() || text == "-") {
+			return false;
+		}
+
+		long long rest = 0;
+		long long modulus = residue<N>::modulus();
+		for (size_t i = text[0] == '-' ? 1 : 0; i < text.length(); ++i) {
+			if (text[i] < '0' || text[i] > '9') {
+				return false;
+			}
+			rest = (rest * 10 + (text[i] - '0')) % modulus;
+		}
+		if (text[0] == '-') {
+			rest = (modulus - rest) % modulus;
+		}
+		value = residue<N>(static_cast<int>(rest));
+
+		return true;
+	}
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <string>
+
+#include "berkowitz.h"
+#include "complex.h"
+#include "krylov.h"
+#include "matrix.h"
+#include "matrixfunction.h"
+
+// matrix kernels used by the evaluator, the generic versions work in any field
+// and the overloads below replace them with specialized ones where they exist
+
+template <typename Field>
+Matrix<Field> multiply(const Matrix<Field>& lhs, const Matrix<Field>& rhs);
+
+template <typename Field>
+Field determinant(const Matrix<Field>& matrix);
+
+// determinant of c X Y for square X and Y of one size, Y may be left out
+template <typename Field>
+Field scaledDeterminant(const Field& scale, const Matrix<Field>& lhs, const Matrix<Field>* rhs);
+
+template <typename Field>
+Matrix<Field> inverse(const Matrix<Field>& matrix);
+
+template <typename Field>
+size_t rank(const Matrix<Field>& matrix);
+
+// coefficients of det(x I - A) as a column, highest degree first
+template <typename Field>
+Matrix<Field> characteristicPolynomial(const Matrix<Field>& matrix);
+
+// eigenvalues as a column, false if the field has no eigenvalue kernel
+template <typename Field>
+bool eigenvalues(const Matrix<Field>& matrix, Matrix<Field>& values, std::string& error);
+
+// singular values as a column and the pseudo-inverse, false if the field has no svd kernel
+template <typename Field>
+bool singularValues(const Matrix<Field>& matrix, Matrix<Field>& values, std::string& error);
+
+template <typename Field>
+bool pseudoInverse(const Matrix<Field>& matrix, Matrix<Field>& result, std::string& error);
+
+// randomized sketches: numerical rank at a relative tolerance, leading singular values
+// and the spectral norm; false if the field has no sketching kernel
+template <typename Field>
+bool approximateRank(const Matrix<Field>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error);
+
+template <typename Field>
+bool leadingSingularValues(const Matrix<Field>& matrix, size_t count, size_t oversampling, Matrix<Field>& values, std::string& error);
+
+template <typename Field>
+bool normEstimate(const Matrix<Field>& matrix, double tolerance, Field& norm, std::string& error);
+
+// exp, log or sqrt of a square matrix, false if the field has no kernel for them
+template <typename Field>
+bool matrixFunction(const Matrix<Field>& matrix, matrixFunctionType function, Matrix<Field>& result, std::string& error);
+
+// solution X of A X = B for a square A, iterative methods of options only for real types; the
+// iterations of all the columns and their largest residual are reported, both 0 for elimination
+template <typename Field>
+bool solveSystem(const Matrix<Field>& matrix, const Matrix<Field>& rhs, const krylovOptions& options, Matrix<Field>& solution,
+				 size_t& iterations, double& residual, std::string& error);
+
+// exact determinant of integer matrices by the multi-modular engine
+float determinant(const Matrix<float>& matrix);
+
+// the pivots and the scale are multiplied as mantissas and powers of 2 in double, so that
+// the determinant only overflows if it does not fit the field itself
+float scaledDeterminant(const float& scale, const Matrix<float>& lhs, const Matrix<float>* rhs);
+double scaledDeterminant(const double& scale, const Matrix<double>& lhs, const Matrix<double>* rhs);
+
+// characteristic polynomial from the hessenberg form in double
+Matrix<float> characteristicPolynomial(const Matrix<float>& matrix);
+Matrix<double> characteristicPolynomial(const Matrix<double>& matrix);
+
+// eigenvalues of real matrices, a second column holds the imaginary parts if any
+bool eigenvalues(const Matrix<float>& matrix, Matrix<float>& values, std::string& error);
+bool eigenvalues(const Matrix<double>& matrix, Matrix<double>& values, std::string& error);
+
+// one-sided jacobi svd computed in double
+bool singularValues(const Matrix<float>& matrix, Matrix<float>& values, std::string& error);
+bool singularValues(const Matrix<double>& matrix, Matrix<double>& values, std::string& error);
+bool pseudoInverse(const Matrix<float>& matrix, Matrix<float>& result, std::string& error);
+bool pseudoInverse(const Matrix<double>& matrix, Matrix<double>& result, std::string& error);
+
+// sketches computed in double
+bool approximateRank(const Matrix<float>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error);
+bool approximateRank(const Matrix<double>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error);
+bool leadingSingularValues(const Matrix<float>& matrix, size_t count, size_t oversampling, Matrix<float>& values, std::string& error);
+bool leadingSingularValues(const Matrix<double>& matrix, size_t count, size_t oversampling, Matrix<double>& values, std::string& error);
+bool normEstimate(const Matrix<float>& matrix, double tolerance, float& norm, std::string& error);
+bool normEstimate(const Matrix<double>& matrix, double tolerance, double& norm, std::string& error);
+
+// matrix functions computed in double
+bool matrixFunction(const Matrix<float>& matrix, matrixFunctionType function, Matrix<float>& result, std::string& error);
+bool matrixFunction(const Matrix<double>& matrix, matrixFunctionType function, Matrix<double>& result, std::string& error);
+
+// krylov solvers on every column of the right-hand side, sparse matrices are kept compressed
+bool solveSystem(const Matrix<float>& matrix, const Matrix<float>& rhs, const krylovOptions& options, Matrix<float>& solution,
+				 size_t& iterations, double& residual, std::string& error);
+bool solveSystem(const Matrix<double>& matrix, const Matrix<double>& rhs, const krylovOptions& options, Matrix<double>& solution,
+				 size_t& iterations, double& residual, std::string& error);
+
+// split-plane complex kernels
+Matrix<complexNumber> multiply(const Matrix<complexNumber>& lhs, const Matrix<complexNumber>& rhs);
+complexNumber determinant(const Matrix<complexNumber>& matrix);
+complexNumber scaledDeterminant(const complexNumber& scale, const Matrix<complexNumber>& lhs, const Matrix<complexNumber>* rhs);
+Matrix<complexNumber> inverse(const Matrix<complexNumber>& matrix);
+size_t rank(const Matrix<complexNumber>& matrix);
+Matrix<complexNumber> characteristicPolynomial(const Matrix<complexNumber>& matrix);
+bool eigenvalues(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& values, std::string& error);
+bool singularValues(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& values, std::string& error);
+bool pseudoInverse(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& result, std::string& error);
+bool matrixFunction(const Matrix<complexNumber>& matrix, matrixFunctionType function, Matrix<complexNumber>& result, std::string& error);
+
+
+//------------------------------------------------------------------
+
+
+template <typename Field>
+Matrix<Field> multiply(const Matrix<Field>& lhs, const Matrix<Field>& rhs) {
+	return lhs * rhs;
+}
+
+template <typename Field>
+Field determinant(const Matrix<Field>& matrix) {
+	return matrix.det();
+}
+
+template <typename Field>
+Field scaledDeterminant(const Field& scale, const Matrix<Field>& lhs, const Matrix<Field>* rhs) {
+	Field result = determinant(lhs);
+	if (rhs) {
+		result *= determinant(*rhs);
+	}
+	for (size_t i = 0; i < lhs.getRow(); ++i) {
+		result *= scale;
+	}
+
+	return result;
+}
+
+template <typename Field>
+Matrix<Field> inverse(const Matrix<Field>& matrix) {
+	return matrix.inverted();
+}
+
+template <typename Field>
+size_t rank(const Matrix<Field>& matrix) {
+	return matrix.rank();
+}
+
+// exact fields take the division-free berkowitz algorithm
+template <typename Field>
+Matrix<Field> characteristicPolynomial(const Matrix<Field>& matrix) {
+	std::vector<Field> coefficients = berkowitz(matrix);
+	Matrix<Field> result(coefficients.size(), 1);
+	for (size_t i = 0; i < coefficients.size(); ++i) {
+		result[i][0] = coefficients[i];
+	}
+
+	return result;
+}
+
+template <typename Field>
+bool eigenvalues(const Matrix<Field>& matrix, Matrix<Field>& values, std::string& error) {
+	error = "Semantic error: eigenvalues are found only for real and complex types";
+
+	return false;
+}
+
+template <typename Field>
+bool singularValues(const Matrix<Field>& matrix, Matrix<Field>& values, std::string& error) {
+	error = "Semantic error: singular values are found only for real and complex types";
+
+	return false;
+}
+
+template <typename Field>
+bool pseudoInverse(const Matrix<Field>& matrix, Matrix<Field>& result, std::string& error) {
+	error = "Semantic error: pseudo-inverse is found only for real and complex types";
+
+	return false;
+}
+
+template <typename Field>
+bool approximateRank(const Matrix<Field>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error) {
+	error = "Semantic error: randomized sketches work only for real types";
+
+	return false;
+}
+
+template <typename Field>
+bool leadingSingularValues(const Matrix<Field>& matrix, size_t count, size_t oversampling, Matrix<Field>& values, std::string& error) {
+	error = "Semantic error: randomized sketches work only for real types";
+
+	return false;
+}
+
+template <typename Field>
+bool normEstimate(const Matrix<Field>& matrix, double tolerance, Field& norm, std::string& error) {
+	error = "Semantic error: randomized sketches work only for real types";
+
+	return false;
+}
+
+template <typename Field>
+bool matrixFunction(const Matrix<Field>& matrix, matrixFunctionType function, Matrix<Field>& result, std::string& error) {
+	error = "Semantic error: matrix functions are found only for real and complex types";
+
+	return false;
+}
+
+template <typename Field>
+bool solveSystem(const Matrix<Field>& matrix, const Matrix<Field>& rhs, const krylovOptions& options, Matrix<Field>& solution,
+				 size_t& iterations, double& residual, std::string& error) {
+	iterations = 0;
+	residual = 0;
+	if (options.method_ != directMethod) {
+		error = "Semantic error: iterative solvers work only for real types";
+		return false;
+	}
+
+	if (rank(matrix) < matrix.getRow()) {
+		error = "Semantic error: system has no unique solution";
+		return false;
+	}
+
+	solution = multiply(inverse(matrix), rhs);
+
+	return true;
+}
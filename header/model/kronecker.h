@@ -0,0 +1,156 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "matrix.h"
+#include "parallel.h"
+
+// a kronecker product F_1 x F_2 x ... x F_k is kept as the list of its factors,
+// the answer is only multiplied out when an operator needs its entries; the
+// hadamard product of two of them with matching factors is taken factor by factor
+
+// dimensions of the product, false if they do not fit into size_t
+template <typename Field>
+bool kroneckerSize(const std::vector<Matrix<Field>>& factors, size_t& rows, size_t& cols);
+
+// all the entries of the product
+template <typename Field>
+Matrix<Field> kroneckerProduct(const std::vector<Matrix<Field>>& factors);
+
+// (F_1 x ... x F_k) x without forming the product, the columns of x must match it
+template <typename Field>
+Matrix<Field> kroneckerApply(const std::vector<Matrix<Field>>& factors, const Matrix<Field>& x);
+
+// entrywise product of two matrices of the same size
+template <typename Field>
+Matrix<Field> hadamardProduct(const Matrix<Field>& lhs, const Matrix<Field>& rhs);
+
+// base to a nonnegative integer power by repeated squaring
+template <typename Field>
+Field raisePower(Field base, size_t exponent);
+
+
+//------------------------------------------------------------------
+
+
+// entries of a single mode product before its rows are split between threads
+constexpr size_t KRONECKER_PARALLEL_ENTRIES = 1 << 16;
+
+template <typename Field>
+bool kroneckerSize(const std::vector<Matrix<Field>>& factors, size_t& rows, size_t& cols) {
+	const size_t limit = std::numeric_limits<size_t>::max();
+	rows = 1;
+	cols = 1;
+	for (const Matrix<Field>& factor : factors) {
+		if (factor.getRow() != 0 && rows > limit / factor.getRow() ||
+			factor.getCol() != 0 && cols > limit / factor.getCol()) {
+			return false;
+		}
+		rows *= factor.getRow();
+		cols *= factor.getCol();
+	}
+
+	return true;
+}
+
+template <typename Field>
+Matrix<Field> kroneckerProduct(const std::vector<Matrix<Field>>& factors) {
+	Matrix<Field> result = factors[0];
+	for (size_t t = 1; t < factors.size(); ++t) {
+		const Matrix<Field>& factor = factors[t];
+		Matrix<Field> next(result.getRow() * factor.getRow(), result.getCol() * factor.getCol());
+		parallelFor(0, result.getRow(), [&](size_t i) {
+			for (size_t j = 0; j < result.getCol(); ++j) {
+				const Field value = result[i][j];
+				for (size_t k = 0; k < factor.getRow(); ++k) {
+					Field* row = next[i * factor.getRow() + k] + j * factor.getCol();
+					for (size_t l = 0; l < factor.getCol(); ++l) {
+						row[l] = value * factor[k][l];
+					}
+				}
+			}
+		});
+		result = next;
+	}
+
+	return result;
+}
+
+// the rows of x are a tensor with modes n_1, ..., n_k (row-major, the columns of x are one
+// more mode), and the product contracts every mode with its own factor in turn; for two
+// factors this is the vec trick (A x B) vec(X) = vec(A X B^T)
+template <typename Field>
+Matrix<Field> kroneckerApply(const std::vector<Matrix<Field>>& factors, const Matrix<Field>& x) {
+	const Field zero(0);
+	std::vector<Field> current(x.data(), x.data() + x.getRow() * x.getCol());
+	std::vector<Field> next;
+
+	size_t left = 1; // product of the modes already contracted, in their new sizes
+	size_t right = x.getRow() * x.getCol(); // product of the modes still to contract and the columns
+	for (const Matrix<Field>& factor : factors) {
+		size_t rows = factor.getRow();
+		size_t cols = factor.getCol();
+		right /= cols;
+
+		// out[l][a][r] = sum over b of F[a][b] in[l][b][r]
+		next.assign(left * rows * right, zero);
+		auto body = [&](size_t block) {
+			size_t l = block / rows;
+			size_t a = block % rows;
+			Field* out = next.data() + block * right;
+			for (size_t b = 0; b < cols; ++b) {
+				const Field koef = factor[a][b];
+				if (fieldTraits<Field>::isZero(koef)) {
+					continue;
+				}
+				const Field* in = current.data() + (l * cols + b) * right;
+				for (size_t r = 0; r < right; ++r) {
+					out[r] += koef * in[r];
+				}
+			}
+		};
+		if (next.size() * cols >= KRONECKER_PARALLEL_ENTRIES) {
+			parallelFor(0, left * rows, body);
+		}
+		else {
+			for (size_t block = 0; block < left * rows; ++block) {
+				body(block);
+			}
+		}
+
+		current.swap(next);
+		left *= rows;
+	}
+
+	Matrix<Field> result(left, x.getCol());
+	std::copy(current.begin(), current.end(), result.data());
+
+	return result;
+}
+
+template <typename Field>
+Matrix<Field> hadamardProduct(const Matrix<Field>& lhs, const Matrix<Field>& rhs) {
+	Matrix<Field> result = lhs;
+	Field* values = result.data();
+	const Field* other = rhs.data();
+	for (size_t i = 0; i < lhs.getRow() * lhs.getCol(); ++i) {
+		values[i] *= other[i];
+	}
+
+	return result;
+}
+
+template <typename Field>
+Field raisePower(Field base, size_t exponent) {
+	Field result(1);
+	while (exponent != 0) {
+		if (exponent & 1) {
+			result *= base;
+		}
+		base *= base;
+		exponent >>= 1;
+	}
+
+	return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+#include "sparsematrix.h"
+
+// how a square linear system is solved
+enum solveMethod {
+	directMethod = 0,
+	cgMethod,
+	bicgstabMethod,
+	gmresMethod
+};
+
+// preconditioner applied by the iterative methods
+enum preconditionerType {
+	noPreconditioner = 0,
+	jacobiPreconditioner,
+	iluPreconditioner
+};
+
+struct krylovOptions {
+	solveMethod method_ = directMethod; // method used for the system
+	preconditionerType preconditioner_ = iluPreconditioner; // preconditioner of iterative methods
+	double tolerance_ = 1e-10; // relative residual ||b - A x|| / ||b|| to stop at
+	size_t max_iterations_ = 1000; // cap on matrix-vector products
+	size_t restart_ = 50; // krylov subspace size of gmres before it restarts
+};
+
+// share of nonzeros below which the krylov solvers work on the compressed matrix
+inline constexpr double KRYLOV_SPARSE_DENSITY = 0.1;
+
+// names used by the view: "direct", "cg", "bicgstab", "gmres" and "none", "jacobi", "ilu"
+bool parseSolveMethod(const std::string& name, solveMethod& method);
+bool parsePreconditioner(const std::string& name, preconditionerType& preconditioner);
+
+// solve A x = b by the iterative method of options starting from x = 0: conjugate gradients
+// for symmetric positive definite A, bicgstab or restarted gmres otherwise, all of them
+// preconditioned by jacobi or ilu(0); iterations and the final residual norm are reported,
+// false if the method breaks down or does not reach the tolerance within the iteration cap
+bool krylovSolve(const sparseMatrix& matrix, const std::vector<double>& rhs, const krylovOptions& options,
+				 std::vector<double>& solution, size_t& iterations, double& residual, std::string& error);
+bool krylovSolve(const Matrix<double>& matrix, const std::vector<double>& rhs, const krylovOptions& options,
+				 std::vector<double>& solution, size_t& iterations, double& residual, std::string& error);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+// least squares solution of an overdetermined system given as an augmented matrix [A | b]:
+// householder qr of [A | b] leaves Q^T b next to R and the residual norm in the corner,
+// tall systems are split into row blocks factored in parallel whose triangular factors
+// are stacked and factored once more (tsqr); false if A does not have full column rank,
+// the error is only set if the evaluation was cancelled
+bool leastSquaresSolve(const Matrix<double>& system, std::vector<double>& solution,
+					   double& residual, std::string& error);
@@ -1,28 +1,40 @@
+#pragma once
+
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <utility>
+
+#include "field.h"
+#include "parallel.h"
+#include "progress.h"
 
 template <typename Field>
 class Matrix {
 public:
 	//constructors and destructor
-	Matrix(size_t row, size_t col);
+	Matrix(size_t row = 0, size_t col = 0);
 	Matrix(const std::vector<std::vector<Field>>& matrix);
 	~Matrix() = default;
 	Matrix(const Matrix& other);
 	Matrix& operator=(const Matrix& other);
+	Matrix(Matrix&& other);
+	Matrix& operator=(Matrix&& other);
 
-	// accessibility
-	std::vector<Field> operator[](size_t position) const;
-	std::vector<Field>& operator[](size_t position);
+	// accessibility, rows are stored contiguously one after another
+	const Field* operator[](size_t position) const;
+	Field* operator[](size_t position);
+	const Field* data() const;
+	Field* data();
 
 	// arithmetics
 	Matrix& operator+=(const Matrix& rhs);
 	Matrix& operator-=(const Matrix& rhs);
-	Matrix operator+(const Matrix& rhs);
-	Matrix operator-(const Matrix& rhs);
+	Matrix operator+(const Matrix& rhs) const;
+	Matrix operator-(const Matrix& rhs) const;
 	Matrix& operator*=(const Field& rhs);
-	Matrix operator*(const Field& rhs);
-	Matrix operator*(const Matrix& rhs);
+	Matrix operator*(const Field& rhs) const;
+	Matrix operator*(const Matrix& rhs) const;
 	Matrix& operator*=(const Matrix& rhs);
 
 	// comparisons
@@ -72,11 +84,14 @@ private:
 	// check if row is full of zeros
 	bool isZero(size_t row) const;
 
-	std::vector<std::vector<Field>> matrix_;
+	std::vector<Field> matrix_; // entries in row-major order
 	size_t row_;
 	size_t col_;
 };
 
+// size of the square tiles used by the matrix product
+const size_t GEMM_BLOCK = 64;
+
 // multiplication by a number from the left
 template <typename Field>
 Matrix<Field> operator*(const Field& lhs, const Matrix<Field>& rhs);
@@ -91,21 +106,20 @@ Matrix<Field> pow(const Matrix<Field>& matrix, int power);
 
 // constructors and destructor
 template <typename Field>
-Matrix<Field>::Matrix(size_t row, size_t col): row_(row), col_(col) {
-	matrix_.resize(row_);
-    for (size_t i = 0; i < row_; ++i) {
-    	matrix_[i].resize(col_);
-        for (size_t j = 0; j < col_; ++j) {
-            matrix_[i][j] = 0;
-        }
-    }
-}
+Matrix<Field>::Matrix(size_t row, size_t col): matrix_(row * col, Field(0)),
+											   row_(row),
+											   col_(col)
+{}
 
 template <typename Field>
-Matrix<Field>::Matrix(const std::vector<std::vector<Field>>& matrix): matrix_(matrix),
-																	  row_(matrix.size()),
+Matrix<Field>::Matrix(const std::vector<std::vector<Field>>& matrix): row_(matrix.size()),
 																	  col_(matrix[0].size())
-{}
+{
+	matrix_.reserve(row_ * col_);
+	for (size_t i = 0; i < row_; ++i) {
+		matrix_.insert(matrix_.end(), matrix[i].begin(), matrix[i].end());
+	}
+}
 
 template <typename Field>
 Matrix<Field>::Matrix(const Matrix& other): matrix_(other.matrix_),
@@ -122,24 +136,53 @@ Matrix<Field>& Matrix<Field>::operator=(const Matrix& other) {
 	return *this;
 }
 
+// moving takes the storage and leaves an empty matrix behind
+template <typename Field>
+Matrix<Field>::Matrix(Matrix&& other): matrix_(std::move(other.matrix_)),
+									   row_(other.row_),
+									   col_(other.col_)
+{
+	other.row_ = 0;
+	other.col_ = 0;
+}
+
+template <typename Field>
+Matrix<Field>& Matrix<Field>::operator=(Matrix&& other) {
+	matrix_ = std::move(other.matrix_);
+	row_ = other.row_;
+	col_ = other.col_;
+	other.row_ = 0;
+	other.col_ = 0;
+
+	return *this;
+}
+
 // accessibility
 template <typename Field>
-std::vector<Field>& Matrix<Field>::operator[](size_t position) {
-	return matrix_[position];
+Field* Matrix<Field>::operator[](size_t position) {
+	return matrix_.data() + position * col_;
+}
+
+template <typename Field>
+const Field* Matrix<Field>::operator[](size_t position) const {
+	return matrix_.data() + position * col_;
+}
+
+template <typename Field>
+Field* Matrix<Field>::data() {
+	return matrix_.data();
 }
 
 template <typename Field>
-std::vector<Field> Matrix<Field>::operator[](size_t position) const {
-	return matrix_[position];
+const Field* Matrix<Field>::data() const {
+	return matrix_.data();
 }
 
 // arithmetics
 template <typename Field>
 Matrix<Field>& Matrix<Field>::operator+=(const Matrix& rhs) {
-    for (size_t i = 0; i < row_; ++i) {
-        for (size_t j = 0; j < col_; ++j) {
-            matrix_[i][j] += rhs[i][j];
-        }
+    for (size_t i = 0; i < matrix_.size(); ++i) {
+        matrix_[i] += rhs.matrix_[i];
     }
 
     return *this;
@@ -147,17 +190,15 @@ Matrix<Field>& Matrix<Field>::operator+=(const Matrix& rhs) {
 
 template <typename Field>
 Matrix<Field>& Matrix<Field>::operator-=(const Matrix& rhs) {
-    for (size_t i = 0; i < row_; ++i) {
-        for (size_t j = 0; j < col_; ++j) {
-            matrix_[i][j] -= rhs[i][j];
-        }
+    for (size_t i = 0; i < matrix_.size(); ++i) {
+        matrix_[i] -= rhs.matrix_[i];
     }
 
     return *this;
 }
 
 template <typename Field>
-Matrix<Field> Matrix<Field>::operator+(const Matrix& rhs) {
+Matrix<Field> Matrix<Field>::operator+(const Matrix& rhs) const {
 	Matrix copy = *this;
     copy += rhs;
 
@@ -165,7 +206,7 @@ Matrix<Field> Matrix<Field>::operator+(const Matrix& rhs) {
 }
 
 template <typename Field>
-Matrix<Field> Matrix<Field>::operator-(const Matrix& rhs) {
+Matrix<Field> Matrix<Field>::operator-(const Matrix& rhs) const {
     Matrix copy = *this;
     copy -= rhs;
 
@@ -174,38 +215,65 @@ Matrix<Field> Matrix<Field>::operator-(const Matrix& rhs) {
 
 template <typename Field>
 Matrix<Field>& Matrix<Field>::operator*=(const Field& rhs) {
-	for (size_t i = 0; i < row_; ++i) {
-        for (size_t j = 0; j < col_; ++j) {
-            matrix_[i][j] *= rhs;
-        }
+	for (size_t i = 0; i < matrix_.size(); ++i) {
+        matrix_[i] *= rhs;
     }
 
     return *this;
 }
 
 template <typename Field>
-Matrix<Field> Matrix<Field>::operator*(const Field& rhs) {
+Matrix<Field> Matrix<Field>::operator*(const Field& rhs) const {
 	Matrix copy = *this;
     copy *= rhs;
 
     return copy;
 }
 
+// tiled i-k-j product: the innermost loop runs over contiguous rows of rhs and
+// the result so it vectorizes, bands of rows are computed by different workers;
+// the finished bands are the progress, a cancelled product skips the rest of them
 template <typename Field>
-Matrix<Field> Matrix<Field>::operator*(const Matrix& rhs) {
-	std::vector<std::vector<Field>> new_matrix(row_);
-    for (size_t i = 0; i < row_; ++i) {
-        new_matrix[i].resize(rhs.col_);
-        for (size_t z = 0; z < rhs.col_; ++z) {
-            Field sum = 0;
-            for (size_t j = 0; j < col_; ++j) {
-                sum += matrix_[i][j] * rhs[j][z];
-            }
-            new_matrix[i][z] = sum;
-        }
-    }
+Matrix<Field> Matrix<Field>::operator*(const Matrix& rhs) const {
+	Matrix<Field> result(row_, rhs.col_);
+	size_t bands = (row_ + GEMM_BLOCK - 1) / GEMM_BLOCK;
+	std::atomic<size_t> finished{0};
+
+	auto band = [&](size_t b) {
+		if (isEvaluationCancelled()) {
+			return;
+		}
+
+		size_t row_end = std::min(row_, (b + 1) * GEMM_BLOCK);
+		for (size_t kk = 0; kk < col_; kk += GEMM_BLOCK) {
+			size_t k_end = std::min(col_, kk + GEMM_BLOCK);
+			for (size_t jj = 0; jj < rhs.col_; jj += GEMM_BLOCK) {
+				size_t j_end = std::min(rhs.col_, jj + GEMM_BLOCK);
+				for (size_t i = b * GEMM_BLOCK; i < row_end; ++i) {
+					Field* out = result[i];
+					for (size_t k = kk; k < k_end; ++k) {
+						const Field koef = (*this)[i][k];
+						const Field* in = rhs[k];
+						for (size_t j = jj; j < j_end; ++j) {
+							out[j] += koef * in[j];
+						}
+					}
+				}
+			}
+		}
+		reportProgress(++finished, bands);
+	};
 
-    return Matrix(new_matrix);
+	if (row_ * col_ * rhs.col_ < GEMM_BLOCK * GEMM_BLOCK * GEMM_BLOCK) {
+		for (size_t b = 0; b < bands; ++b) {
+			band(b);
+		}
+	}
+	else {
+		parallelFor(0, bands, band);
+	}
+
+    return result;
 }
 
 template <typename Field>
@@ -219,11 +287,9 @@ Matrix<Field>& Matrix<Field>::operator*=(const Matrix& rhs) {
 // comparisons
 template <typename Field>
 bool Matrix<Field>::operator==(const Matrix& rhs) const {
-    for (size_t i = 0; i < row_; ++i) {
-        for (size_t j = 0; j < col_; ++j) {
-            if (matrix_[i][j] != rhs[i][j]) {
-                return false;
-            }
+    for (size_t i = 0; i < matrix_.size(); ++i) {
+        if (matrix_[i] != rhs.matrix_[i]) {
+            return false;
         }
     }
 
@@ -236,36 +302,43 @@ bool Matrix<Field>::operator!=(const Matrix& rhs) const {
 }
 
 // determinant
+// gaussian elimination with partial pivoting by the magnitude of the field
 template <typename Field>
 Field Matrix<Field>::det() const {
-	if (matrix_.size() == 1) {
-		return matrix_[0][0];
-    }
+	Matrix<Field> matrix(*this);
+	Field determinant = 1;
 
-   	if (matrix_.size() == 2) {
-		return matrix_[0][0] * matrix_[1][1] - matrix_[0][1] * matrix_[1][0];
-   	}
-
-	Field determinant = 0;
-   	for (int i = 0; i < matrix_.size(); ++i) {
-   		if (matrix_[0][i] == 0) continue;
-		std::vector<std::vector<Field>> minor;
-		minor.resize(matrix_.size() - 1);
-		for (int j = 1; j < matrix_.size(); ++j) {
-			for (int z = 0; z < matrix_.size(); ++z) {
-				if (z != i) {
-					minor[j - 1].push_back(matrix_[j][z]);
-				}
-			}
+	for (size_t k = 0; k < row_; ++k) {
+		if (isEvaluationCancelled()) {
+			return Field(0);
 		}
+		reportProgress(k, row_);
 
-		if (i % 2 == 0) {
-			determinant += matrix_[0][i] * Matrix<Field>(minor).det();
+		size_t pivot = k;
+		for (size_t i = k + 1; i < row_; ++i) {
+			if (fieldTraits<Field>::magnitude(matrix[i][k]) > fieldTraits<Field>::magnitude(matrix[pivot][k])) {
+				pivot = i;
+			}
+		}
+		if (fieldTraits<Field>::isZero(matrix[pivot][k])) {
+			return Field(0);
+		}
+		if (pivot != k) {
+			swapRow(matrix, k, pivot);
+			determinant = Field(0) - determinant;
 		}
-		else {
-			determinant -= matrix_[0][i] * Matrix<Field>(minor).det();
+
+		determinant *= matrix[k][k];
+		Field inverse = Field(1) / matrix[k][k];
+		for (size_t i = k + 1; i < row_; ++i) {
+			Field koef = matrix[i][k] * inverse;
+			Field* target = matrix[i];
+			const Field* source = matrix[k];
+			for (size_t j = k + 1; j < col_; ++j) {
+				target[j] -= koef * source[j];
+			}
 		}
-   	}
+	}
 
    	return determinant;
 }
@@ -273,15 +346,14 @@ Field Matrix<Field>::det() const {
 // transposition
 template <typename Field>
 Matrix<Field> Matrix<Field>::transposed() const {
-	std::vector<std::vector<Field>> matrix(col_);
-    for (size_t i = 0; i < col_; ++i) {
-        matrix[i].resize(row_);
-        for (size_t j = 0; j < row_; ++j) {
-            matrix[i][j] = matrix_[j][i];
+	Matrix<Field> matrix(col_, row_);
+    for (size_t i = 0; i < row_; ++i) {
+        for (size_t j = 0; j < col_; ++j) {
+            matrix[j][i] = (*this)[i][j];
         }
     }
 
-    return Matrix<Field>(matrix);
+    return matrix;
 }
 
 //rank
@@ -306,8 +378,8 @@ Matrix<Field>& Matrix<Field>::invert() {
 	Matrix<Field> copy(row_, 2 * col_);
 
 	for (int i = 0; i < copy.getRow(); ++i) {
-		for (int j = 0; j < copy[i].size(); ++j) {
-			copy[i][j] = j < col_ ? matrix_[i][j] : j == i + col_;
+		for (int j = 0; j < copy.getCol(); ++j) {
+			copy[i][j] = j < col_ ? (*this)[i][j] : Field(j == i + col_);
 		}
 	}
 
@@ -315,7 +387,7 @@ Matrix<Field>& Matrix<Field>::invert() {
 
     for (size_t i = 0; i < row_; ++i) {
         for (size_t j = 0; j < col_; ++j) {
-            matrix_[i][j] = copy[i][j + col_];
+            (*this)[i][j] = copy[i][j + col_];
         }
     }
 
@@ -335,7 +407,7 @@ Field Matrix<Field>::trace() const {
 	Field sum = 0;
 
     for (size_t i = 0; i < col_; ++i) {
-        sum += matrix_[i][i];
+        sum += (*this)[i][i];
     }
 
     return sum;
@@ -344,12 +416,17 @@ Field Matrix<Field>::trace() const {
 // get reduced row echelon form
 template <typename Field>
 Matrix<Field> Matrix<Field>::getReducedRowEchelonForm() const {
-	Matrix<Field> matrix(matrix_);
+	Matrix<Field> matrix(*this);
 
     for (size_t i = 0; i < col_ && i < row_; ++i) {
+        if (isEvaluationCancelled()) {
+            break;
+        }
+        reportProgress(i, std::min(col_, row_));
+
         bool flag = false;
         for (size_t j = i; j < row_; ++j) {
-            if (matrix[j][i] != 0.0) {
+            if (matrix[j][i] != Field(0)) {
                 swapRow(matrix, i, j);
                 flag = true;
                 break;
@@ -359,7 +436,7 @@ Matrix<Field> Matrix<Field>::getReducedRowEchelonForm() const {
             fullAnihilate(matrix, i, i);
         }
         flag = false;
-        if (matrix[i][i] != 0.0) {
+        if (matrix[i][i] != Field(0)) {
             reduceToOne(matrix, i);
         }
     }
@@ -380,17 +457,27 @@ size_t Matrix<Field>::getCol() const {
 
 template <typename Field>
 std::vector<std::vector<Field>> Matrix<Field>::getMatrix() const {
-	return matrix_;
+	std::vector<std::vector<Field>> matrix(row_);
+	for (size_t i = 0; i < row_; ++i) {
+		matrix[i].assign((*this)[i], (*this)[i] + col_);
+	}
+
+	return matrix;
 }
 
 // get row echelon form
 template <typename Field>
 void Matrix<Field>::getRowEchelonForm(Matrix& matrix) const {
 	    for (size_t i = 0; i < row_; ++i) {
+        if (isEvaluationCancelled()) {
+            break;
+        }
+        reportProgress(i, row_);
+
         bool flag = false;
         size_t position;
         for (size_t j = 0; j < col_; ++j) {
-            if (matrix[i][j] != 0) {
+            if (matrix[i][j] != Field(0)) {
                 flag = true;
                 position = j;
                 break;
@@ -449,7 +536,7 @@ void Matrix<Field>::reduceToOne(Matrix& matrix, size_t row) const {
 template <typename Field>
 bool Matrix<Field>::isZero(size_t row) const {
 	for (size_t i = 0; i < col_; ++i) {
-        if (matrix_[row][i] != 0) {
+        if ((*this)[row][i] != Field(0)) {
             return false;
         }
     }
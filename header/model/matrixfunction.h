@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+#include "matrix.h"
+
+// analytic functions of a square matrix
+enum matrixFunctionType {
+	exponentialFunction = 0,
+	logarithmFunction,
+	squareRootFunction
+};
+
+// exp(A) by scaling and squaring with the padé approximant of degree 3 to 13 picked
+// from the 1-norm of A (higham 2005): a handful of products and one lu solve
+template <typename Scalar>
+bool exponential(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error);
+
+// principal square root by the determinant scaled denman-beavers iteration,
+// false if A is singular or has eigenvalues on the closed negative real axis
+template <typename Scalar>
+bool squareRoot(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error);
+
+// principal logarithm by inverse scaling and squaring: square roots bring A close to I,
+// then log(I + X) is summed by gauss-legendre quadrature (the padé approximant in
+// partial fractions) and scaled back
+template <typename Scalar>
+bool logarithm(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error);
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "matrix.h"
+
+// rectangular piece of a shared matrix read through strides: slices and transposes only
+// move the offset and swap the strides, and a concatenation is the list of its pieces,
+// so the entries are copied once at most, when an operator needs them contiguous
+template <typename Field>
+struct matrixView {
+	const Field& get(size_t row, size_t col) const {
+		return source_->data()[offset_ + row * row_stride_ + col * col_stride_];
+	}
+
+	std::shared_ptr<const Matrix<Field>> source_; // matrix the entries are read from
+	size_t offset_ = 0; // storage position of the first entry
+	size_t row_stride_ = 0; // storage distance between neighbouring rows
+	size_t col_stride_ = 1; // storage distance between neighbouring columns
+	size_t rows_ = 0;
+	size_t cols_ = 0;
+	size_t top_ = 0; // position of the piece in the matrix assembled from all the pieces
+	size_t left_ = 0;
+};
+
+// the whole matrix as a single piece
+template <typename Field>
+matrixView<Field> wholeView(const std::shared_ptr<const Matrix<Field>>& source);
+
+// whether the pieces are exactly one whole matrix, so its storage can be read directly
+template <typename Field>
+bool isWholeView(const std::vector<matrixView<Field>>& views);
+
+// dimensions of the matrix the pieces cover
+template <typename Field>
+void viewsSize(const std::vector<matrixView<Field>>& views, size_t& rows, size_t& cols);
+
+// rows [row_begin, row_end) and columns [col_begin, col_end) of the matrix the pieces cover
+template <typename Field>
+std::vector<matrixView<Field>> sliceViews(const std::vector<matrixView<Field>>& views,
+										  size_t row_begin, size_t row_end, size_t col_begin, size_t col_end);
+
+template <typename Field>
+std::vector<matrixView<Field>> transposeViews(const std::vector<matrixView<Field>>& views);
+
+// rhs to the right of lhs, or below it if is_vertical
+template <typename Field>
+std::vector<matrixView<Field>> concatenateViews(const std::vector<matrixView<Field>>& lhs,
+												const std::vector<matrixView<Field>>& rhs, bool is_vertical);
+
+// copy the entries into a contiguous matrix
+template <typename Field>
+Matrix<Field> assembleViews(const std::vector<matrixView<Field>>& views);
+
+// target += pieces, or target -= pieces if is_subtracted
+template <typename Field>
+void addViews(Matrix<Field>& target, const std::vector<matrixView<Field>>& views, bool is_subtracted);
+
+// target = pieces - target, the pieces cover the whole target
+template <typename Field>
+void subtractFromViews(Matrix<Field>& target, const std::vector<matrixView<Field>>& views);
+
+// trace of the square matrix the pieces cover
+template <typename Field>
+Field traceViews(const std::vector<matrixView<Field>>& views);
+
+
+//------------------------------------------------------------------
+
+
+template <typename Field>
+matrixView<Field> wholeView(const std::shared_ptr<const Matrix<Field>>& source) {
+	matrixView<Field> view;
+	view.source_ = source;
+	view.row_stride_ = source->getCol();
+	view.rows_ = source->getRow();
+	view.cols_ = source->getCol();
+
+	return view;
+}
+
+template <typename Field>
+bool isWholeView(const std::vector<matrixView<Field>>& views) {
+	if (views.size() != 1) {
+		return false;
+	}
+
+	const matrixView<Field>& view = views[0];
+	return view.offset_ == 0 && view.col_stride_ == 1 && view.row_stride_ == view.cols_ &&
+		   view.rows_ == view.source_->getRow() && view.cols_ == view.source_->getCol();
+}
+
+template <typename Field>
+void viewsSize(const std::vector<matrixView<Field>>& views, size_t& rows, size_t& cols) {
+	rows = 0;
+	cols = 0;
+	for (const matrixView<Field>& view : views) {
+		rows = std::max(rows, view.top_ + view.rows_);
+		cols = std::max(cols, view.left_ + view.cols_);
+	}
+}
+
+// every piece is cut down to the window and moved to its place inside of it
+template <typename Field>
+std::vector<matrixView<Field>> sliceViews(const std::vector<matrixView<Field>>& views,
+										  size_t row_begin, size_t row_end, size_t col_begin, size_t col_end) {
+	std::vector<matrixView<Field>> result;
+	for (const matrixView<Field>& view : views) {
+		size_t top = std::max(view.top_, row_begin);
+		size_t bottom = std::min(view.top_ + view.rows_, row_end);
+		size_t left = std::max(view.left_, col_begin);
+		size_t right = std::min(view.left_ + view.cols_, col_end);
+		if (top >= bottom || left >= right) {
+			continue;
+		}
+
+		matrixView<Field> piece = view;
+		piece.offset_ += (top - view.top_) * view.row_stride_ + (left - view.left_) * view.col_stride_;
+		piece.rows_ = bottom - top;
+		piece.cols_ = right - left;
+		piece.top_ = top - row_begin;
+		piece.left_ = left - col_begin;
+		result.push_back(piece);
+	}
+
+	return result;
+}
+
+template <typename Field>
+std::vector<matrixView<Field>> transposeViews(const std::vector<matrixView<Field>>& views) {
+	std::vector<matrixView<Field>> result = views;
+	for (matrixView<Field>& view : result) {
+		std::swap(view.row_stride_, view.col_stride_);
+		std::swap(view.rows_, view.cols_);
+		std::swap(view.top_, view.left_);
+	}
+
+	return result;
+}
+
+template <typename Field>
+std::vector<matrixView<Field>> concatenateViews(const std::vector<matrixView<Field>>& lhs,
+												const std::vector<matrixView<Field>>& rhs, bool is_vertical) {
+	size_t rows;
+	size_t cols;
+	viewsSize(lhs, rows, cols);
+
+	std::vector<matrixView<Field>> result = lhs;
+	for (matrixView<Field> view : rhs) {
+		if (is_vertical) {
+			view.top_ += rows;
+		}
+		else {
+			view.left_ += cols;
+		}
+		result.push_back(view);
+	}
+
+	return result;
+}
+
+template <typename Field>
+Matrix<Field> assembleViews(const std::vector<matrixView<Field>>& views) {
+	size_t rows;
+	size_t cols;
+	viewsSize(views, rows, cols);
+
+	Matrix<Field> result(rows, cols);
+	for (const matrixView<Field>& view : views) {
+		for (size_t i = 0; i < view.rows_; ++i) {
+			Field* out = result[view.top_ + i] + view.left_;
+			for (size_t j = 0; j < view.cols_; ++j) {
+				out[j] = view.get(i, j);
+			}
+		}
+	}
+
+	return result;
+}
+
+template <typename Field>
+void addViews(Matrix<Field>& target, const std::vector<matrixView<Field>>& views, bool is_subtracted) {
+	for (const matrixView<Field>& view : views) {
+		for (size_t i = 0; i < view.rows_; ++i) {
+			Field* out = target[view.top_ + i] + view.left_;
+			for (size_t j = 0; j < view.cols_; ++j) {
+				if (is_subtracted) {
+					out[j] -= view.get(i, j);
+				}
+				else {
+					out[j] += view.get(i, j);
+				}
+			}
+		}
+	}
+}
+
+template <typename Field>
+void subtractFromViews(Matrix<Field>& target, const std::vector<matrixView<Field>>& views) {
+	for (const matrixView<Field>& view : views) {
+		for (size_t i = 0; i < view.rows_; ++i) {
+			Field* out = target[view.top_ + i] + view.left_;
+			for (size_t j = 0; j < view.cols_; ++j) {
+				out[j] = view.get(i, j) - out[j];
+			}
+		}
+	}
+}
+
+// the diagonal crosses a piece where its rows and columns overlap
+template <typename Field>
+Field traceViews(const std::vector<matrixView<Field>>& views) {
+	Field trace(0);
+	for (const matrixView<Field>& view : views) {
+		size_t first = std::max(view.top_, view.left_);
+		size_t last = std::min(view.top_ + view.rows_, view.left_ + view.cols_);
+		for (size_t k = first; k < last; ++k) {
+			trace += view.get(k - view.top_, k - view.left_);
+		}
+	}
+
+	return trace;
+}
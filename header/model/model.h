@@ -3,108 +3,431 @@
 #include <memory> // for shared pointers
 #include <cstdlib> // convert string to float strtof()
 #include <string>
-#include <map> // priority of operations
-#include <stack> // for checking correctness of brackets
+#include <string_view> // tokens point into the expression
+#include <map> // compiled programs by text
 #include <cmath> // for pow of 2 floats
+#include <numeric> // gcd of denominators
+#include <tuple> // values for every field
 
 #include "query.h"
+#include "field.h"
+#include "kernels.h"
+#include "kronecker.h"
 #include "matrix.h"
+#include "matrixview.h"
+#include "nodearena.h"
+#include "resultcache.h"
+#include "subtreetable.h"
+
+// kinds of the nodes of the tree, which the evaluator and the rewrites switch on
+enum nodeKind {
+	varNode = 0,
+	numberNode,
+	plusNode,
+	minusNode,
+	multiplyNode,
+	hadamardNode,
+	divideNode,
+	powerNode,
+	commaNode,
+	traceNode,
+	inverseNode,
+	determinantNode,
+	rankNode,
+	transposeNode,
+	eigenvaluesNode,
+	charpolyNode,
+	svdNode,
+	pinvNode,
+	solveNode,
+	rankestNode,
+	svdkNode,
+	normestNode,
+	expmNode,
+	logmNode,
+	sqrtmNode,
+	kronNode,
+	sliceNode,
+	hcatNode,
+	vcatNode
+};
 
-// class for node of the tree
+// class for node of the tree, Field is the type the expression is computed in
+template <typename Field>
 struct Token {
-	using ptr = std::shared_ptr<Token>;
+	using ptr = Token<Field>*; // nodes are owned by the arena of their tree
 
 	Token() = default;
-	Token(const std::string& type): type_(type) {}
-	~Token() = default;
+	virtual ~Token() = default;
 
 	// set up values
-	void setUpMatrix(const std::vector<std::vector<float>>& matrix, std::string& error);
+	void setUpView(const std::shared_ptr<const Matrix<Field>>& matrix);
 	void setUpNumber(const std::string& num, std::string& error);
-	void setUpNumber(float num);
+	void setUpNumber(const Field& num);
 
 	// universal calculate function
 	virtual void calc(std::string& error) = 0;
 
-	std::string type_;
+	// whether calc takes kronecker products as factors, otherwise they are multiplied out first
+	virtual bool acceptsKronecker() const { return false; }
+	bool isKronecker() const { return !ans_factors_.empty(); }
+
+	// whether calc takes views into other matrices, otherwise they are assembled first;
+	// a view of a whole matrix is never assembled and is read through matrix()
+	virtual bool acceptsViews() const { return false; }
+	bool isView() const { return !ans_views_.empty(); }
+	const Matrix<Field>& matrix() const;
+
+	nodeKind kind_ = varNode;
 	ptr left_ = nullptr; // pointer to left child
 	ptr right_ = nullptr; // pointer to right child
 	bool is_ans_number_ = false; // whether answer of subtree is a number
-	float ans_float_ = 0.0; // answer of subtree if its a number
-	std::vector<std::vector<float>> ans_matrix_; // answer of subtree if its a matrix
+	Field ans_number_ = Field(0); // answer of subtree if its a number
+	Matrix<Field> ans_matrix_; // answer of subtree if its a matrix
+	std::vector<Matrix<Field>> ans_factors_; // factors of the answer if it is a kronecker product
+	std::vector<matrixView<Field>> ans_views_; // pieces of the answer if it is a view into other matrices
+	size_t key_ = 0; // number of the subtree in the table of its field, equal for equal subtrees
+	bool is_last_read_ = false; // whether no later step reads the answer, so that its storage may be taken over
+	bool is_in_place_ = false; // whether the answer was written into the storage of an operand
 };
 
 // token's children
-struct Var: Token {
+template <typename Field>
+struct Var: Token<Field> {
 	Var() = default;
 
 	void calc(std::string& error);
+
+	int variable_ = -1; // index of the variable, -1 for the answer
 };
 
-struct Number: Token {
+template <typename Field>
+struct Number: Token<Field> {
 	Number() = default;
 
 	void calc(std::string& error);
+
+	bool is_integer_ = false; // whether the number is an integer written in the expression
+	long long integer_ = 0; // the integer as it is written, a residue keeps it only modulo its modulus
 };
 
-struct Plus: Token {
+template <typename Field>
+struct Plus: Token<Field> {
 	Plus() = default;
 
 	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
 };
 
-struct Minus: Token {
+template <typename Field>
+struct Minus: Token<Field> {
 	Minus() = default;
 
 	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
 };
 
-struct Multiply: Token {
+template <typename Field>
+struct Multiply: Token<Field> {
 	Multiply() = default;
 
 	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Divide: Token {
+template <typename Field>
+struct Divide: Token<Field> {
 	Divide() = default;
 
 	void calc(std::string& error);
 };
 
-struct Power: Token {
+template <typename Field>
+struct Power: Token<Field> {
 	Power() = default;
 
 	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Trace: Token {
+template <typename Field>
+struct Trace: Token<Field> {
 	Trace() = default;
 
 	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Determinant: Token {
+template <typename Field>
+struct Determinant: Token<Field> {
 	Determinant() = default;
 
 	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Rank: Token {
+template <typename Field>
+struct Rank: Token<Field> {
 	Rank() = default;
 
 	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Transpose: Token {
+template <typename Field>
+struct Transpose: Token<Field> {
 	Transpose() = default;
 
 	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
+	bool acceptsKronecker() const { return true; }
 };
 
-struct Inverse: Token {
+template <typename Field>
+struct Inverse: Token<Field> {
 	Inverse() = default;
 
 	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
+};
+
+template <typename Field>
+struct CharacteristicPolynomial: Token<Field> {
+	CharacteristicPolynomial() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct Eigenvalues: Token<Field> {
+	Eigenvalues() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct SingularValues: Token<Field> {
+	SingularValues() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct PseudoInverse: Token<Field> {
+	PseudoInverse() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct ApproximateRank: Token<Field> {
+	ApproximateRank() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct LeadingSingularValues: Token<Field> {
+	LeadingSingularValues() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct NormEstimate: Token<Field> {
+	NormEstimate() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct Exponential: Token<Field> {
+	Exponential() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct Logarithm: Token<Field> {
+	Logarithm() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct SquareRoot: Token<Field> {
+	SquareRoot() = default;
+
+	void calc(std::string& error);
+};
+
+template <typename Field>
+struct Kronecker: Token<Field> {
+	Kronecker() = default;
+
+	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
+};
+
+template <typename Field>
+struct Hadamard: Token<Field> {
+	Hadamard() = default;
+
+	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
+};
+
+// rows or columns first_ to last_ of a slice counted from 1, all of them if is_all_
+struct sliceRange {
+	bool is_all_ = true;
+	bool is_index_ = false; // written as a single index instead of a range
+	size_t first_ = 0;
+	size_t last_ = 0;
+};
+
+template <typename Field>
+struct Slice: Token<Field> {
+	Slice() = default;
+
+	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
+
+	sliceRange rows_;
+	sliceRange cols_;
+};
+
+// two blocks side by side, or one above the other if is_vertical_
+template <typename Field>
+struct Concatenation: Token<Field> {
+	Concatenation() = default;
+
+	void calc(std::string& error);
+	bool acceptsViews() const { return true; }
+
+	bool is_vertical_ = false;
+};
+
+// separates the arguments of a function, evaluated by the function itself
+template <typename Field>
+struct Comma: Token<Field> {
+	Comma() = default;
+
+	void calc(std::string& error);
+	bool acceptsKronecker() const { return true; }
+	bool acceptsViews() const { return true; }
+};
+
+template <typename Field>
+struct Solve: Token<Field> {
+	Solve() = default;
+
+	void calc(std::string& error);
+
+	krylovOptions options_; // method chosen for the system
+	size_t iterations_ = 0; // iterations the krylov solver took over all the columns, 0 for elimination
+	double residual_ = 0; // largest final residual norm of the columns
+};
+
+// operations of the steps of a program, chosen when it is compiled from the kinds and shapes of
+// the operands; a step whose operands are not known to fit calls calc, which checks them itself
+enum stepOpcode {
+	callStep = 0,
+	addNumbers,
+	subtractNumbers,
+	multiplyNumbers,
+	divideNumbers,
+	addMatrices,
+	subtractMatrices,
+	scaleMatrix, // a number times a matrix in either order
+	multiplyMatrices,
+	traceMatrix,
+	determinantMatrix
+};
+
+// what the answer of a step is known to be before the run
+enum answerKind {
+	unknownAnswer = 0,
+	numberAnswer,
+	matrixAnswer
+};
+
+// one node of a compiled expression, the registers of its operands come before it
+template <typename Field>
+struct programStep {
+	Token<Field>* node_ = nullptr; // operator and the register its answer is kept in
+	int left_ = -1; // registers of the operands, -1 if none
+	int right_ = -1;
+	int variable_ = -1; // variable read by a leaf, -1 if none
+	stepOpcode opcode_ = callStep;
+	answerKind kind_ = unknownAnswer;
+	size_t rows_ = 0; // shape of the answer if it is known to be a matrix
+	size_t cols_ = 0;
+	bool is_cached_ = false; // whether the answer is looked up in the cache of results, not if its only reader takes its storage
+};
+
+// expression compiled once into a flat list of steps over the shared tree, the answer is the
+// last register; it is run again with the variables rebound as long as their shapes stay
+template <typename Field>
+struct compiledProgram {
+	nodeArena<Token<Field>> nodes_; // nodes of the tree, released together with the program
+	std::vector<programStep<Field>> steps_;
+	size_t modulus_ = 0; // modulus of residue<0> the program computes in, 0 in the other fields
+	std::vector<std::string> rewrites_; // identities applied to the tree, in the order they were applied
+	size_t cubic_before_ = 0; // operators of cubic cost in the tree as it was parsed
+	size_t cubic_after_ = 0; // operators of cubic cost left after the rewrites
+};
+
+// fields a query can be computed in
+enum fieldType {
+	noField = 0,
+	realField,
+	doubleField,
+	complexField,
+	rationalField,
+	moduloField
+};
+
+// variables and the last answer converted into one type of a field
+template <typename Field>
+struct fieldStore {
+	std::vector<std::shared_ptr<const Matrix<Field>>> variables_; // parsed variables, shared with the views reading them
+	std::vector<bool> is_parsed_; // whether variable is parsed for this type
+	bool is_ans_number_ = false; // whether answer is number
+	Field ans_number_ = Field(0); // answer if it's a number
+	std::shared_ptr<const Matrix<Field>> ans_matrix_; // answer if it's a matrix
+	resultCache<Field> cache_; // answers of subtrees of earlier queries
+	subtreeTable subtrees_; // numbers of the subtrees the cache is keyed by
+	std::map<std::string, std::shared_ptr<compiledProgram<Field>>> programs_; // compiled expressions by text and shapes
+};
+
+// expression which is evaluated again when a variable it reads changes
+struct liveExpression {
+	std::string exp_; // expression as entered
+	std::string type_; // type it was computed in
+	krylovOptions solve_options_; // method of its solve operators
+	std::vector<bool> reads_; // variables it reads, its edges in the dependency graph
+};
+
+// kinds of tokens, every token is classified once before the parser reads it
+enum tokenKind {
+	operandToken = 0, // variable, ans or number
+	binaryToken, // operator between two operands, the comma included
+	functionToken, // operator of the operand after it
+	openToken,
+	closeToken,
+	openSquareToken,
+	closeSquareToken,
+	separatorToken // ":" of slices and ";" of blocks
+};
+
+// token of an expression, its text is a view into the expression it was read from
+struct lexToken {
+	tokenKind kind_ = operandToken;
+	std::string_view text_;
+	int priority_ = 0; // priority of an operator, the lower the tighter it binds
+	nodeKind node_ = varNode; // node of an operator or a function
+	int match_ = -1; // position of the matching bracket, -1 for other tokens
 };
 
 class Model {
@@ -112,7 +435,6 @@ public:
 	// types definitons
 
 	using sptrModel = std::shared_ptr<Model>;
-	using sptrToken = std::shared_ptr<Token>;
 
 	// constructor and destructor
 
@@ -137,29 +459,119 @@ private:
 	Answer handleSolveEqQuery(const Query& query);
 	Answer handleCalcExpQuery(const Query& query);
 
+	// field of the query type and the modulus of its residues
+	fieldType getFieldType(const std::string& type, size_t& modulus, std::string& error);
+
+	// evaluate the expression, the answer replaces ans if is_ans_kept
+	Answer evaluate(const std::vector<lexToken>& tokens, const std::string& type, bool is_ans_kept);
+	template <typename Field>
+	Answer calcExpression(const std::vector<lexToken>& tokens, const std::string& type, bool is_ans_kept);
+
+	// dependency graph of the evaluated expressions on the variables
+	void keepLiveExpression(const Query& query, const std::vector<lexToken>& tokens);
+	std::vector<Answer> recomputeDependents(int variable);
+
+	// values converted into one type
+	template <typename Field>
+	fieldStore<Field>& getStore(const std::string& type);
+	void unparseVariables();
+	template <typename Field>
+	bool getVariable(int variable, const std::string& type, std::shared_ptr<const Matrix<Field>>& matrix, std::string& error);
+	template <typename Field>
+	size_t getVariableKey(int variable, const std::string& type);
+
+	// keep the answer of the last expression
+	template <typename Field>
+	void storeAnswer(Token<Field>& tree, const std::string& type, Answer& ans, bool is_kept);
+	template <typename Field>
+	void storeVariableFromAnswer(int variable, std::string& error);
+
 	// checker
-	void isMatrixValid(const std::vector<std::vector<std::string>>& matrix, int variable, int query_type, std::string& error);
+	template <typename Field>
+	bool isMatrixValid(const std::vector<std::vector<std::string>>& matrix, Matrix<Field>& result, std::string& error);
 	bool isDigit(char symbol);
-	bool correctBrackets(const std::vector<std::string>& tokens);
-	bool isOperator(const std::string& token);
-
-	// split expression into tokens
-	void splitIntoTokens(std::vector<std::string>& tokens, const std::string& exp);
-
-	// turn tokens into calc tree
-	std::shared_ptr<Token> getCalcTree(const std::vector<std::string>& tokens, int start, int end, std::string& error);
+	bool isSliceRange(const std::vector<lexToken>& tokens, int start, int end, sliceRange& range, std::string& error);
+	bool isImaginaryUnit(const std::string& exp, int pos);
+	void getArgumentsCount(nodeKind function, size_t& least, size_t& most);
+
+	// exact coefficients for the multi-modular solver
+	bool getExactCell(const std::string& cell, long long& numerator, long long& denominator);
+	bool getExactSystem(const std::vector<std::vector<std::string>>& matrix, std::vector<std::vector<long long>>& system);
+
+	// method and preconditioner of the query, "direct" keeps the elimination
+	bool getSolveOptions(const Query& query, krylovOptions& options, std::string& error);
+
+	// split expression into tokens, false if the brackets do not match
+	bool splitIntoTokens(std::vector<lexToken>& tokens, const std::string& exp);
+
+	// turn tokens into calc tree in one pass, pos is moved past what each part reads
+	template <typename Field>
+	Token<Field>* getCalcTree(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes, const std::string& type,
+							  std::string& error);
+	template <typename Field>
+	Token<Field>* parseExpression(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+								  int& pos, int limit, bool is_range_start, const std::string& type, std::string& error);
+	template <typename Field>
+	Token<Field>* parseOperand(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+							   int& pos, const std::string& type, std::string& error);
+	template <typename Field>
+	Token<Field>* parseApplication(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+								   int& pos, const std::string& type, std::string& error);
+	template <typename Field>
+	Token<Field>* parseAtom(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+							int& pos, const std::string& type, std::string& error);
+	template <typename Field>
+	Token<Field>* parseSlice(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+							 int& pos, Token<Field>* node, std::string& error);
+	template <typename Field>
+	Token<Field>* parseBlock(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+							 int& pos, const std::string& type, std::string& error);
+
+	template <typename Field>
+	Token<Field>* makeNode(nodeKind kind, nodeArena<Token<Field>>& nodes);
+
+	// rewrite the tree with identities which save work before it is evaluated
+	template <typename Field>
+	Token<Field>* simplifyTree(Token<Field>* node, nodeArena<Token<Field>>& nodes, std::map<const Token<Field>*, int>& readers,
+							   std::map<const Token<Field>*, Token<Field>*>& simplified, std::vector<std::string>& rewrites);
+	template <typename Field>
+	Token<Field>* applyRewrite(Token<Field>* node, nodeArena<Token<Field>>& nodes, const std::map<const Token<Field>*, int>& readers,
+							   std::string& rule);
+
+	// number the subtrees and merge equal subtrees into one node, so that every
+	// subexpression is evaluated once
+	template <typename Field>
+	Token<Field>* shareSubtrees(Token<Field>* node, subtreeTable& table,
+												std::unordered_map<size_t, Token<Field>*>& subtrees);
+
+	// compile the expression, or take the program compiled for the same text and shapes
+	template <typename Field>
+	std::shared_ptr<compiledProgram<Field>> getProgram(const std::vector<lexToken>& tokens, const std::string& type, std::string& error);
+	template <typename Field>
+	std::shared_ptr<compiledProgram<Field>> compileProgram(const std::vector<lexToken>& tokens, const std::string& type, std::string& error);
+	template <typename Field>
+	bool bindProgram(compiledProgram<Field>& program, const std::string& type, std::string& error);
 
 	// calculate expression
-	void calc(std::shared_ptr<Token> tree, std::string& error);
+	template <typename Field>
+	void runProgram(compiledProgram<Field>& program, resultCache<Field>& cache, std::string& error);
 
 	// print out tree
-	void printTree(std::shared_ptr<Token> node);
-
-	bool is_ans_number_; // indicates whether answer is number
-	float ans_float_; // answer if it's a number
-	std::vector<std::vector<float>> ans_matrix_float_; // answer if it's a matrix
-	std::vector<std::vector<std::vector<float>>> variables_; // stores the variables
+	template <typename Field>
+	void printTree(Token<Field>* node);
+
+	std::string ans_type_; // type the last answer was computed in, empty if none
+	std::vector<std::vector<std::vector<std::string>>> variables_; // stores the variables as entered
+	std::vector<size_t> versions_; // changes of every variable, part of the keys of the cached answers
+	size_t ans_version_ = 0; // changes of the answer
+	std::vector<liveExpression> live_; // evaluated expressions, the most recently evaluated last
+	// variables and answer in every type, the moduli share a field so they are told apart by the type
+	std::tuple<std::map<std::string, fieldStore<float>>,
+			   std::map<std::string, fieldStore<double>>,
+			   std::map<std::string, fieldStore<complexNumber>>,
+			   std::map<std::string, fieldStore<rationalNumber>>,
+			   std::map<std::string, fieldStore<residue<0>>>> stores_;
 	std::vector<std::vector<float>> system_; // stores coefs of system
-	std::map<std::string, int> priority_; // priority of operators
+	krylovOptions solve_options_; // method of the solve operator in the current query
 	static sptrModel model_; // singleton pattern
 };
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "biginteger.h"
+#include "matrix.h"
+#include "residue.h"
+
+// word size primes used by the multi-modular engine, the largest ones below 2^31
+// so that a residue fits into an int and a product of two fits into size_t
+constexpr std::array<size_t, 64> MODULAR_PRIMES = {
+	2147483647, 2147483629, 2147483587, 2147483579, 2147483563, 2147483549, 2147483543, 2147483497,
+	2147483489, 2147483477, 2147483423, 2147483399, 2147483353, 2147483323, 2147483269, 2147483249,
+	2147483237, 2147483179, 2147483171, 2147483137, 2147483123, 2147483077, 2147483069, 2147483059,
+	2147483053, 2147483033, 2147483029, 2147482951, 2147482949, 2147482943, 2147482937, 2147482921,
+	2147482877, 2147482873, 2147482867, 2147482859, 2147482819, 2147482817, 2147482811, 2147482801,
+	2147482763, 2147482739, 2147482697, 2147482693, 2147482681, 2147482663, 2147482661, 2147482621,
+	2147482591, 2147482583, 2147482577, 2147482507, 2147482501, 2147482481, 2147482417, 2147482409,
+	2147482367, 2147482361, 2147482349, 2147482343, 2147482327, 2147482291, 2147482273, 2147482237
+};
+
+// exact determinant of an integer matrix, false if the entries are too large for the engine
+bool modularDeterminant(const std::vector<std::vector<long long>>& matrix, bigInteger& determinant, std::string& error);
+
+// exact solution of a square system given as an integer augmented matrix [A | b],
+// every unknown is returned as a reduced fraction (numerator, positive denominator);
+// false with an empty error if the system is singular
+bool modularSolve(const std::vector<std::vector<long long>>& system,
+				  std::vector<std::pair<bigInteger, bigInteger>>& solution,
+				  std::string& error);
+
+// elimination over a single prime field
+template <size_t P>
+size_t determinantModulo(const std::vector<std::vector<long long>>& matrix);
+
+template <size_t P>
+bool solveModulo(const std::vector<std::vector<long long>>& system, size_t& determinant, std::vector<size_t>& solution);
+
+
+//------------------------------------------------------------------
+
+
+// reduce an integer into the field of residues modulo P
+template <size_t P>
+Matrix<residue<P>> reduceModulo(const std::vector<std::vector<long long>>& matrix) {
+	Matrix<residue<P>> reduced(matrix.size(), matrix[0].size());
+	for (size_t i = 0; i < matrix.size(); ++i) {
+		for (size_t j = 0; j < matrix[i].size(); ++j) {
+			long long rest = matrix[i][j] % static_cast<long long>(P);
+			reduced[i][j] = residue<P>(static_cast<int>(rest));
+		}
+	}
+
+	return reduced;
+}
+
+// determinant modulo P by gaussian elimination
+template <size_t P>
+size_t determinantModulo(const std::vector<std::vector<long long>>& matrix) {
+	Matrix<residue<P>> reduced = reduceModulo<P>(matrix);
+	size_t n = reduced.getRow();
+	const residue<P> zero(0);
+
+	residue<P> determinant(1);
+	for (size_t k = 0; k < n; ++k) {
+		if (isEvaluationCancelled()) {
+			return 0;
+		}
+
+		size_t pivot = k;
+		while (pivot < n && reduced[pivot][k] == zero) {
+			++pivot;
+		}
+		if (pivot == n) {
+			return 0;
+		}
+		if (pivot != k) {
+			for (size_t j = k; j < n; ++j) {
+				std::swap(reduced[k][j], reduced[pivot][j]);
+			}
+			determinant = zero - determinant;
+		}
+
+		determinant *= reduced[k][k];
+		residue<P> inverse = residue<P>(1) / reduced[k][k];
+		for (size_t i = k + 1; i < n; ++i) {
+			if (reduced[i][k] == zero) {
+				continue;
+			}
+			residue<P> koef = reduced[i][k] * inverse;
+			for (size_t j = k + 1; j < n; ++j) {
+				reduced[i][j] -= koef * reduced[k][j];
+			}
+		}
+	}
+
+	return determinant.getValue();
+}
+
+// gauss-jordan elimination of [A | b] modulo P, false if A is singular modulo P
+template <size_t P>
+bool solveModulo(const std::vector<std::vector<long long>>& system, size_t& determinant, std::vector<size_t>& solution) {
+	Matrix<residue<P>> reduced = reduceModulo<P>(system);
+	size_t n = reduced.getRow();
+	const residue<P> zero(0);
+
+	residue<P> det(1);
+	for (size_t k = 0; k < n; ++k) {
+		if (isEvaluationCancelled()) {
+			return false;
+		}
+
+		size_t pivot = k;
+		while (pivot < n && reduced[pivot][k] == zero) {
+			++pivot;
+		}
+		if (pivot == n) {
+			determinant = 0;
+			return false;
+		}
+		if (pivot != k) {
+			for (size_t j = k; j <= n; ++j) {
+				std::swap(reduced[k][j], reduced[pivot][j]);
+			}
+			det = zero - det;
+		}
+
+		det *= reduced[k][k];
+		residue<P> inverse = residue<P>(1) / reduced[k][k];
+		for (size_t j = k; j <= n; ++j) {
+			reduced[k][j] *= inverse;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			if (i == k || reduced[i][k] == zero) {
+				continue;
+			}
+			residue<P> koef = reduced[i][k];
+			for (size_t j = k; j <= n; ++j) {
+				reduced[i][j] -= koef * reduced[k][j];
+			}
+		}
+	}
+
+	determinant = det.getValue();
+	solution.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		solution[i] = reduced[i][n].getValue();
+	}
+
+	return true;
+}
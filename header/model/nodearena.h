@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// nodes of one tree placed one after another in large blocks: making a node moves a
+// pointer instead of calling the allocator, the nodes point to each other without
+// counting references, and the whole tree is destroyed and released at once
+
+// bytes of one block, a larger node gets a block of its own
+constexpr size_t NODE_ARENA_BLOCK = 1 << 14;
+
+template <typename Base>
+class nodeArena {
+public:
+	nodeArena() = default;
+	nodeArena(const nodeArena& other) = delete;
+	nodeArena& operator=(const nodeArena& other) = delete;
+	~nodeArena() { clear(); }
+
+	// new node of a type derived from Base, alive until the arena is cleared
+	template <typename Node, typename... Args>
+	Node* make(Args&&... args);
+
+	// destroy all the nodes and give back all the blocks but the first
+	void clear();
+
+	size_t size() const { return nodes_.size(); }
+
+private:
+	void* allocate(size_t bytes);
+
+	std::vector<std::unique_ptr<unsigned char[]>> blocks_;
+	size_t used_ = NODE_ARENA_BLOCK; // bytes taken in the last block
+	std::vector<Base*> nodes_; // in the order they were made, destroyed in reverse
+};
+
+
+//------------------------------------------------------------------
+
+
+template <typename Base>
+template <typename Node, typename... Args>
+Node* nodeArena<Base>::make(Args&&... args) {
+	Node* node = new (allocate(sizeof(Node))) Node(std::forward<Args>(args)...);
+	nodes_.push_back(node);
+
+	return node;
+}
+
+template <typename Base>
+void nodeArena<Base>::clear() {
+	for (size_t i = nodes_.size(); i-- > 0;) {
+		nodes_[i]->~Base();
+	}
+	nodes_.clear();
+
+	if (blocks_.size() > 1) {
+		blocks_.resize(1);
+	}
+	used_ = blocks_.empty() ? NODE_ARENA_BLOCK : 0;
+}
+
+// every node starts at the strictest alignment, so any node type may follow any other
+template <typename Base>
+void* nodeArena<Base>::allocate(size_t bytes) {
+	const size_t align = alignof(std::max_align_t);
+	bytes = (bytes + align - 1) / align * align;
+
+	if (bytes > NODE_ARENA_BLOCK) {
+		// kept before the last block, which stays the one being filled
+		std::unique_ptr<unsigned char[]> large(new unsigned char[bytes]);
+		void* memory = large.get();
+		blocks_.insert(blocks_.empty() ? blocks_.end() : blocks_.end() - 1, std::move(large));
+		return memory;
+	}
+
+	if (used_ + bytes > NODE_ARENA_BLOCK) {
+		blocks_.emplace_back(new unsigned char[NODE_ARENA_BLOCK]);
+		used_ = 0;
+	}
+
+	void* memory = blocks_.back().get() + used_;
+	used_ += bytes;
+
+	return memory;
+}
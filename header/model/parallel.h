@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+// number of worker threads used by the parallel kernels
+size_t workersCount();
+
+// run body(i) for every i in [begin, end), splitting the range between the workers
+void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body);
+
+// tasks run on one pool of workers shared by the whole program: every worker takes the tasks of
+// its own queue, newest first, and steals the oldest ones of the other queues when it runs out;
+// a thread waiting for a group runs queued tasks meanwhile, so that kernels started inside of a
+// task share the same workers instead of starting threads of their own, and sleeps once there
+// are none until any task is added to the pool or the last one of the group finishes
+class taskGroup {
+public:
+	taskGroup() = default;
+	taskGroup(const taskGroup& other) = delete;
+	taskGroup& operator=(const taskGroup& other) = delete;
+	~taskGroup() { wait(); }
+
+	void run(std::function<void()> task);
+
+	// return once every task of the group has finished
+	void wait();
+
+private:
+	std::atomic<size_t> pending_{0}; // tasks of the group which have not finished
+};
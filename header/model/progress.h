@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// progress of an evaluation running off the interface thread: the long kernels report the
+// step they have reached and check between their steps whether the evaluation was cancelled,
+// in which case they stop early and their answer is thrown away
+struct evaluationProgress {
+	std::atomic<size_t> done_{0}; // steps of the last reporting kernel which are finished
+	std::atomic<size_t> total_{0}; // steps of the last reporting kernel
+	std::atomic<bool> is_cancelled_{false};
+};
+
+// progress the kernels report to, nullptr if no evaluation is watched
+void setEvaluationProgress(evaluationProgress* progress);
+
+// whether the watched evaluation was cancelled
+bool isEvaluationCancelled();
+
+// done of total steps of a kernel are finished
+void reportProgress(size_t done, size_t total);
@@ -17,15 +17,32 @@ struct Query {
 	std::string exp_; // expression to calculated
 	int variable_used_; // variable used to store matrix
 	std::vector<std::vector<std::string>> matrix_; // matrix that is used for init
+	std::string solve_method_ = "direct"; // "direct", "cg", "bicgstab" or "gmres"
+	std::string preconditioner_ = "ilu"; // "none", "jacobi" or "ilu"
 
 	Query() = default;
 };
 
 struct Answer {
 	std::string error_message_ = ""; // error message if any
-	float ans_float_; // answer if its a number
-	bool is_ans_number_; // flag whether ans was number or not
+	std::string exp_; // expression the answer belongs to
+	float ans_float_ = 0; // answer if its a number
+	bool is_ans_number_ = false; // flag whether ans was number or not
 	std::vector<std::vector<float>> ans_matrix_; // answer if its a matrix
+	std::string type_; // type the answer was computed in
+	std::string ans_string_; // printed answer if its a number
+	std::vector<std::vector<std::string>> ans_matrix_string_; // printed answer if its a matrix
+	size_t refinement_steps_ = 0; // refinement steps taken by the linear solver
+	size_t iterations_ = 0; // iterations taken by the krylov solver
+	double residual_ = 0; // norm of the final residual of the linear solver
+	bool is_least_squares_ = false; // whether the solution only minimizes the residual
+	size_t cache_hits_ = 0; // subexpressions taken from the answers of earlier queries
+	size_t cache_misses_ = 0; // subexpressions which were not cached and had to be computed
+	size_t in_place_ = 0; // subexpressions written into the storage of an operand no later step read
+	std::vector<std::string> rewrites_; // identities the expression was rewritten with before it was computed
+	size_t cubic_before_ = 0; // operators of cubic cost in the expression as written
+	size_t cubic_after_ = 0; // operators of cubic cost left after the rewrites
+	std::vector<Answer> recomputed_; // answers of the expressions which read a changed variable
 
 	Answer() = default;
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "biginteger.h"
+
+// exact fraction, kept inline as a pair of 64 bit integers while they fit and
+// promoted to big integers only when an operation overflows
+class rationalNumber {
+public:
+	// constructors and operator =
+
+	rationalNumber(long long value = 0);
+	rationalNumber(long long numerator, long long denominator);
+	rationalNumber(const bigInteger& numerator, const bigInteger& denominator);
+	~rationalNumber() = default;
+	rationalNumber(const rationalNumber& other);
+	rationalNumber& operator=(const rationalNumber& other);
+	rationalNumber(rationalNumber&& other) noexcept = default;
+	rationalNumber& operator=(rationalNumber&& other) noexcept = default;
+
+	// arithmetic assignments
+
+	rationalNumber& operator+=(const rationalNumber& rhs);
+	rationalNumber& operator-=(const rationalNumber& rhs);
+	rationalNumber& operator*=(const rationalNumber& rhs);
+	rationalNumber& operator/=(const rationalNumber& rhs);
+
+	// unary minus
+
+	rationalNumber operator-() const;
+
+	// sign and representation
+
+	bool isZero() const;
+	bool isNegative() const;
+	bool isInteger() const;
+	bool isInline() const;
+
+	// reduced numerator and positive denominator
+
+	bigInteger numerator() const;
+	bigInteger denominator() const;
+
+	// presentations
+
+	double toDouble() const;
+	std::string toString() const;
+
+	// compare values, returns -1, 0 or 1
+
+	static int compare(const rationalNumber& lhs, const rationalNumber& rhs);
+
+private:
+	// big integer representation used after an overflow
+	struct bigPart {
+		bigInteger numerator_;
+		bigInteger denominator_;
+	};
+
+	// reduce a big fraction and move it back inline if it fits
+	void setBig(bigInteger numerator, bigInteger denominator);
+
+	// reduce an inline fraction with a nonzero denominator
+	void setInline(long long numerator, long long denominator);
+
+	long long numerator_; // numerator while the value is inline
+	long long denominator_; // positive denominator while the value is inline
+	std::unique_ptr<bigPart> big_; // null while the value is inline
+};
+
+// more arithmetics
+
+rationalNumber operator+(const rationalNumber& lhs, const rationalNumber& rhs);
+rationalNumber operator-(const rationalNumber& lhs, const rationalNumber& rhs);
+rationalNumber operator*(const rationalNumber& lhs, const rationalNumber& rhs);
+rationalNumber operator/(const rationalNumber& lhs, const rationalNumber& rhs);
+
+// comparisons
+
+bool operator==(const rationalNumber& lhs, const rationalNumber& rhs);
+bool operator!=(const rationalNumber& lhs, const rationalNumber& rhs);
+bool operator<(const rationalNumber& lhs, const rationalNumber& rhs);
+bool operator>(const rationalNumber& lhs, const rationalNumber& rhs);
+bool operator<=(const rationalNumber& lhs, const rationalNumber& rhs);
+bool operator>=(const rationalNumber& lhs, const rationalNumber& rhs);
+
+// parse integers, decimals and fractions like "-3", "0.25" or "1/3",
+// false if the text is not a rational number
+
+bool parseRational(const std::string& text, rationalNumber& number);
+
+// output
+
+std::ostream& operator<<(std::ostream& out, const rationalNumber& number);
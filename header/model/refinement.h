@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+// mixed precision solver for a square system given as an augmented matrix [A | b]:
+// A is factored once in float, residuals are computed in double and the float
+// factors are reused to correct the solution until it reaches double accuracy;
+// false if A is singular in float or the refinement does not converge, the error
+// is only set if the evaluation was cancelled
+bool refinedSolve(const Matrix<double>& system, std::vector<double>& solution, size_t& steps, double& residual,
+				  std::string& error);
@@ -2,36 +2,39 @@
 
 #include <iostream>
 
-template <size_t N, size_t K, bool is_smaller>
-struct isPrimeHelper {
-	static const bool value = N % K == 0 ? false : isPrimeHelper<N, K + 1, K * K <= N>::value;
-};
+// trial division, evaluated at compile time (a constexpr loop instead of template
+// recursion so that word size moduli do not exceed the instantiation depth)
+constexpr bool isPrimeNumber(size_t n) {
+	if (n < 2) {
+		return false;
+	}
 
-template <size_t N, size_t K>
-struct isPrimeHelper<N, K, false> {
-	static const bool value = true;
-};
+	for (size_t k = 2; k * k <= n; ++k) {
+		if (n % k == 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
 
 template <size_t N>
 struct isPrime {
-	static const bool value = isPrimeHelper<N, 2, N >= 4>::value;
-};
-
-template <>
-struct isPrime<1> {
-	static const bool value = false;
+	static const bool value = isPrimeNumber(N);
 };
 
 template <size_t N>
 const bool is_prime_v = isPrime<N>::value;
 
+// residues modulo N, residue<0> takes its modulus at runtime from the thread it runs on,
+// which is set for the time of an evaluation by a modulusScope
 template <size_t N>
 class residue {
 public:
 
 	// constructor and operator =
 
-	residue() = default;
+	residue();
 	residue(int value);
 	~residue() = default;
 	residue(const residue& other);
@@ -52,17 +55,36 @@ public:
 
 	size_t getValue() const;
 
+	// modulus of the field
+
+	static size_t modulus();
+	static void setModulus(size_t modulus);
+
 private:
 
 	// quick power in O(logn)
 
-	size_t power(size_t power_value);
+	size_t power(size_t power_value) const;
 
 	// get invert
 
 	size_t invert() const;
 
 	size_t value_; // value in modulo N field
+	static inline thread_local size_t runtime_modulus_ = 1; // modulus used when N is 0
+};
+
+// modulus of residue<0> on the current thread while the scope lasts, the one before is put back
+// when it ends; the pool runs every task with the modulus of the thread which gave it
+class modulusScope {
+public:
+	explicit modulusScope(size_t modulus);
+	modulusScope(const modulusScope& other) = delete;
+	modulusScope& operator=(const modulusScope& other) = delete;
+	~modulusScope();
+
+private:
+	size_t previous_;
 };
 
 // more arithmetics
@@ -98,13 +120,14 @@ std::ostream& operator<<(std::ostream& out, const residue<N>& number);
 
 // ----------------------------------------------------------------------------------------
 
+template <size_t N>
+residue<N>::residue(): value_(0) {}
+
 template <size_t N>
 residue<N>::residue(int value) {
-	if (value < 0) {
-		value *= 1 - N;
-	}
+	long long rest = static_cast<long long>(value) % static_cast<long long>(modulus());
 
-	value_ = value % N;
+	value_ = rest < 0 ? rest + modulus() : rest;
 }
 
 template <size_t N>
@@ -119,30 +142,30 @@ residue<N>& residue<N>::operator=(const residue& other) {
 
 template <size_t N>
 residue<N>& residue<N>::operator+=(const residue& rhs) {
-	value_ = (value_ + rhs.value_) % N;
+	value_ = (value_ + rhs.value_) % modulus();
 
 	return *this;
 }
 
 template <size_t N>
 residue<N>& residue<N>::operator-=(const residue& rhs) {
-	value_ = value_ > rhs.value_ ? value_ - rhs.value_ : N + value_ - rhs.value_;
+	value_ = value_ >= rhs.value_ ? value_ - rhs.value_ : modulus() + value_ - rhs.value_;
 
 	return *this;
 }
 
 template <size_t N>
 residue<N>& residue<N>::operator*=(const residue& rhs) {
-	value_ = (value_ * rhs.value_) % N;
+	value_ = (value_ * rhs.value_) % modulus();
 
 	return *this;
 }
 
 template <size_t N>
 residue<N>& residue<N>::operator/=(const residue& rhs) {
-	static_assert(is_prime_v<N>, "No inverts in non-prime fields");
+	static_assert(N == 0 || is_prime_v<N>, "No inverts in non-prime fields");
 
-	value_ = (value_ * rhs.invert()) % N;
+	value_ = (value_ * rhs.invert()) % modulus();
 
 	return *this;
 }
@@ -153,25 +176,50 @@ residue<N>::operator int() const {
 }
 
 template <size_t N>
-size_t residue<N>::power(size_t power_value) {
-	if (power_value == 1) {
-		return value_;
+size_t residue<N>::getValue() const {
+	return value_;
+}
+
+template <size_t N>
+size_t residue<N>::modulus() {
+	return N != 0 ? N : runtime_modulus_;
+}
+
+template <size_t N>
+void residue<N>::setModulus(size_t modulus) {
+	static_assert(N == 0, "Only residue<0> has a runtime modulus");
+
+	runtime_modulus_ = modulus;
+}
+
+inline modulusScope::modulusScope(size_t modulus): previous_(residue<0>::modulus()) {
+	residue<0>::setModulus(modulus);
+}
+
+inline modulusScope::~modulusScope() {
+	residue<0>::setModulus(previous_);
+}
+
+template <size_t N>
+size_t residue<N>::power(size_t power_value) const {
+	if (power_value == 0) {
+		return 1 % modulus();
 	}
 
 	size_t helper;
 	if (power_value % 2 == 0) {
 		helper = power(power_value / 2);
-		return (helper * helper) % N;
+		return (helper * helper) % modulus();
 	}
 	else {
 		helper = power(power_value - 1);
-		return helper * value_;
+		return (helper * value_) % modulus();
 	}
 }
 
 template <size_t N>
 size_t residue<N>::invert() const {
-	return power(N - 2);
+	return power(modulus() - 2);
 }
 
 template <size_t N>
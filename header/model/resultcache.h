@@ -0,0 +1,129 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "matrix.h"
+#include "matrixview.h"
+
+// answers of subtrees kept between queries, keyed by the number of the subtree in the table of
+// its field, in which every variable carries its version, so that a changed variable never hits
+// an old answer; the least recently used answers are dropped once the entries exceed the capacity
+
+// answer of a subtree as it is kept in the cache
+template <typename Field>
+struct cachedResult {
+	bool is_ans_number_ = false;
+	Field ans_number_ = Field(0);
+	std::vector<Matrix<Field>> ans_factors_; // factors if the answer is a kronecker product
+	std::vector<matrixView<Field>> ans_views_; // pieces of the answer otherwise, sharing the storage of the matrices
+};
+
+// entries of the field the cache may hold before it drops answers
+constexpr size_t RESULT_CACHE_ENTRIES = 1 << 22;
+
+template <typename Field>
+class resultCache {
+public:
+	resultCache(size_t capacity = RESULT_CACHE_ENTRIES): capacity_(capacity) {}
+
+	// answer kept for the key, which becomes the most recently used one
+	bool find(size_t key, cachedResult<Field>& result);
+
+	// keep the answer, an answer larger than the whole capacity is not kept
+	void insert(size_t key, const cachedResult<Field>& result);
+
+	void clear();
+
+	// lookups answered from the cache and lookups which had to be computed
+	size_t hits() const { return hits_; }
+	size_t misses() const { return misses_; }
+
+private:
+	struct entry {
+		cachedResult<Field> result_;
+		size_t entries_ = 0; // entries of the field the answer holds
+		size_t last_use_ = 0; // time of the last lookup or insertion
+	};
+
+	// entries of the field an answer holds, a view holds the whole matrix it reads
+	static size_t countEntries(const cachedResult<Field>& result);
+
+	void touch(size_t key, entry& value);
+
+	size_t capacity_;
+	size_t entries_ = 0; // entries of all the kept answers
+	size_t time_ = 0; // counter of uses
+	size_t hits_ = 0;
+	size_t misses_ = 0;
+	std::unordered_map<size_t, entry> answers_;
+	std::map<size_t, size_t> order_; // keys by the time of their last use, oldest first
+};
+
+
+//------------------------------------------------------------------
+
+
+template <typename Field>
+bool resultCache<Field>::find(size_t key, cachedResult<Field>& result) {
+	auto found = answers_.find(key);
+	if (found == answers_.end()) {
+		++misses_;
+		return false;
+	}
+
+	++hits_;
+	touch(key, found->second);
+	result = found->second.result_;
+
+	return true;
+}
+
+template <typename Field>
+void resultCache<Field>::insert(size_t key, const cachedResult<Field>& result) {
+	size_t entries = countEntries(result);
+	if (entries > capacity_ || answers_.count(key)) {
+		return;
+	}
+
+	while (entries_ + entries > capacity_) {
+		auto oldest = order_.begin();
+		entries_ -= answers_[oldest->second].entries_;
+		answers_.erase(oldest->second);
+		order_.erase(oldest);
+	}
+
+	entry& value = answers_[key];
+	value.result_ = result;
+	value.entries_ = entries;
+	entries_ += entries;
+	touch(key, value);
+}
+
+template <typename Field>
+void resultCache<Field>::clear() {
+	answers_.clear();
+	order_.clear();
+	entries_ = 0;
+}
+
+template <typename Field>
+size_t resultCache<Field>::countEntries(const cachedResult<Field>& result) {
+	size_t entries = 1;
+	for (const Matrix<Field>& factor : result.ans_factors_) {
+		entries += factor.getRow() * factor.getCol();
+	}
+	for (const matrixView<Field>& view : result.ans_views_) {
+		entries += view.source_->getRow() * view.source_->getCol();
+	}
+
+	return entries;
+}
+
+template <typename Field>
+void resultCache<Field>::touch(size_t key, entry& value) {
+	order_.erase(value.last_use_);
+	value.last_use_ = ++time_;
+	order_[value.last_use_] = key;
+}
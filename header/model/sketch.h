@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+// randomized sketches of large real matrices: a gaussian test matrix compresses the range
+// of A into a few columns, which are orthonormalized by a small qr; everything costs
+// O(m n k) for k sketch columns instead of the O(m n min(m, n)) of the dense kernels
+
+// spectral norm ||A||_2 by power iteration on A^T A from a random start, stops once
+// two estimates agree to the relative tolerance
+bool powerNorm(const Matrix<double>& matrix, double tolerance, double& norm, std::string& error);
+
+// numerical rank: the adaptive range finder grows an orthonormal basis Q block by block
+// until the posterior estimate of ||A - Q Q^T A|| taken with oversampling probe vectors
+// drops below tolerance * ||A||, then the singular values of Q^T A above that level are counted
+bool sketchRank(const Matrix<double>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error);
+
+// leading count singular values from a sketch of count + oversampling columns refined by
+// power iterations, the small matrix Q^T A goes to the jacobi svd
+bool sketchSingularValues(const Matrix<double>& matrix, size_t count, size_t oversampling,
+						  std::vector<double>& values, std::string& error);
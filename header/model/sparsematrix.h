@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "matrix.h"
+
+// real matrix in compressed sparse row form: the nonzeros of row i are
+// values_[row_start_[i] .. row_start_[i + 1]) in the columns columns_[...]
+class sparseMatrix {
+public:
+	// constructors and destructor
+	sparseMatrix(size_t row = 0, size_t col = 0);
+	sparseMatrix(const Matrix<double>& dense);
+	~sparseMatrix() = default;
+	sparseMatrix(const sparseMatrix& other) = default;
+	sparseMatrix& operator=(const sparseMatrix& other) = default;
+
+	// y = A x
+	void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+	// share of entries which are nonzero
+	double density() const;
+
+	// getters
+	size_t getRow() const;
+	size_t getCol() const;
+	size_t nonZeros() const;
+	const std::vector<size_t>& rowStart() const;
+	const std::vector<size_t>& columns() const;
+	const std::vector<double>& values() const;
+
+private:
+	size_t row_; // number of rows
+	size_t col_; // number of columns
+	std::vector<size_t> row_start_; // offset of every row, row_ + 1 entries
+	std::vector<size_t> columns_; // column of every nonzero, increasing within a row
+	std::vector<double> values_; // value of every nonzero
+};
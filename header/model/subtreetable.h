@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+// numbers of subtrees, equal for equal subtrees: a subtree is its operator with its parameters
+// and the numbers of its children, so numbering a tree takes one lookup per node whatever its
+// depth; a number is never given to another subtree until the table is cleared
+class subtreeTable {
+public:
+	// number of the node over the children numbered left and right, 0 for a missing child
+	size_t getKey(const std::string& node, size_t left = 0, size_t right = 0);
+
+	size_t size() const { return keys_.size(); }
+	void clear();
+
+private:
+	struct entry {
+		std::string node_;
+		size_t left_ = 0;
+		size_t right_ = 0;
+
+		bool operator==(const entry& other) const;
+	};
+
+	struct entryHash {
+		size_t operator()(const entry& value) const;
+	};
+
+	std::unordered_map<entry, size_t, entryHash> keys_;
+};
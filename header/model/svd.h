@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+// thin singular value decomposition A = U diag(sigma) V^H of an m x n matrix by
+// one-sided jacobi rotations, the disjoint column pairs of every round are rotated
+// in parallel; singular values come in decreasing order, Scalar is double or
+// std::complex<double>
+template <typename Scalar>
+bool jacobiSvd(const Matrix<Scalar>& matrix, Matrix<Scalar>& u, std::vector<double>& sigma,
+			   Matrix<Scalar>& v, std::string& error);
+
+// moore-penrose pseudo-inverse, singular values below epsilon * max(m, n) * sigma_max
+// are treated as zero
+template <typename Scalar>
+bool pseudoInverse(const Matrix<Scalar>& matrix, double epsilon, Matrix<Scalar>& result, std::string& error);
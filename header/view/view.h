@@ -33,6 +33,10 @@ struct configs {
 	float ERROR_SCREEN_X_COOR_FACTOR = 0.2;
 	float ERROR_SCREEN_Y_COOR_FACTOR = 0.1;
 
+	// progress configs
+	int PROGRESS_POPUP_DELAY = 250; // milliseconds a query runs before its progress is shown
+	float PROGRESS_BAR_WIDTH = 200;
+
 	// buttons configs
 	float BUTTONS_INIT_X_FACTOR = 0.075;
 	float BUTTONS_INIT_Y_FACTOR = 0.3;
@@ -42,9 +46,9 @@ struct configs {
 	float BUTTONS_SHIFTX_FACTOR_FIRST = 0.09375 + 0.1 / 7; // horizontal seperation of buttons in first part
 	float BUTTONS_SHIFTX_FACTOR_SECOND = 0.145; // horizontal seperation of buttons in second part
 	float BUTTONS_SHIFTY_FACTOR = 0.075; // vertical separation of buttons
-	int BUTTONS_COUNT = 62; // total number of buttons
+	int BUTTONS_COUNT = 80; // total number of buttons
 	int BUTTONS_COUNT_FIRST = 32; // number of buttons in first part
-	int BUTTONS_COUNT_SECOND = 30; // number of buttons in second part
+	int BUTTONS_COUNT_SECOND = 48; // number of buttons in second part
 	int BUTTONS_PER_LINE_FIRST = 8; // number of buttons per line in first part
 	int BUTTONS_PER_LINE_SECOND = 6; // number of buttons per line in second part
 
@@ -111,6 +115,10 @@ public:
 	Query& getQuery();
 	void processAnswer(const Answer& answer);
 
+	// progress of the query being processed and whether the user asked to stop it
+	void setProgress(size_t done, size_t total);
+	bool isCancelRequested();
+
 private:
 	// private constructor for singleton pattern
 	View();
@@ -141,6 +149,7 @@ private:
 	void displayDimensionsPopup();
 	void displayListPopup();
 	void displayEquationPopup();
+	void displayProgressPopup();
 
 	// handle buttons
 	void handleGeneralButton(const std::string& symbol, float width, float height);
@@ -186,9 +195,16 @@ private:
 	std::vector<std::vector<std::string>> equations_; // matrix for system of equations
 	std::chrono::steady_clock::time_point lastToggleTime_; // time stamp of last display of cursor
 	std::string type_;
+	std::string solve_method_; // method for systems and the solve operator
+	std::string preconditioner_; // preconditioner of the iterative methods
 	configs configs_; // configurations of interface
 	Query query_;
 	Answer answer_;
 	int is_answer_ready_; // whether to print the answer out or not
+	bool is_evaluating_; // whether the query is being processed
+	bool is_cancel_requested_; // whether the user asked to stop the query
+	size_t progress_done_; // steps of the query done
+	size_t progress_total_; // steps of the query, 0 if not known yet
+	std::chrono::steady_clock::time_point evaluation_start_; // time stamp of the start of the query
 	static sptrView view_; // singleton pattern
 };
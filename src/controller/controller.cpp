@@ -21,15 +21,33 @@ void Controller::run() {
 
 		view_->setUpInterface();
 
-		Query query = view_->getQuery();
+		const Query& query = view_->getQuery();
 
-		if (query.type_of_query_ != noQuery) {
-			Answer ans = model_->processQuery(query);
-			view_->processAnswer(ans);
+		// the query is processed by a job, the frames go on while it runs
+		if (query.type_of_query_ != noQuery && !job_) {
+			job_ = std::make_shared<evaluationJob>(model_, query);
+		}
+
+		if (job_) {
+			size_t done, total;
+			job_->getProgress(done, total);
+			view_->setProgress(done, total);
+
+			if (view_->isCancelRequested()) {
+				job_->cancel();
+			}
+
+			if (job_->isFinished()) {
+				view_->processAnswer(job_->getAnswer());
+				job_.reset();
+			}
 		}
 
 		view_->render();
 	}
 
+	// a job left running when the window closes is cancelled
+	job_.reset();
+
 	view_->cleanUp();
 }
@@ -0,0 +1,437 @@
+#include "biginteger.h"
+
+#include <algorithm>
+#include <cmath>
+
+// constructor
+
+bigInteger::bigInteger(long long value): negative_(value < 0) {
+	uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+	while (magnitude != 0) {
+		limbs_.push_back(static_cast<uint32_t>(magnitude));
+		magnitude >>= 32;
+	}
+}
+
+// arithmetic assignments
+
+bigInteger& bigInteger::operator+=(const bigInteger& rhs) {
+	if (negative_ == rhs.negative_) {
+		limbs_ = addAbs(limbs_, rhs.limbs_);
+	}
+	else if (compareAbs(*this, rhs) >= 0) {
+		limbs_ = subAbs(limbs_, rhs.limbs_);
+	}
+	else {
+		limbs_ = subAbs(rhs.limbs_, limbs_);
+		negative_ = rhs.negative_;
+	}
+	trim();
+
+	return *this;
+}
+
+bigInteger& bigInteger::operator-=(const bigInteger& rhs) {
+	*this += -rhs;
+
+	return *this;
+}
+
+bigInteger& bigInteger::operator*=(const bigInteger& rhs) {
+	if (isZero() || rhs.isZero()) {
+		*this = bigInteger(0);
+		return *this;
+	}
+
+	std::vector<uint32_t> result(limbs_.size() + rhs.limbs_.size(), 0);
+	for (size_t i = 0; i < limbs_.size(); ++i) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < rhs.limbs_.size(); ++j) {
+			uint64_t cur = static_cast<uint64_t>(limbs_[i]) * rhs.limbs_[j] + result[i + j] + carry;
+			result[i + j] = static_cast<uint32_t>(cur);
+			carry = cur >> 32;
+		}
+		result[i + rhs.limbs_.size()] = static_cast<uint32_t>(carry);
+	}
+
+	limbs_ = result;
+	negative_ = negative_ != rhs.negative_;
+	trim();
+
+	return *this;
+}
+
+bigInteger& bigInteger::operator/=(const bigInteger& rhs) {
+	bigInteger remainder;
+	divide(*this, rhs, *this, remainder);
+
+	return *this;
+}
+
+bigInteger& bigInteger::operator%=(const bigInteger& rhs) {
+	bigInteger quotient;
+	divide(*this, rhs, quotient, *this);
+
+	return *this;
+}
+
+bigInteger bigInteger::operator-() const {
+	bigInteger copy = *this;
+	if (!copy.isZero()) {
+		copy.negative_ = !copy.negative_;
+	}
+
+	return copy;
+}
+
+// long division, Knuth's algorithm D
+void bigInteger::divide(const bigInteger& lhs, const bigInteger& rhs, bigInteger& quotient, bigInteger& remainder) {
+	bool quotient_negative = lhs.negative_ != rhs.negative_;
+	bool remainder_negative = lhs.negative_;
+
+	if (compareAbs(lhs, rhs) < 0) {
+		remainder = lhs;
+		quotient = bigInteger(0);
+		return;
+	}
+
+	if (rhs.limbs_.size() == 1) {
+		std::vector<uint32_t> limbs = lhs.limbs_;
+		uint32_t rest = divideSmall(limbs, rhs.limbs_[0]);
+		quotient.limbs_ = limbs;
+		quotient.negative_ = quotient_negative;
+		quotient.trim();
+		remainder = bigInteger(rest);
+		if (remainder_negative) {
+			remainder = -remainder;
+		}
+		return;
+	}
+
+	// normalize so that the leading limb of the divisor has its top bit set
+	int shift = 0;
+	while ((rhs.limbs_.back() << shift & 0x80000000u) == 0) {
+		++shift;
+	}
+
+	size_t n = rhs.limbs_.size();
+	size_t m = lhs.limbs_.size() - n;
+	std::vector<uint32_t> u(lhs.limbs_.size() + 1, 0);
+	std::vector<uint32_t> v(n, 0);
+	for (size_t i = n; i-- > 0; ) {
+		v[i] = rhs.limbs_[i] << shift | (shift && i ? static_cast<uint32_t>(static_cast<uint64_t>(rhs.limbs_[i - 1]) >> (32 - shift)) : 0);
+	}
+	u[lhs.limbs_.size()] = shift ? static_cast<uint32_t>(static_cast<uint64_t>(lhs.limbs_.back()) >> (32 - shift)) : 0;
+	for (size_t i = lhs.limbs_.size(); i-- > 0; ) {
+		u[i] = lhs.limbs_[i] << shift | (shift && i ? static_cast<uint32_t>(static_cast<uint64_t>(lhs.limbs_[i - 1]) >> (32 - shift)) : 0);
+	}
+
+	std::vector<uint32_t> q(m + 1, 0);
+	const uint64_t base = 1ull << 32;
+	for (size_t j = m + 1; j-- > 0; ) {
+		uint64_t numerator = static_cast<uint64_t>(u[j + n]) << 32 | u[j + n - 1];
+		uint64_t qhat = numerator / v[n - 1];
+		uint64_t rhat = numerator % v[n - 1];
+		while (qhat >= base || qhat * v[n - 2] > (rhat << 32 | u[j + n - 2])) {
+			--qhat;
+			rhat += v[n - 1];
+			if (rhat >= base) {
+				break;
+			}
+		}
+
+		// multiply and subtract
+		int64_t borrow = 0;
+		uint64_t carry = 0;
+		for (size_t i = 0; i < n; ++i) {
+			uint64_t product = qhat * v[i] + carry;
+			carry = product >> 32;
+			int64_t cur = static_cast<int64_t>(u[i + j]) - borrow - static_cast<int64_t>(product & 0xffffffffu);
+			u[i + j] = static_cast<uint32_t>(cur);
+			borrow = cur < 0 ? 1 : 0;
+		}
+		int64_t cur = static_cast<int64_t>(u[j + n]) - borrow - static_cast<int64_t>(carry);
+		u[j + n] = static_cast<uint32_t>(cur);
+
+		// add back if qhat was one too large
+		if (cur < 0) {
+			--qhat;
+			uint64_t add_carry = 0;
+			for (size_t i = 0; i < n; ++i) {
+				uint64_t sum = static_cast<uint64_t>(u[i + j]) + v[i] + add_carry;
+				u[i + j] = static_cast<uint32_t>(sum);
+				add_carry = sum >> 32;
+			}
+			u[j + n] += static_cast<uint32_t>(add_carry);
+		}
+		q[j] = static_cast<uint32_t>(qhat);
+	}
+
+	quotient.limbs_ = q;
+	quotient.negative_ = quotient_negative;
+	quotient.trim();
+
+	// unnormalize the remainder
+	remainder.limbs_.assign(n, 0);
+	for (size_t i = 0; i < n; ++i) {
+		remainder.limbs_[i] = u[i] >> shift | (shift ? static_cast<uint32_t>(static_cast<uint64_t>(u[i + 1]) << (32 - shift)) : 0);
+	}
+	remainder.negative_ = remainder_negative;
+	remainder.trim();
+}
+
+uint64_t bigInteger::modulo(uint64_t value) const {
+	unsigned __int128 rest = 0;
+	for (size_t i = limbs_.size(); i-- > 0; ) {
+		rest = (rest << 32 | limbs_[i]) % value;
+	}
+
+	return static_cast<uint64_t>(rest);
+}
+
+// sign and size
+
+bool bigInteger::isZero() const {
+	return limbs_.empty();
+}
+
+bool bigInteger::isNegative() const {
+	return negative_;
+}
+
+size_t bigInteger::bitLength() const {
+	if (limbs_.empty()) {
+		return 0;
+	}
+
+	size_t bits = 32 * (limbs_.size() - 1);
+	uint32_t top = limbs_.back();
+	while (top != 0) {
+		++bits;
+		top >>= 1;
+	}
+
+	return bits;
+}
+
+bigInteger bigInteger::abs() const {
+	bigInteger copy = *this;
+	copy.negative_ = false;
+
+	return copy;
+}
+
+int bigInteger::compareAbs(const bigInteger& lhs, const bigInteger& rhs) {
+	if (lhs.limbs_.size() != rhs.limbs_.size()) {
+		return lhs.limbs_.size() < rhs.limbs_.size() ? -1 : 1;
+	}
+
+	for (size_t i = lhs.limbs_.size(); i-- > 0; ) {
+		if (lhs.limbs_[i] != rhs.limbs_[i]) {
+			return lhs.limbs_[i] < rhs.limbs_[i] ? -1 : 1;
+		}
+	}
+
+	return 0;
+}
+
+// presentations
+
+bool bigInteger::fitsInLongLong() const {
+	if (limbs_.size() > 2) {
+		return false;
+	}
+
+	uint64_t magnitude = limbs_.empty() ? 0 : limbs_[0];
+	if (limbs_.size() == 2) {
+		magnitude |= static_cast<uint64_t>(limbs_[1]) << 32;
+	}
+
+	return negative_ ? magnitude <= (1ull << 63) : magnitude < (1ull << 63);
+}
+
+long long bigInteger::toLongLong() const {
+	uint64_t magnitude = limbs_.empty() ? 0 : limbs_[0];
+	if (limbs_.size() >= 2) {
+		magnitude |= static_cast<uint64_t>(limbs_[1]) << 32;
+	}
+
+	return negative_ ? static_cast<long long>(0 - magnitude) : static_cast<long long>(magnitude);
+}
+
+double bigInteger::toDouble() const {
+	double result = 0;
+	for (size_t i = limbs_.size(); i-- > 0; ) {
+		result = result * 4294967296.0 + limbs_[i];
+	}
+
+	return negative_ ? -result : result;
+}
+
+std::string bigInteger::toString() const {
+	if (isZero()) {
+		return "0";
+	}
+
+	std::string result;
+	std::vector<uint32_t> limbs = limbs_;
+	while (!limbs.empty()) {
+		uint32_t rest = divideSmall(limbs, 1000000000u);
+		while (!limbs.empty() && limbs.back() == 0) {
+			limbs.pop_back();
+		}
+		for (int i = 0; i < 9 && (rest != 0 || !limbs.empty()); ++i) {
+			result += static_cast<char>('0' + rest % 10);
+			rest /= 10;
+		}
+	}
+
+	if (negative_) {
+		result += '-';
+	}
+	std::reverse(result.begin(), result.end());
+
+	return result;
+}
+
+// remove leading zero limbs
+void bigInteger::trim() {
+	while (!limbs_.empty() && limbs_.back() == 0) {
+		limbs_.pop_back();
+	}
+
+	if (limbs_.empty()) {
+		negative_ = false;
+	}
+}
+
+// operations on absolute values
+
+std::vector<uint32_t> bigInteger::addAbs(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs) {
+	const std::vector<uint32_t>& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+	const std::vector<uint32_t>& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+
+	std::vector<uint32_t> result(longer.size() + 1, 0);
+	uint64_t carry = 0;
+	for (size_t i = 0; i < longer.size(); ++i) {
+		uint64_t sum = static_cast<uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+		result[i] = static_cast<uint32_t>(sum);
+		carry = sum >> 32;
+	}
+	result[longer.size()] = static_cast<uint32_t>(carry);
+
+	return result;
+}
+
+// lhs must not be smaller than rhs
+std::vector<uint32_t> bigInteger::subAbs(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs) {
+	std::vector<uint32_t> result(lhs.size(), 0);
+	int64_t borrow = 0;
+	for (size_t i = 0; i < lhs.size(); ++i) {
+		int64_t cur = static_cast<int64_t>(lhs[i]) - borrow - (i < rhs.size() ? rhs[i] : 0);
+		borrow = cur < 0 ? 1 : 0;
+		result[i] = static_cast<uint32_t>(cur + (borrow << 32));
+	}
+
+	return result;
+}
+
+// divide in place by a single limb and return the remainder
+uint32_t bigInteger::divideSmall(std::vector<uint32_t>& limbs, uint32_t value) {
+	uint64_t rest = 0;
+	for (size_t i = limbs.size(); i-- > 0; ) {
+		uint64_t cur = rest << 32 | limbs[i];
+		limbs[i] = static_cast<uint32_t>(cur / value);
+		rest = cur % value;
+	}
+
+	return static_cast<uint32_t>(rest);
+}
+
+// more arithmetics
+
+bigInteger operator+(const bigInteger& lhs, const bigInteger& rhs) {
+	bigInteger copy = lhs;
+	copy += rhs;
+
+	return copy;
+}
+
+bigInteger operator-(const bigInteger& lhs, const bigInteger& rhs) {
+	bigInteger copy = lhs;
+	copy -= rhs;
+
+	return copy;
+}
+
+bigInteger operator*(const bigInteger& lhs, const bigInteger& rhs) {
+	bigInteger copy = lhs;
+	copy *= rhs;
+
+	return copy;
+}
+
+bigInteger operator/(const bigInteger& lhs, const bigInteger& rhs) {
+	bigInteger copy = lhs;
+	copy /= rhs;
+
+	return copy;
+}
+
+bigInteger operator%(const bigInteger& lhs, const bigInteger& rhs) {
+	bigInteger copy = lhs;
+	copy %= rhs;
+
+	return copy;
+}
+
+bigInteger gcd(bigInteger lhs, bigInteger rhs) {
+	lhs = lhs.abs();
+	rhs = rhs.abs();
+	while (!rhs.isZero()) {
+		lhs %= rhs;
+		std::swap(lhs, rhs);
+	}
+
+	return lhs;
+}
+
+// comparisons
+
+bool operator==(const bigInteger& lhs, const bigInteger& rhs) {
+	return lhs.isNegative() == rhs.isNegative() && bigInteger::compareAbs(lhs, rhs) == 0;
+}
+
+bool operator!=(const bigInteger& lhs, const bigInteger& rhs) {
+	return !(lhs == rhs);
+}
+
+bool operator<(const bigInteger& lhs, const bigInteger& rhs) {
+	if (lhs.isNegative() != rhs.isNegative()) {
+		return lhs.isNegative();
+	}
+
+	int cmp = bigInteger::compareAbs(lhs, rhs);
+
+	return lhs.isNegative() ? cmp > 0 : cmp < 0;
+}
+
+bool operator>(const bigInteger& lhs, const bigInteger& rhs) {
+	return rhs < lhs;
+}
+
+bool operator<=(const bigInteger& lhs, const bigInteger& rhs) {
+	return !(lhs > rhs);
+}
+
+bool operator>=(const bigInteger& lhs, const bigInteger& rhs) {
+	return !(lhs < rhs);
+}
+
+// output
+
+std::ostream& operator<<(std::ostream& out, const bigInteger& number) {
+	out << number.toString();
+
+	return out;
+}
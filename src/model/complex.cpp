@@ -2,8 +2,9 @@
 
 #include <cmath>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
 #include <type_traits>
-#include <cmath>
 
 bool cmp(float val1, float val2) {
 	float eps = 1e-7;
@@ -15,6 +16,12 @@ complexNumber::complexNumber(float re, float im): real_(re),
 												  imaginary_(im)
 {}
 
+complexNumber::complexNumber(const std::string& number): real_(0),
+														   imaginary_(0)
+{
+	parseComplex(number, *this);
+}
+
 complexNumber::complexNumber(const complexNumber& other): complexNumber(other.real_, other.imaginary_) {}
 
 complexNumber& complexNumber::operator=(const complexNumber& other) {
@@ -26,7 +33,7 @@ complexNumber& complexNumber::operator=(const complexNumber& other) {
 
 complexNumber& complexNumber::operator+=(const complexNumber& rhs) {
 	real_ += rhs.real_;
-	imaginary_ = rhs.imaginary_;
+	imaginary_ += rhs.imaginary_;
 
 	return *this;
 }
@@ -46,8 +53,9 @@ complexNumber& complexNumber::operator*=(float rhs) {
 }
 
 complexNumber& complexNumber::operator*=(const complexNumber& rhs) {
-	real_ = real_ * rhs.real_ - imaginary_ * rhs.imaginary_;
-	imaginary_ = real_ * rhs.imaginary_ + imaginary_ * rhs.real_;
+	float real = real_;
+	real_ = real * rhs.real_ - imaginary_ * rhs.imaginary_;
+	imaginary_ = real * rhs.imaginary_ + imaginary_ * rhs.real_;
 
 	return *this;
 }
@@ -55,12 +63,24 @@ complexNumber& complexNumber::operator*=(const complexNumber& rhs) {
 complexNumber& complexNumber::operator/=(const complexNumber& rhs) {
 	float len = rhs.length();
 
-	real_ = (real_ * rhs.real_ + imaginary_ * rhs.imaginary_) / (len * len);
-	imaginary_ = (imaginary_ * rhs.real_ - real_ * rhs.imaginary_) / (len * len);
+	float real = real_;
+	real_ = (real * rhs.real_ + imaginary_ * rhs.imaginary_) / (len * len);
+	imaginary_ = (imaginary_ * rhs.real_ - real * rhs.imaginary_) / (len * len);
 
 	return *this;
 }
 
+// "a+bi" with enough digits to read the number back exactly, a negative zero is printed as zero
+std::string complexNumber::toString() const {
+	float real = real_ == 0 ? 0.0f : real_;
+	float imaginary = imaginary_ == 0 ? 0.0f : imaginary_;
+
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), "%.7g%+.7gi", real, imaginary);
+
+	return buffer;
+}
+
 float complexNumber::length() const {
 	return sqrt(real_ * real_ + imaginary_ * imaginary_);
 }
@@ -153,6 +173,61 @@ std::ostream& operator<<(std::ostream& out, const complexNumber& number) {
 	return out;
 }
 
+// parse one of the parts "a" or "bi" of a complex number
+static bool parsePart(const std::string& part, complexNumber& number) {
+	if (part.empty()) {
+		return true;
+	}
+
+	bool is_imaginary = part.back() == 'i';
+	std::string value = is_imaginary ? part.substr(0, part.length() - 1) : part;
+	if (!is_imaginary && (value == "+" || value == "-")) {
+		return false;
+	}
+
+	float parsed;
+	if (value == "" || value == "+") {
+		parsed = 1;
+	}
+	else if (value == "-") {
+		parsed = -1;
+	}
+	else {
+		char* pend;
+		parsed = std::strtof(value.c_str(), &pend);
+		if (pend != value.c_str() + value.length()) {
+			return false;
+		}
+	}
+
+	number = is_imaginary ? complexNumber(number.re(), number.im() + parsed) :
+							complexNumber(number.re() + parsed, number.im());
+
+	return true;
+}
+
+bool parseComplex(const std::string& text, complexNumber& number) {
+	number = complexNumber(0, 0);
+
+	// split at the last sign which is not the leading one
+	size_t split = std::string::npos;
+	for (size_t i = 1; i < text.length(); ++i) {
+		if ((text[i] == '+' || text[i] == '-') && text[i - 1] != 'e') {
+			split = i;
+		}
+	}
+
+	if (text.empty()) {
+		return false;
+	}
+
+	if (split == std::string::npos) {
+		return parsePart(text, number);
+	}
+
+	return parsePart(text.substr(0, split), number) && parsePart(text.substr(split), number);
+}
+
 std::istream& operator>>(std::istream& in, complexNumber& number) {
 	std::string str;
 	in >> str;
@@ -0,0 +1,275 @@
+#include "complexmatrix.h"
+#include "progress.h"
+
+#include <cmath>
+
+// constructors
+
+complexMatrix::complexMatrix(size_t row, size_t col): re_(row, col),
+													  im_(row, col)
+{}
+
+complexMatrix::complexMatrix(const Matrix<float>& re, const Matrix<float>& im): re_(re),
+																				 im_(im)
+{}
+
+complexMatrix::complexMatrix(const std::vector<std::vector<complexNumber>>& matrix): re_(matrix.size(), matrix[0].size()),
+																					 im_(matrix.size(), matrix[0].size())
+{
+	for (size_t i = 0; i < getRow(); ++i) {
+		for (size_t j = 0; j < getCol(); ++j) {
+			set(i, j, matrix[i][j]);
+		}
+	}
+}
+
+// accessibility
+
+complexNumber complexMatrix::get(size_t row, size_t col) const {
+	return complexNumber(re_[row][col], im_[row][col]);
+}
+
+void complexMatrix::set(size_t row, size_t col, const complexNumber& value) {
+	re_[row][col] = value.re();
+	im_[row][col] = value.im();
+}
+
+const Matrix<float>& complexMatrix::re() const {
+	return re_;
+}
+
+const Matrix<float>& complexMatrix::im() const {
+	return im_;
+}
+
+// arithmetics
+
+complexMatrix& complexMatrix::operator+=(const complexMatrix& rhs) {
+	re_ += rhs.re_;
+	im_ += rhs.im_;
+
+	return *this;
+}
+
+complexMatrix& complexMatrix::operator-=(const complexMatrix& rhs) {
+	re_ -= rhs.re_;
+	im_ -= rhs.im_;
+
+	return *this;
+}
+
+complexMatrix complexMatrix::operator+(const complexMatrix& rhs) const {
+	complexMatrix copy = *this;
+	copy += rhs;
+
+	return copy;
+}
+
+complexMatrix complexMatrix::operator-(const complexMatrix& rhs) const {
+	complexMatrix copy = *this;
+	copy -= rhs;
+
+	return copy;
+}
+
+complexMatrix& complexMatrix::operator*=(const complexNumber& rhs) {
+	for (size_t i = 0; i < getRow(); ++i) {
+		scaleRow(i, rhs.re(), rhs.im());
+	}
+
+	return *this;
+}
+
+complexMatrix complexMatrix::operator*(const complexNumber& rhs) const {
+	complexMatrix copy = *this;
+	copy *= rhs;
+
+	return copy;
+}
+
+// 3M product: three real products instead of four,
+// re = Ar * Br - Ai * Bi and im = (Ar + Ai) * (Br + Bi) - Ar * Br - Ai * Bi
+complexMatrix complexMatrix::operator*(const complexMatrix& rhs) const {
+	Matrix<float> real = re_ * rhs.re_;
+	Matrix<float> imaginary = im_ * rhs.im_;
+	Matrix<float> mixed = (re_ + im_) * (rhs.re_ + rhs.im_);
+
+	mixed -= real;
+	mixed -= imaginary;
+	real -= imaginary;
+
+	return complexMatrix(real, mixed);
+}
+
+// determinant
+complexNumber complexMatrix::det() const {
+	complexMatrix copy = *this;
+	complexNumber determinant(1, 0);
+	std::vector<size_t> pivots = copy.eliminate(getCol(), determinant);
+
+	if (pivots.size() < getRow()) {
+		return complexNumber(0, 0);
+	}
+
+	return determinant;
+}
+
+// transposition
+complexMatrix complexMatrix::transposed() const {
+	return complexMatrix(re_.transposed(), im_.transposed());
+}
+
+// rank
+size_t complexMatrix::rank() const {
+	complexMatrix copy = *this;
+	complexNumber determinant(1, 0);
+
+	return copy.eliminate(getCol(), determinant).size();
+}
+
+// invert matrix, the caller checks that it is not singular
+complexMatrix complexMatrix::inverted() const {
+	size_t n = getRow();
+	complexMatrix copy(n, 2 * n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			copy.re_[i][j] = re_[i][j];
+			copy.im_[i][j] = im_[i][j];
+		}
+		copy.re_[i][n + i] = 1;
+	}
+
+	complexNumber determinant(1, 0);
+	copy.eliminate(n, determinant);
+
+	complexMatrix inverse(n, n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			inverse.re_[i][j] = copy.re_[i][n + j];
+			inverse.im_[i][j] = copy.im_[i][n + j];
+		}
+	}
+
+	return inverse;
+}
+
+// trace
+complexNumber complexMatrix::trace() const {
+	return complexNumber(re_.trace(), im_.trace());
+}
+
+// reduced row echelon form
+complexMatrix complexMatrix::getReducedRowEchelonForm() const {
+	complexMatrix copy = *this;
+	complexNumber determinant(1, 0);
+	copy.eliminate(getCol(), determinant);
+
+	return copy;
+}
+
+// getters
+
+size_t complexMatrix::getRow() const {
+	return re_.getRow();
+}
+
+size_t complexMatrix::getCol() const {
+	return re_.getCol();
+}
+
+std::vector<std::vector<complexNumber>> complexMatrix::getMatrix() const {
+	std::vector<std::vector<complexNumber>> matrix(getRow(), std::vector<complexNumber>(getCol()));
+	for (size_t i = 0; i < getRow(); ++i) {
+		for (size_t j = 0; j < getCol(); ++j) {
+			matrix[i][j] = get(i, j);
+		}
+	}
+
+	return matrix;
+}
+
+// gauss-jordan elimination with partial pivoting by modulus
+std::vector<size_t> complexMatrix::eliminate(size_t limit, complexNumber& determinant) {
+	std::vector<size_t> pivots;
+	size_t row = 0;
+
+	for (size_t col = 0; col < limit && row < getRow(); ++col) {
+		if (isEvaluationCancelled()) {
+			break;
+		}
+		reportProgress(col, limit);
+
+		size_t pivot = row;
+		float best = 0;
+		for (size_t i = row; i < getRow(); ++i) {
+			float norm = re_[i][col] * re_[i][col] + im_[i][col] * im_[i][col];
+			if (norm > best) {
+				best = norm;
+				pivot = i;
+			}
+		}
+		if (best == 0) {
+			continue;
+		}
+
+		if (pivot != row) {
+			swapRow(row, pivot);
+			determinant *= -1;
+		}
+
+		// normalize the pivot row by 1 / pivot = conj(pivot) / |pivot|^2
+		float pivot_re = re_[row][col];
+		float pivot_im = im_[row][col];
+		determinant *= complexNumber(pivot_re, pivot_im);
+		scaleRow(row, pivot_re / best, -pivot_im / best);
+
+		for (size_t i = 0; i < getRow(); ++i) {
+			if (i == row || (re_[i][col] == 0 && im_[i][col] == 0)) {
+				continue;
+			}
+			subtractRow(i, row, re_[i][col], im_[i][col], col);
+		}
+
+		pivots.push_back(col);
+		++row;
+	}
+
+	return pivots;
+}
+
+// row operations, plain loops over the two planes that the compiler vectorizes
+
+void complexMatrix::swapRow(size_t first, size_t second) {
+	float* first_re = re_[first];
+	float* first_im = im_[first];
+	float* second_re = re_[second];
+	float* second_im = im_[second];
+	for (size_t j = 0; j < getCol(); ++j) {
+		std::swap(first_re[j], second_re[j]);
+		std::swap(first_im[j], second_im[j]);
+	}
+}
+
+void complexMatrix::subtractRow(size_t target, size_t source, float koef_re, float koef_im, size_t start) {
+	float* target_re = re_[target];
+	float* target_im = im_[target];
+	const float* source_re = re_[source];
+	const float* source_im = im_[source];
+	for (size_t j = start; j < getCol(); ++j) {
+		float value_re = source_re[j];
+		float value_im = source_im[j];
+		target_re[j] -= koef_re * value_re - koef_im * value_im;
+		target_im[j] -= koef_re * value_im + koef_im * value_re;
+	}
+}
+
+void complexMatrix::scaleRow(size_t row, float koef_re, float koef_im) {
+	float* row_re = re_[row];
+	float* row_im = im_[row];
+	for (size_t j = 0; j < getCol(); ++j) {
+		float value_re = row_re[j];
+		float value_im = row_im[j];
+		row_re[j] = koef_re * value_re - koef_im * value_im;
+		row_im[j] = koef_re * value_im + koef_im * value_re;
+	}
+}
@@ -0,0 +1,530 @@
+#include "eigen.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+// iterations allowed per eigenvalue before the qr iteration gives up
+static const int MAX_QR_ITERATIONS = 60;
+
+// rows touched by a reflector before its update is split between threads
+static const size_t PARALLEL_ROWS = 128;
+
+// run body over [begin, end), in parallel when the range is large enough
+static void forRows(size_t begin, size_t end, const std::function<void(size_t)>& body) {
+	if (end - begin >= PARALLEL_ROWS) {
+		parallelFor(begin, end, body);
+		return;
+	}
+
+	for (size_t i = begin; i < end; ++i) {
+		body(i);
+	}
+}
+
+// conjugate which keeps real scalars real
+static double conjugate(double value) {
+	return value;
+}
+
+static std::complex<double> conjugate(const std::complex<double>& value) {
+	return std::conj(value);
+}
+
+// scale rows and columns by powers of 2 so that their norms are close,
+// this does not change the eigenvalues but improves their accuracy
+static void balance(Matrix<double>& a) {
+	const double radix = 2;
+	size_t n = a.getRow();
+	bool done = false;
+	while (!done) {
+		done = true;
+		for (size_t i = 0; i < n; ++i) {
+			double row = 0;
+			double column = 0;
+			for (size_t j = 0; j < n; ++j) {
+				if (j != i) {
+					column += std::abs(a[j][i]);
+					row += std::abs(a[i][j]);
+				}
+			}
+			if (column == 0 || row == 0) {
+				continue;
+			}
+
+			double g = row / radix;
+			double f = 1;
+			double s = column + row;
+			while (column < g) {
+				f *= radix;
+				column *= radix * radix;
+			}
+			g = row * radix;
+			while (column > g) {
+				f /= radix;
+				column /= radix * radix;
+			}
+			if ((column + row) / f < 0.95 * s) {
+				done = false;
+				for (size_t j = 0; j < n; ++j) {
+					a[i][j] /= f;
+					a[j][i] *= f;
+				}
+			}
+		}
+	}
+}
+
+// householder reduction to upper hessenberg form, a reflector I - tau v v^H is applied
+// from the left as a rank one update of the trailing rows and from the right row by row
+template <typename Scalar>
+static void reduceToHessenberg(std::vector<Scalar>& a, size_t n) {
+	std::vector<Scalar> v(n);
+	std::vector<Scalar> w(n);
+	for (size_t k = 0; k + 2 < n; ++k) {
+		double norm = 0;
+		for (size_t i = k + 1; i < n; ++i) {
+			norm += std::norm(a[i * n + k]);
+		}
+		norm = std::sqrt(norm);
+		if (norm == 0) {
+			continue;
+		}
+
+		// v = x - alpha e1 with alpha of the opposite phase to x1 to avoid cancellation
+		Scalar first = a[(k + 1) * n + k];
+		Scalar phase = std::abs(first) == 0 ? Scalar(1) : first / std::abs(first);
+		Scalar alpha = -phase * norm;
+		for (size_t i = k + 1; i < n; ++i) {
+			v[i] = a[i * n + k];
+		}
+		v[k + 1] -= alpha;
+		double length = 0;
+		for (size_t i = k + 1; i < n; ++i) {
+			length += std::norm(v[i]);
+		}
+		double tau = 2 / length;
+
+		// left: rows k + 1 .. n - 1, w^H = v^H A
+		std::fill(w.begin() + k, w.end(), Scalar(0));
+		for (size_t i = k + 1; i < n; ++i) {
+			Scalar koef = conjugate(v[i]);
+			const Scalar* row = &a[i * n];
+			for (size_t j = k; j < n; ++j) {
+				w[j] += koef * row[j];
+			}
+		}
+		forRows(k + 1, n, [&](size_t i) {
+			Scalar koef = tau * v[i];
+			Scalar* row = &a[i * n];
+			for (size_t j = k; j < n; ++j) {
+				row[j] -= koef * w[j];
+			}
+		});
+
+		// right: every row, columns k + 1 .. n - 1
+		forRows(0, n, [&](size_t i) {
+			Scalar* row = &a[i * n];
+			Scalar sum = 0;
+			for (size_t j = k + 1; j < n; ++j) {
+				sum += row[j] * v[j];
+			}
+			sum *= tau;
+			for (size_t j = k + 1; j < n; ++j) {
+				row[j] -= sum * conjugate(v[j]);
+			}
+		});
+
+		// the column below the subdiagonal is zero up to rounding
+		a[(k + 1) * n + k] = alpha;
+		for (size_t i = k + 2; i < n; ++i) {
+			a[i * n + k] = 0;
+		}
+	}
+}
+
+// francis double-shift qr on an upper hessenberg matrix, eigenvalues only; the eigenvalues
+// found are the progress
+static bool francisQR(std::vector<double>& h, int n, std::vector<std::complex<double>>& values, std::string& error) {
+	auto a = [&h, n](int i, int j) -> double& {
+		return h[i * n + j];
+	};
+
+	double norm = 0;
+	for (int i = 0; i < n; ++i) {
+		for (int j = std::max(i - 1, 0); j < n; ++j) {
+			norm += std::abs(a(i, j));
+		}
+	}
+
+	values.assign(n, 0);
+	int nn = n - 1;
+	double t = 0;
+	while (nn >= 0) {
+		int its = 0;
+		int l;
+		do {
+			if (isEvaluationCancelled()) {
+				error = "Evaluation cancelled";
+				return false;
+			}
+			reportProgress(n - 1 - nn, n);
+
+			// look for a negligible subdiagonal element to split the matrix
+			for (l = nn; l > 0; --l) {
+				double s = std::abs(a(l - 1, l - 1)) + std::abs(a(l, l));
+				if (s == 0) {
+					s = norm;
+				}
+				if (std::abs(a(l, l - 1)) <= DBL_EPSILON * s) {
+					a(l, l - 1) = 0;
+					break;
+				}
+			}
+
+			double x = a(nn, nn);
+			if (l == nn) {
+				// one root found
+				values[nn--] = x + t;
+				continue;
+			}
+
+			double y = a(nn - 1, nn - 1);
+			double w = a(nn, nn - 1) * a(nn - 1, nn);
+			if (l == nn - 1) {
+				// two roots found
+				double p = 0.5 * (y - x);
+				double q = p * p + w;
+				double z = std::sqrt(std::abs(q));
+				x += t;
+				if (q >= 0) {
+					z = p + (p >= 0 ? z : -z);
+					values[nn - 1] = values[nn] = x + z;
+					if (z != 0) {
+						values[nn] = x - w / z;
+					}
+				}
+				else {
+					values[nn - 1] = std::complex<double>(x + p, -z);
+					values[nn] = std::complex<double>(x + p, z);
+				}
+				nn -= 2;
+				continue;
+			}
+
+			if (its == MAX_QR_ITERATIONS) {
+				error = "Semantic error: eigenvalue iteration did not converge";
+				return false;
+			}
+
+			// exceptional shift
+			if (its == 10 || its == 20) {
+				t += x;
+				for (int i = 0; i <= nn; ++i) {
+					a(i, i) -= x;
+				}
+				double s = std::abs(a(nn, nn - 1)) + std::abs(a(nn - 1, nn - 2));
+				x = y = 0.75 * s;
+				w = -0.4375 * s * s;
+			}
+			++its;
+
+			// find two consecutive small subdiagonal elements
+			int m;
+			double p, q, r, z;
+			for (m = nn - 2; m >= l; --m) {
+				z = a(m, m);
+				r = x - z;
+				double s = y - z;
+				p = (r * s - w) / a(m + 1, m) + a(m, m + 1);
+				q = a(m + 1, m + 1) - z - r - s;
+				r = a(m + 2, m + 1);
+				s = std::abs(p) + std::abs(q) + std::abs(r);
+				p /= s;
+				q /= s;
+				r /= s;
+				if (m == l) {
+					break;
+				}
+				double u = std::abs(a(m, m - 1)) * (std::abs(q) + std::abs(r));
+				double v = std::abs(p) * (std::abs(a(m - 1, m - 1)) + std::abs(z) + std::abs(a(m + 1, m + 1)));
+				if (u <= DBL_EPSILON * v) {
+					break;
+				}
+			}
+			for (int i = m; i < nn - 1; ++i) {
+				a(i + 2, i) = 0;
+				if (i != m) {
+					a(i + 2, i - 1) = 0;
+				}
+			}
+
+			// double qr step on rows l .. nn and columns m .. nn
+			for (int k = m; k < nn; ++k) {
+				if (k != m) {
+					p = a(k, k - 1);
+					q = a(k + 1, k - 1);
+					r = k + 1 != nn ? a(k + 2, k - 1) : 0;
+					x = std::abs(p) + std::abs(q) + std::abs(r);
+					if (x != 0) {
+						p /= x;
+						q /= x;
+						r /= x;
+					}
+				}
+
+				double s = std::sqrt(p * p + q * q + r * r);
+				s = p >= 0 ? s : -s;
+				if (s == 0) {
+					continue;
+				}
+
+				if (k == m) {
+					if (l != m) {
+						a(k, k - 1) = -a(k, k - 1);
+					}
+				}
+				else {
+					a(k, k - 1) = -s * x;
+				}
+				p += s;
+				x = p / s;
+				y = q / s;
+				z = r / s;
+				q /= p;
+				r /= p;
+				for (int j = k; j <= nn; ++j) {
+					p = a(k, j) + q * a(k + 1, j);
+					if (k + 1 != nn) {
+						p += r * a(k + 2, j);
+						a(k + 2, j) -= p * z;
+					}
+					a(k + 1, j) -= p * y;
+					a(k, j) -= p * x;
+				}
+				int last = std::min(nn, k + 3);
+				for (int i = l; i <= last; ++i) {
+					p = x * a(i, k) + y * a(i, k + 1);
+					if (k + 1 != nn) {
+						p += z * a(i, k + 2);
+						a(i, k + 2) -= p * r;
+					}
+					a(i, k + 1) -= p * q;
+					a(i, k) -= p;
+				}
+			}
+		} while (nn >= 0 && l + 1 < nn);
+	}
+
+	return true;
+}
+
+// single-shift qr with givens rotations on a complex upper hessenberg matrix, eigenvalues only
+static bool shiftedQR(std::vector<std::complex<double>>& h, int n, std::vector<std::complex<double>>& values, std::string& error) {
+	using complex = std::complex<double>;
+	auto a = [&h, n](int i, int j) -> complex& {
+		return h[i * n + j];
+	};
+
+	values.assign(n, 0);
+	std::vector<double> cosines(n);
+	std::vector<complex> sines(n);
+	int m = n - 1;
+	int its = 0;
+	while (m >= 0) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(n - 1 - m, n);
+
+		// deflate from the bottom
+		int l = m;
+		while (l > 0) {
+			double s = std::abs(a(l - 1, l - 1)) + std::abs(a(l, l));
+			if (std::abs(a(l, l - 1)) <= DBL_EPSILON * s) {
+				a(l, l - 1) = 0;
+				break;
+			}
+			--l;
+		}
+		if (l == m) {
+			values[m] = a(m, m);
+			--m;
+			its = 0;
+			continue;
+		}
+
+		if (its == MAX_QR_ITERATIONS) {
+			error = "Semantic error: eigenvalue iteration did not converge";
+			return false;
+		}
+		++its;
+
+		// wilkinson shift: eigenvalue of the trailing 2x2 block closest to its last entry,
+		// replaced by an exceptional one now and then to break cycles
+		complex shift;
+		if (its % 10 == 0) {
+			shift = a(m, m) + std::abs(a(m, m - 1));
+		}
+		else {
+			complex p = 0.5 * (a(m - 1, m - 1) - a(m, m));
+			complex root = std::sqrt(p * p + a(m, m - 1) * a(m - 1, m));
+			complex first = a(m, m) + p + root;
+			complex second = a(m, m) + p - root;
+			shift = std::abs(first - a(m, m)) < std::abs(second - a(m, m)) ? first : second;
+		}
+
+		for (int k = l; k <= m; ++k) {
+			a(k, k) -= shift;
+		}
+
+		// h = r q: rotations from the left zero the subdiagonal ...
+		for (int k = l; k < m; ++k) {
+			complex x = a(k, k);
+			complex y = a(k + 1, k);
+			double r = std::hypot(std::abs(x), std::abs(y));
+			double c = 1;
+			complex s = 0;
+			if (r != 0) {
+				if (std::abs(x) == 0) {
+					c = 0;
+					s = std::conj(y) / r;
+				}
+				else {
+					c = std::abs(x) / r;
+					s = x / std::abs(x) * std::conj(y) / r;
+				}
+			}
+			cosines[k] = c;
+			sines[k] = s;
+			for (int j = k; j <= m; ++j) {
+				complex first = a(k, j);
+				complex second = a(k + 1, j);
+				a(k, j) = c * first + s * second;
+				a(k + 1, j) = -std::conj(s) * first + c * second;
+			}
+		}
+
+		// ... and their adjoints from the right restore the hessenberg form
+		for (int k = l; k < m; ++k) {
+			double c = cosines[k];
+			complex s = sines[k];
+			for (int i = l; i <= k + 1; ++i) {
+				complex first = a(i, k);
+				complex second = a(i, k + 1);
+				a(i, k) = first * c + second * std::conj(s);
+				a(i, k + 1) = -first * s + second * c;
+			}
+		}
+
+		for (int k = l; k <= m; ++k) {
+			a(k, k) += shift;
+		}
+	}
+
+	return true;
+}
+
+// polynomials p_k of the leading k x k blocks of a hessenberg matrix by expanding the last column:
+// p_k = (x - h_kk) p_(k-1) - sum over i < k of h_ik h_(i+1,i) ... h_(k,k-1) p_(i-1)
+template <typename Scalar>
+static void hessenbergPolynomial(const std::vector<Scalar>& h, size_t n, std::vector<Scalar>& coefficients) {
+	// lowest degree first while building
+	std::vector<std::vector<Scalar>> polynomials(n + 1);
+	polynomials[0] = {Scalar(1)};
+	for (size_t k = 1; k <= n; ++k) {
+		size_t m = k - 1;
+		std::vector<Scalar>& current = polynomials[k];
+		current.assign(k + 1, Scalar(0));
+		for (size_t d = 0; d < k; ++d) {
+			current[d + 1] += polynomials[m][d];
+			current[d] -= h[m * n + m] * polynomials[m][d];
+		}
+
+		Scalar subdiagonal = 1;
+		for (size_t i = m; i-- > 0;) {
+			subdiagonal *= h[(i + 1) * n + i];
+			if (subdiagonal == Scalar(0)) {
+				break;
+			}
+			Scalar koef = h[i * n + m] * subdiagonal;
+			for (size_t d = 0; d <= i; ++d) {
+				current[d] -= koef * polynomials[i][d];
+			}
+		}
+	}
+
+	coefficients.assign(polynomials[n].rbegin(), polynomials[n].rend());
+}
+
+// largest real parts first, conjugate pairs with the positive imaginary part first
+static void sortValues(std::vector<std::complex<double>>& values) {
+	std::sort(values.begin(), values.end(), [](const std::complex<double>& lhs, const std::complex<double>& rhs) {
+		if (lhs.real() != rhs.real()) {
+			return lhs.real() > rhs.real();
+		}
+		return lhs.imag() > rhs.imag();
+	});
+}
+
+bool realEigenvalues(const Matrix<double>& matrix, std::vector<std::complex<double>>& values, std::string& error) {
+	size_t n = matrix.getRow();
+	Matrix<double> balanced(matrix);
+	balance(balanced);
+
+	std::vector<double> h(balanced.data(), balanced.data() + n * n);
+	reduceToHessenberg(h, n);
+	if (!francisQR(h, static_cast<int>(n), values, error)) {
+		return false;
+	}
+	sortValues(values);
+
+	return true;
+}
+
+bool complexEigenvalues(const Matrix<double>& re, const Matrix<double>& im,
+						std::vector<std::complex<double>>& values, std::string& error) {
+	size_t n = re.getRow();
+	std::vector<std::complex<double>> h(n * n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			h[i * n + j] = std::complex<double>(re[i][j], im[i][j]);
+		}
+	}
+
+	reduceToHessenberg(h, n);
+	if (!shiftedQR(h, static_cast<int>(n), values, error)) {
+		return false;
+	}
+	sortValues(values);
+
+	return true;
+}
+
+void realCharacteristicPolynomial(const Matrix<double>& matrix, std::vector<double>& coefficients) {
+	size_t n = matrix.getRow();
+	Matrix<double> balanced(matrix);
+	balance(balanced);
+
+	std::vector<double> h(balanced.data(), balanced.data() + n * n);
+	reduceToHessenberg(h, n);
+	hessenbergPolynomial(h, n, coefficients);
+}
+
+void complexCharacteristicPolynomial(const Matrix<double>& re, const Matrix<double>& im,
+									 std::vector<std::complex<double>>& coefficients) {
+	size_t n = re.getRow();
+	std::vector<std::complex<double>> h(n * n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			h[i * n + j] = std::complex<double>(re[i][j], im[i][j]);
+		}
+	}
+
+	reduceToHessenberg(h, n);
+	hessenbergPolynomial(h, n, coefficients);
+}
@@ -0,0 +1,44 @@
+#include "evaluationjob.h"
+
+evaluationJob::evaluationJob(const std::shared_ptr<Model>& model, const Query& query): model_(model), query_(query) {
+	thread_ = std::thread(&evaluationJob::process, this);
+}
+
+evaluationJob::~evaluationJob() {
+	cancel();
+	thread_.join();
+}
+
+bool evaluationJob::isFinished() const {
+	return is_finished_.load(std::memory_order_acquire);
+}
+
+void evaluationJob::cancel() {
+	progress_.is_cancelled_ = true;
+}
+
+bool evaluationJob::isCancelled() const {
+	return progress_.is_cancelled_;
+}
+
+void evaluationJob::getProgress(size_t& done, size_t& total) const {
+	done = progress_.done_.load(std::memory_order_relaxed);
+	total = progress_.total_.load(std::memory_order_relaxed);
+}
+
+const Answer& evaluationJob::getAnswer() const {
+	return answer_;
+}
+
+// the evaluator fails the steps a cancellation stopped, the answers of the systems are replaced
+// here; a matrix being initialized is stored anyway, only the expressions recomputed from it fail
+void evaluationJob::process() {
+	setEvaluationProgress(&progress_);
+	answer_ = model_->processQuery(query_);
+	if (progress_.is_cancelled_ && query_.type_of_query_ != init) {
+		answer_.error_message_ = "Evaluation cancelled";
+	}
+	setEvaluationProgress(nullptr);
+
+	is_finished_.store(true, std::memory_order_release);
+}
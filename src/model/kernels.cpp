@@ -0,0 +1,557 @@
+#include "kernels.h"
+#include "complexmatrix.h"
+#include "eigen.h"
+#include "modular.h"
+#include "progress.h"
+#include "sketch.h"
+#include "sparsematrix.h"
+#include "svd.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// exact determinant of a matrix of integers by the multi-modular engine, false if an entry is not an integer
+static bool integerDeterminant(const Matrix<float>& matrix, double& value) {
+	std::vector<std::vector<long long>> integers(matrix.getRow(), std::vector<long long>(matrix.getCol()));
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			if (!fieldTraits<float>::toInteger(matrix[i][j], integers[i][j])) {
+				return false;
+			}
+		}
+	}
+
+	std::string error;
+	bigInteger exact;
+	if (!modularDeterminant(integers, exact, error)) {
+		return false;
+	}
+	value = exact.toDouble();
+
+	return true;
+}
+
+// integer matrices get an exact determinant from the multi-modular engine
+float determinant(const Matrix<float>& matrix) {
+	double exact;
+	if (integerDeterminant(matrix, exact)) {
+		return exact;
+	}
+
+	return matrix.det();
+}
+
+// real kernels below work in double
+template <typename Real>
+static Matrix<double> toDouble(const Matrix<Real>& matrix) {
+	Matrix<double> result(matrix.getRow(), matrix.getCol());
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			result[i][j] = matrix[i][j];
+		}
+	}
+
+	return result;
+}
+
+// a number as mantissa * 2^exponent, the mantissa is kept near 1, so that a long
+// product neither overflows nor underflows before it is converted back
+template <typename Scalar>
+struct scaledNumber {
+	Scalar mantissa_ = 1;
+	long long exponent_ = 0;
+
+	void multiply(const Scalar& factor) {
+		mantissa_ *= factor;
+		double magnitude = std::max(std::abs(std::real(mantissa_)), std::abs(std::imag(mantissa_)));
+		if (magnitude == 0 || !std::isfinite(magnitude)) {
+			return;
+		}
+
+		int shift;
+		std::frexp(magnitude, &shift);
+		mantissa_ *= std::ldexp(1.0, -shift);
+		exponent_ += shift;
+	}
+
+	// exponents beyond the range of double give 0 or infinity either way
+	Scalar value() const {
+		int shift = static_cast<int>(std::max(-4096LL, std::min(exponent_, 4096LL)));
+		if constexpr (std::is_same_v<Scalar, double>) {
+			return std::ldexp(mantissa_, shift);
+		}
+		else {
+			return Scalar(std::ldexp(mantissa_.real(), shift), std::ldexp(mantissa_.imag(), shift));
+		}
+	}
+};
+
+// pivots of gaussian elimination with partial pivoting are multiplied into the determinant
+template <typename Scalar>
+static void multiplyDeterminant(Matrix<Scalar> matrix, scaledNumber<Scalar>& determinant) {
+	size_t n = matrix.getRow();
+	for (size_t k = 0; k < n; ++k) {
+		if (isEvaluationCancelled()) {
+			return;
+		}
+		reportProgress(k, n);
+
+		size_t pivot = k;
+		for (size_t i = k + 1; i < n; ++i) {
+			if (std::abs(matrix[i][k]) > std::abs(matrix[pivot][k])) {
+				pivot = i;
+			}
+		}
+		if (matrix[pivot][k] == Scalar(0)) {
+			determinant.mantissa_ = 0;
+			return;
+		}
+		if (pivot != k) {
+			std::swap_ranges(matrix[pivot] + k, matrix[pivot] + n, matrix[k] + k);
+			determinant.mantissa_ = -determinant.mantissa_;
+		}
+
+		determinant.multiply(matrix[k][k]);
+		for (size_t i = k + 1; i < n; ++i) {
+			Scalar factor = matrix[i][k] / matrix[k][k];
+			for (size_t j = k + 1; j < n; ++j) {
+				matrix[i][j] -= factor * matrix[k][j];
+			}
+		}
+	}
+}
+
+template <typename Real>
+static void multiplyRealDeterminant(const Matrix<Real>& matrix, scaledNumber<double>& determinant) {
+	double exact;
+	if constexpr (std::is_same_v<Real, float>) {
+		if (integerDeterminant(matrix, exact) && std::isfinite(exact)) {
+			determinant.multiply(exact);
+			return;
+		}
+	}
+
+	multiplyDeterminant(toDouble(matrix), determinant);
+}
+
+template <typename Real>
+static Real realScaledDeterminant(Real scale, const Matrix<Real>& lhs, const Matrix<Real>* rhs) {
+	scaledNumber<double> result;
+	multiplyRealDeterminant(lhs, result);
+	if (rhs) {
+		multiplyRealDeterminant(*rhs, result);
+	}
+	for (size_t i = 0; i < lhs.getRow(); ++i) {
+		result.multiply(scale);
+	}
+
+	return result.value();
+}
+
+float scaledDeterminant(const float& scale, const Matrix<float>& lhs, const Matrix<float>* rhs) {
+	return realScaledDeterminant(scale, lhs, rhs);
+}
+
+double scaledDeterminant(const double& scale, const Matrix<double>& lhs, const Matrix<double>* rhs) {
+	return realScaledDeterminant(scale, lhs, rhs);
+}
+
+template <typename Real>
+static Matrix<Real> realCharacteristicColumn(const Matrix<Real>& matrix) {
+	std::vector<double> coefficients;
+	realCharacteristicPolynomial(toDouble(matrix), coefficients);
+
+	Matrix<Real> result(coefficients.size(), 1);
+	for (size_t i = 0; i < coefficients.size(); ++i) {
+		result[i][0] = coefficients[i];
+	}
+
+	return result;
+}
+
+Matrix<float> characteristicPolynomial(const Matrix<float>& matrix) {
+	return realCharacteristicColumn(matrix);
+}
+
+Matrix<double> characteristicPolynomial(const Matrix<double>& matrix) {
+	return realCharacteristicColumn(matrix);
+}
+
+// eigenvalues of a real matrix are computed in double
+template <typename Real>
+static bool realEigenvalueColumns(const Matrix<Real>& matrix, Matrix<Real>& values, std::string& error) {
+	size_t n = matrix.getRow();
+	std::vector<std::complex<double>> result;
+	if (!realEigenvalues(toDouble(matrix), result, error)) {
+		return false;
+	}
+
+	bool is_real = std::all_of(result.begin(), result.end(), [](const std::complex<double>& value) {
+		return value.imag() == 0;
+	});
+	values = Matrix<Real>(n, is_real ? 1 : 2);
+	for (size_t i = 0; i < n; ++i) {
+		values[i][0] = result[i].real();
+		if (!is_real) {
+			values[i][1] = result[i].imag();
+		}
+	}
+
+	return true;
+}
+
+bool eigenvalues(const Matrix<float>& matrix, Matrix<float>& values, std::string& error) {
+	return realEigenvalueColumns(matrix, values, error);
+}
+
+bool eigenvalues(const Matrix<double>& matrix, Matrix<double>& values, std::string& error) {
+	return realEigenvalueColumns(matrix, values, error);
+}
+
+template <typename Real>
+static bool realSingularValues(const Matrix<Real>& matrix, Matrix<Real>& values, std::string& error) {
+	Matrix<double> u;
+	Matrix<double> v;
+	std::vector<double> sigma;
+	if (!jacobiSvd(toDouble(matrix), u, sigma, v, error)) {
+		return false;
+	}
+
+	values = Matrix<Real>(sigma.size(), 1);
+	for (size_t i = 0; i < sigma.size(); ++i) {
+		values[i][0] = sigma[i];
+	}
+
+	return true;
+}
+
+// epsilon of the field decides the rank cutoff of the pseudo-inverse
+template <typename Real>
+static bool realPseudoInverse(const Matrix<Real>& matrix, double epsilon, Matrix<Real>& result, std::string& error) {
+	Matrix<double> inverse;
+	if (!pseudoInverse(toDouble(matrix), epsilon, inverse, error)) {
+		return false;
+	}
+
+	result = Matrix<Real>(inverse.getRow(), inverse.getCol());
+	for (size_t i = 0; i < inverse.getRow(); ++i) {
+		for (size_t j = 0; j < inverse.getCol(); ++j) {
+			result[i][j] = inverse[i][j];
+		}
+	}
+
+	return true;
+}
+
+bool singularValues(const Matrix<float>& matrix, Matrix<float>& values, std::string& error) {
+	return realSingularValues(matrix, values, error);
+}
+
+bool singularValues(const Matrix<double>& matrix, Matrix<double>& values, std::string& error) {
+	return realSingularValues(matrix, values, error);
+}
+
+bool pseudoInverse(const Matrix<float>& matrix, Matrix<float>& result, std::string& error) {
+	return realPseudoInverse(matrix, FLT_EPSILON, result, error);
+}
+
+bool pseudoInverse(const Matrix<double>& matrix, Matrix<double>& result, std::string& error) {
+	return realPseudoInverse(matrix, DBL_EPSILON, result, error);
+}
+
+bool approximateRank(const Matrix<float>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error) {
+	return sketchRank(toDouble(matrix), tolerance, oversampling, rank, error);
+}
+
+bool approximateRank(const Matrix<double>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error) {
+	return sketchRank(matrix, tolerance, oversampling, rank, error);
+}
+
+template <typename Real>
+static bool realLeadingSingularValues(const Matrix<Real>& matrix, size_t count, size_t oversampling, Matrix<Real>& values, std::string& error) {
+	std::vector<double> sigma;
+	if (!sketchSingularValues(toDouble(matrix), count, oversampling, sigma, error)) {
+		return false;
+	}
+
+	values = Matrix<Real>(sigma.size(), 1);
+	for (size_t i = 0; i < sigma.size(); ++i) {
+		values[i][0] = sigma[i];
+	}
+
+	return true;
+}
+
+bool leadingSingularValues(const Matrix<float>& matrix, size_t count, size_t oversampling, Matrix<float>& values, std::string& error) {
+	return realLeadingSingularValues(matrix, count, oversampling, values, error);
+}
+
+bool leadingSingularValues(const Matrix<double>& matrix, size_t count, size_t oversampling, Matrix<double>& values, std::string& error) {
+	return realLeadingSingularValues(matrix, count, oversampling, values, error);
+}
+
+bool normEstimate(const Matrix<float>& matrix, double tolerance, float& norm, std::string& error) {
+	double value;
+	if (!powerNorm(toDouble(matrix), tolerance, value, error)) {
+		return false;
+	}
+	norm = value;
+
+	return true;
+}
+
+bool normEstimate(const Matrix<double>& matrix, double tolerance, double& norm, std::string& error) {
+	return powerNorm(matrix, tolerance, norm, error);
+}
+
+// evaluate one of the matrix functions in double precision scalars
+template <typename Scalar>
+static bool applyFunction(const Matrix<Scalar>& matrix, matrixFunctionType function, Matrix<Scalar>& result, std::string& error) {
+	if (function == exponentialFunction) {
+		return exponential(matrix, result, error);
+	}
+	if (function == logarithmFunction) {
+		return logarithm(matrix, result, error);
+	}
+
+	return squareRoot(matrix, result, error);
+}
+
+template <typename Real>
+static bool realMatrixFunction(const Matrix<Real>& matrix, matrixFunctionType function, Matrix<Real>& result, std::string& error) {
+	Matrix<double> value;
+	if (!applyFunction(toDouble(matrix), function, value, error)) {
+		return false;
+	}
+
+	result = Matrix<Real>(value.getRow(), value.getCol());
+	for (size_t i = 0; i < value.getRow(); ++i) {
+		for (size_t j = 0; j < value.getCol(); ++j) {
+			result[i][j] = value[i][j];
+		}
+	}
+
+	return true;
+}
+
+bool matrixFunction(const Matrix<float>& matrix, matrixFunctionType function, Matrix<float>& result, std::string& error) {
+	return realMatrixFunction(matrix, function, result, error);
+}
+
+bool matrixFunction(const Matrix<double>& matrix, matrixFunctionType function, Matrix<double>& result, std::string& error) {
+	return realMatrixFunction(matrix, function, result, error);
+}
+
+template <typename Real>
+static bool realSolveSystem(const Matrix<Real>& matrix, const Matrix<Real>& rhs, const krylovOptions& options, Matrix<Real>& solution,
+							size_t& iterations, double& residual, std::string& error) {
+	if (options.method_ == directMethod) {
+		return solveSystem<Real>(matrix, rhs, options, solution, iterations, residual, error);
+	}
+
+	Matrix<double> system = toDouble(matrix);
+	sparseMatrix compressed(system);
+	bool is_sparse = compressed.density() <= KRYLOV_SPARSE_DENSITY;
+	iterations = 0;
+	residual = 0;
+
+	size_t n = matrix.getRow();
+	solution = Matrix<Real>(n, rhs.getCol());
+	for (size_t j = 0; j < rhs.getCol(); ++j) {
+		std::vector<double> column(n);
+		for (size_t i = 0; i < n; ++i) {
+			column[i] = rhs[i][j];
+		}
+
+		std::vector<double> x;
+		size_t column_iterations;
+		double column_residual;
+		bool is_solved = is_sparse ? krylovSolve(compressed, column, options, x, column_iterations, column_residual, error)
+								   : krylovSolve(system, column, options, x, column_iterations, column_residual, error);
+		if (!is_solved) {
+			return false;
+		}
+		iterations += column_iterations;
+		residual = std::max(residual, column_residual);
+
+		for (size_t i = 0; i < n; ++i) {
+			solution[i][j] = x[i];
+		}
+	}
+
+	return true;
+}
+
+bool solveSystem(const Matrix<float>& matrix, const Matrix<float>& rhs, const krylovOptions& options, Matrix<float>& solution,
+				 size_t& iterations, double& residual, std::string& error) {
+	return realSolveSystem(matrix, rhs, options, solution, iterations, residual, error);
+}
+
+bool solveSystem(const Matrix<double>& matrix, const Matrix<double>& rhs, const krylovOptions& options, Matrix<double>& solution,
+				 size_t& iterations, double& residual, std::string& error) {
+	return realSolveSystem(matrix, rhs, options, solution, iterations, residual, error);
+}
+
+// conversions to and from the split-plane representation
+
+static complexMatrix toPlanes(const Matrix<complexNumber>& matrix) {
+	Matrix<float> re(matrix.getRow(), matrix.getCol());
+	Matrix<float> im(matrix.getRow(), matrix.getCol());
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			re[i][j] = matrix[i][j].re();
+			im[i][j] = matrix[i][j].im();
+		}
+	}
+
+	return complexMatrix(re, im);
+}
+
+static Matrix<complexNumber> fromPlanes(const complexMatrix& matrix) {
+	Matrix<complexNumber> result(matrix.getRow(), matrix.getCol());
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			result[i][j] = matrix.get(i, j);
+		}
+	}
+
+	return result;
+}
+
+Matrix<complexNumber> multiply(const Matrix<complexNumber>& lhs, const Matrix<complexNumber>& rhs) {
+	return fromPlanes(toPlanes(lhs) * toPlanes(rhs));
+}
+
+complexNumber determinant(const Matrix<complexNumber>& matrix) {
+	return toPlanes(matrix).det();
+}
+
+Matrix<complexNumber> inverse(const Matrix<complexNumber>& matrix) {
+	return fromPlanes(toPlanes(matrix).inverted());
+}
+
+size_t rank(const Matrix<complexNumber>& matrix) {
+	return toPlanes(matrix).rank();
+}
+
+Matrix<complexNumber> characteristicPolynomial(const Matrix<complexNumber>& matrix) {
+	size_t n = matrix.getRow();
+	Matrix<double> re(n, n);
+	Matrix<double> im(n, n);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			re[i][j] = matrix[i][j].re();
+			im[i][j] = matrix[i][j].im();
+		}
+	}
+
+	std::vector<std::complex<double>> coefficients;
+	complexCharacteristicPolynomial(re, im, coefficients);
+
+	Matrix<complexNumber> result(n + 1, 1);
+	for (size_t i = 0; i <= n; ++i) {
+		result[i][0] = complexNumber(coefficients[i].real(), coefficients[i].imag());
+	}
+
+	return result;
+}
+
+bool eigenvalues(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& values, std::string& error) {
+	size_t n = matrix.getRow();
+	Matrix<double> re(n, n);
+	Matrix<double> im(n, n);
+	bool is_real = true;
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			re[i][j] = matrix[i][j].re();
+			im[i][j] = matrix[i][j].im();
+			is_real = is_real && im[i][j] == 0;
+		}
+	}
+
+	// real matrices take the cheaper real arithmetic path
+	std::vector<std::complex<double>> result;
+	if (is_real ? !realEigenvalues(re, result, error) : !complexEigenvalues(re, im, result, error)) {
+		return false;
+	}
+
+	values = Matrix<complexNumber>(n, 1);
+	for (size_t i = 0; i < n; ++i) {
+		values[i][0] = complexNumber(result[i].real(), result[i].imag());
+	}
+
+	return true;
+}
+
+static Matrix<std::complex<double>> toComplexDouble(const Matrix<complexNumber>& matrix) {
+	Matrix<std::complex<double>> result(matrix.getRow(), matrix.getCol());
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			result[i][j] = std::complex<double>(matrix[i][j].re(), matrix[i][j].im());
+		}
+	}
+
+	return result;
+}
+
+complexNumber scaledDeterminant(const complexNumber& scale, const Matrix<complexNumber>& lhs, const Matrix<complexNumber>* rhs) {
+	scaledNumber<std::complex<double>> result;
+	multiplyDeterminant(toComplexDouble(lhs), result);
+	if (rhs) {
+		multiplyDeterminant(toComplexDouble(*rhs), result);
+	}
+	for (size_t i = 0; i < lhs.getRow(); ++i) {
+		result.multiply(std::complex<double>(scale.re(), scale.im()));
+	}
+
+	std::complex<double> value = result.value();
+	return complexNumber(value.real(), value.imag());
+}
+
+bool singularValues(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& values, std::string& error) {
+	Matrix<std::complex<double>> u;
+	Matrix<std::complex<double>> v;
+	std::vector<double> sigma;
+	if (!jacobiSvd(toComplexDouble(matrix), u, sigma, v, error)) {
+		return false;
+	}
+
+	values = Matrix<complexNumber>(sigma.size(), 1);
+	for (size_t i = 0; i < sigma.size(); ++i) {
+		values[i][0] = complexNumber(sigma[i], 0);
+	}
+
+	return true;
+}
+
+bool pseudoInverse(const Matrix<complexNumber>& matrix, Matrix<complexNumber>& result, std::string& error) {
+	Matrix<std::complex<double>> inverse;
+	if (!pseudoInverse(toComplexDouble(matrix), FLT_EPSILON, inverse, error)) {
+		return false;
+	}
+
+	result = Matrix<complexNumber>(inverse.getRow(), inverse.getCol());
+	for (size_t i = 0; i < inverse.getRow(); ++i) {
+		for (size_t j = 0; j < inverse.getCol(); ++j) {
+			result[i][j] = complexNumber(inverse[i][j].real(), inverse[i][j].imag());
+		}
+	}
+
+	return true;
+}
+
+bool matrixFunction(const Matrix<complexNumber>& matrix, matrixFunctionType function, Matrix<complexNumber>& result, std::string& error) {
+	Matrix<std::complex<double>> value;
+	if (!applyFunction(toComplexDouble(matrix), function, value, error)) {
+		return false;
+	}
+
+	result = Matrix<complexNumber>(value.getRow(), value.getCol());
+	for (size_t i = 0; i < value.getRow(); ++i) {
+		for (size_t j = 0; j < value.getCol(); ++j) {
+			result[i][j] = complexNumber(value[i][j].real(), value[i][j].imag());
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,473 @@
+#include "krylov.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// rows of a dense product before they are split between threads
+static const size_t PARALLEL_ROWS = 256;
+
+bool parseSolveMethod(const std::string& name, solveMethod& method) {
+	if (name == "direct") {
+		method = directMethod;
+	}
+	else if (name == "cg") {
+		method = cgMethod;
+	}
+	else if (name == "bicgstab") {
+		method = bicgstabMethod;
+	}
+	else if (name == "gmres") {
+		method = gmresMethod;
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+bool parsePreconditioner(const std::string& name, preconditionerType& preconditioner) {
+	if (name == "none") {
+		preconditioner = noPreconditioner;
+	}
+	else if (name == "jacobi") {
+		preconditioner = jacobiPreconditioner;
+	}
+	else if (name == "ilu") {
+		preconditioner = iluPreconditioner;
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+// vector helpers
+
+static double dot(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+	double sum = 0;
+	for (size_t i = 0; i < lhs.size(); ++i) {
+		sum += lhs[i] * rhs[i];
+	}
+
+	return sum;
+}
+
+static double norm(const std::vector<double>& vector) {
+	return std::sqrt(dot(vector, vector));
+}
+
+// y += koef * x
+static void addScaled(std::vector<double>& y, double koef, const std::vector<double>& x) {
+	for (size_t i = 0; i < y.size(); ++i) {
+		y[i] += koef * x[i];
+	}
+}
+
+// y = A x for both representations
+
+static void multiply(const sparseMatrix& matrix, const std::vector<double>& x, std::vector<double>& y) {
+	matrix.multiply(x, y);
+}
+
+static void multiply(const Matrix<double>& matrix, const std::vector<double>& x, std::vector<double>& y) {
+	size_t n = matrix.getRow();
+	y.resize(n);
+	auto body = [&](size_t i) {
+		const double* row = matrix[i];
+		double sum = 0;
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			sum += row[j] * x[j];
+		}
+		y[i] = sum;
+	};
+
+	if (n >= PARALLEL_ROWS) {
+		parallelFor(0, n, body);
+		return;
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		body(i);
+	}
+}
+
+// z = M^-1 r for jacobi (inverse diagonal) or ilu(0) (incomplete lu on the sparsity pattern)
+class preconditioner {
+public:
+	preconditioner(const sparseMatrix& matrix, preconditionerType type): type_(type),
+																		   factors_(matrix) {}
+
+	// false if a diagonal entry or a pivot vanishes
+	bool setUp(std::string& error) {
+		if (type_ == noPreconditioner) {
+			return true;
+		}
+
+		size_t n = factors_.getRow();
+		const std::vector<size_t>& start = factors_.rowStart();
+		const std::vector<size_t>& columns = factors_.columns();
+		values_ = factors_.values();
+		diagonal_.assign(n, 0);
+		for (size_t i = 0; i < n; ++i) {
+			size_t k = start[i];
+			while (k < start[i + 1] && columns[k] < i) {
+				++k;
+			}
+			if (k == start[i + 1] || columns[k] != i || values_[k] == 0) {
+				error = "Semantic error: preconditioner needs a nonzero diagonal";
+				return false;
+			}
+			diagonal_[i] = k;
+		}
+
+		if (type_ == jacobiPreconditioner) {
+			return true;
+		}
+
+		// ilu(0): gaussian elimination restricted to the nonzeros of A
+		std::vector<size_t> position(n, SIZE_MAX);
+		for (size_t i = 1; i < n; ++i) {
+			for (size_t k = start[i]; k < start[i + 1]; ++k) {
+				position[columns[k]] = k;
+			}
+
+			for (size_t k = start[i]; k < diagonal_[i]; ++k) {
+				size_t pivot = columns[k];
+				values_[k] /= values_[diagonal_[pivot]];
+				for (size_t t = diagonal_[pivot] + 1; t < start[pivot + 1]; ++t) {
+					if (position[columns[t]] != SIZE_MAX) {
+						values_[position[columns[t]]] -= values_[k] * values_[t];
+					}
+				}
+			}
+
+			for (size_t k = start[i]; k < start[i + 1]; ++k) {
+				position[columns[k]] = SIZE_MAX;
+			}
+			if (values_[diagonal_[i]] == 0) {
+				error = "Semantic error: zero pivot in the incomplete lu factorization";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void apply(const std::vector<double>& r, std::vector<double>& z) const {
+		size_t n = r.size();
+		z.resize(n);
+		if (type_ == noPreconditioner) {
+			z = r;
+			return;
+		}
+
+		if (type_ == jacobiPreconditioner) {
+			for (size_t i = 0; i < n; ++i) {
+				z[i] = r[i] / values_[diagonal_[i]];
+			}
+			return;
+		}
+
+		// L y = r with unit diagonal, then U z = y
+		const std::vector<size_t>& start = factors_.rowStart();
+		const std::vector<size_t>& columns = factors_.columns();
+		for (size_t i = 0; i < n; ++i) {
+			double value = r[i];
+			for (size_t k = start[i]; k < diagonal_[i]; ++k) {
+				value -= values_[k] * z[columns[k]];
+			}
+			z[i] = value;
+		}
+		for (size_t i = n; i-- > 0;) {
+			double value = z[i];
+			for (size_t k = diagonal_[i] + 1; k < start[i + 1]; ++k) {
+				value -= values_[k] * z[columns[k]];
+			}
+			z[i] = value / values_[diagonal_[i]];
+		}
+	}
+
+private:
+	preconditionerType type_; // kind of the preconditioner
+	sparseMatrix factors_; // pattern of A
+	std::vector<double> values_; // diagonal of A or its incomplete lu factors
+	std::vector<size_t> diagonal_; // position of the diagonal entry of every row
+};
+
+// the krylov methods below report their iterations of the most allowed as the progress
+
+// preconditioned conjugate gradients
+template <typename Operator>
+static bool conjugateGradients(const Operator& matrix, const std::vector<double>& rhs, const preconditioner& m,
+							   const krylovOptions& options, std::vector<double>& x, size_t& iterations, std::string& error) {
+	size_t n = rhs.size();
+	double target = options.tolerance_ * norm(rhs);
+	std::vector<double> r = rhs;
+	std::vector<double> z;
+	std::vector<double> product;
+	m.apply(r, z);
+	std::vector<double> p = z;
+	double rz = dot(r, z);
+
+	for (iterations = 0; iterations < options.max_iterations_; ) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(iterations, options.max_iterations_);
+
+		if (norm(r) <= target) {
+			return true;
+		}
+
+		multiply(matrix, p, product);
+		++iterations;
+		double curvature = dot(p, product);
+		if (curvature <= 0) {
+			error = "Semantic error: conjugate gradients need a positive definite matrix";
+			return false;
+		}
+
+		double alpha = rz / curvature;
+		addScaled(x, alpha, p);
+		addScaled(r, -alpha, product);
+
+		m.apply(r, z);
+		double next = dot(r, z);
+		double beta = next / rz;
+		rz = next;
+		for (size_t i = 0; i < n; ++i) {
+			p[i] = z[i] + beta * p[i];
+		}
+	}
+
+	return norm(r) <= target;
+}
+
+// right preconditioned bicgstab
+template <typename Operator>
+static bool biconjugateGradientsStabilized(const Operator& matrix, const std::vector<double>& rhs, const preconditioner& m,
+										   const krylovOptions& options, std::vector<double>& x, size_t& iterations, std::string& error) {
+	size_t n = rhs.size();
+	double target = options.tolerance_ * norm(rhs);
+	std::vector<double> r = rhs;
+	std::vector<double> shadow = rhs;
+	std::vector<double> p(n, 0);
+	std::vector<double> v(n, 0);
+	std::vector<double> s(n);
+	std::vector<double> t(n);
+	std::vector<double> p_hat;
+	std::vector<double> s_hat;
+	double rho = 1;
+	double alpha = 1;
+	double omega = 1;
+
+	for (iterations = 0; iterations < options.max_iterations_; ) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(iterations, options.max_iterations_);
+
+		if (norm(r) <= target) {
+			return true;
+		}
+
+		double next = dot(shadow, r);
+		if (next == 0 || omega == 0) {
+			error = "Semantic error: bicgstab broke down";
+			return false;
+		}
+		double beta = next / rho * alpha / omega;
+		rho = next;
+		for (size_t i = 0; i < n; ++i) {
+			p[i] = r[i] + beta * (p[i] - omega * v[i]);
+		}
+
+		m.apply(p, p_hat);
+		multiply(matrix, p_hat, v);
+		++iterations;
+		alpha = rho / dot(shadow, v);
+		for (size_t i = 0; i < n; ++i) {
+			s[i] = r[i] - alpha * v[i];
+		}
+		if (norm(s) <= target) {
+			addScaled(x, alpha, p_hat);
+			r = s;
+			return true;
+		}
+
+		m.apply(s, s_hat);
+		multiply(matrix, s_hat, t);
+		++iterations;
+		double tt = dot(t, t);
+		omega = tt == 0 ? 0 : dot(t, s) / tt;
+		for (size_t i = 0; i < n; ++i) {
+			x[i] += alpha * p_hat[i] + omega * s_hat[i];
+			r[i] = s[i] - omega * t[i];
+		}
+	}
+
+	return norm(r) <= target;
+}
+
+// right preconditioned gmres restarted every options.restart_ steps, the least squares
+// problem of the arnoldi relation is kept triangular by givens rotations
+template <typename Operator>
+static bool generalizedMinimalResidual(const Operator& matrix, const std::vector<double>& rhs, const preconditioner& m,
+									   const krylovOptions& options, std::vector<double>& x, size_t& iterations, std::string& error) {
+	size_t n = rhs.size();
+	size_t restart = std::max<size_t>(1, std::min(options.restart_, n));
+	double target = options.tolerance_ * norm(rhs);
+	std::vector<std::vector<double>> basis(restart + 1, std::vector<double>(n));
+	std::vector<std::vector<double>> hessenberg(restart + 1, std::vector<double>(restart, 0));
+	std::vector<double> cosines(restart);
+	std::vector<double> sines(restart);
+	std::vector<double> g(restart + 1);
+	std::vector<double> r;
+	std::vector<double> z;
+	std::vector<double> w;
+
+	iterations = 0;
+	for (;;) {
+		multiply(matrix, x, r);
+		for (size_t i = 0; i < n; ++i) {
+			r[i] = rhs[i] - r[i];
+		}
+		double beta = norm(r);
+		if (beta <= target) {
+			return true;
+		}
+		if (iterations >= options.max_iterations_) {
+			return false;
+		}
+
+		for (size_t i = 0; i < n; ++i) {
+			basis[0][i] = r[i] / beta;
+		}
+		std::fill(g.begin(), g.end(), 0);
+		g[0] = beta;
+
+		size_t steps = 0;
+		while (steps < restart && iterations < options.max_iterations_) {
+			if (isEvaluationCancelled()) {
+				error = "Evaluation cancelled";
+				return false;
+			}
+			reportProgress(iterations, options.max_iterations_);
+
+			size_t j = steps;
+			m.apply(basis[j], z);
+			multiply(matrix, z, w);
+			++iterations;
+
+			// modified gram-schmidt
+			for (size_t i = 0; i <= j; ++i) {
+				hessenberg[i][j] = dot(w, basis[i]);
+				addScaled(w, -hessenberg[i][j], basis[i]);
+			}
+			hessenberg[j + 1][j] = norm(w);
+			if (hessenberg[j + 1][j] != 0) {
+				for (size_t i = 0; i < n; ++i) {
+					basis[j + 1][i] = w[i] / hessenberg[j + 1][j];
+				}
+			}
+
+			for (size_t i = 0; i < j; ++i) {
+				double first = hessenberg[i][j];
+				double second = hessenberg[i + 1][j];
+				hessenberg[i][j] = cosines[i] * first + sines[i] * second;
+				hessenberg[i + 1][j] = -sines[i] * first + cosines[i] * second;
+			}
+			double length = std::hypot(hessenberg[j][j], hessenberg[j + 1][j]);
+			if (length == 0) {
+				error = "Semantic error: gmres broke down";
+				return false;
+			}
+			cosines[j] = hessenberg[j][j] / length;
+			sines[j] = hessenberg[j + 1][j] / length;
+			hessenberg[j][j] = length;
+			hessenberg[j + 1][j] = 0;
+			g[j + 1] = -sines[j] * g[j];
+			g[j] *= cosines[j];
+
+			++steps;
+			if (std::abs(g[j + 1]) <= target) {
+				break;
+			}
+		}
+
+		// x += M^-1 V y with H y = g
+		std::vector<double> y(steps);
+		for (size_t i = steps; i-- > 0;) {
+			double value = g[i];
+			for (size_t k = i + 1; k < steps; ++k) {
+				value -= hessenberg[i][k] * y[k];
+			}
+			y[i] = value / hessenberg[i][i];
+		}
+		std::vector<double> update(n, 0);
+		for (size_t i = 0; i < steps; ++i) {
+			addScaled(update, y[i], basis[i]);
+		}
+		m.apply(update, z);
+		addScaled(x, 1, z);
+	}
+}
+
+template <typename Operator>
+static bool solveWith(const Operator& matrix, const sparseMatrix& pattern, const std::vector<double>& rhs,
+					  const krylovOptions& options, std::vector<double>& solution, size_t& iterations,
+					  double& residual, std::string& error) {
+	preconditioner m(pattern, options.preconditioner_);
+	if (!m.setUp(error)) {
+		return false;
+	}
+
+	solution.assign(rhs.size(), 0);
+	iterations = 0;
+	bool converged = false;
+	if (options.method_ == cgMethod) {
+		converged = conjugateGradients(matrix, rhs, m, options, solution, iterations, error);
+	}
+	else if (options.method_ == bicgstabMethod) {
+		converged = biconjugateGradientsStabilized(matrix, rhs, m, options, solution, iterations, error);
+	}
+	else if (options.method_ == gmresMethod) {
+		converged = generalizedMinimalResidual(matrix, rhs, m, options, solution, iterations, error);
+	}
+	else {
+		error = "Semantic error: not an iterative method";
+		return false;
+	}
+
+	// the true residual, the recurrences only track an estimate of it
+	std::vector<double> product;
+	multiply(matrix, solution, product);
+	for (size_t i = 0; i < product.size(); ++i) {
+		product[i] = rhs[i] - product[i];
+	}
+	residual = norm(product);
+
+	if (!converged && error == "") {
+		error = "Semantic error: iterative solver did not converge in " + std::to_string(iterations) + " iterations";
+	}
+
+	return converged;
+}
+
+bool krylovSolve(const sparseMatrix& matrix, const std::vector<double>& rhs, const krylovOptions& options,
+				 std::vector<double>& solution, size_t& iterations, double& residual, std::string& error) {
+	return solveWith(matrix, matrix, rhs, options, solution, iterations, residual, error);
+}
+
+bool krylovSolve(const Matrix<double>& matrix, const std::vector<double>& rhs, const krylovOptions& options,
+				 std::vector<double>& solution, size_t& iterations, double& residual, std::string& error) {
+	// the preconditioner still works on the nonzeros, for a full matrix ilu(0) is a complete lu
+	return solveWith(matrix, sparseMatrix(matrix), rhs, options, solution, iterations, residual, error);
+}
@@ -0,0 +1,126 @@
+#include "leastsquares.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+// rows below which a system is factored as a single block
+static const size_t MIN_BLOCK_ROWS = 256;
+
+// householder qr of a row-major block of rows x cols in place, only R is kept:
+// on return the first min(rows, cols) rows hold the upper triangular factor;
+// a cancelled evaluation leaves the block half reduced, the caller reports it
+static void triangularize(double* block, size_t rows, size_t cols) {
+	std::vector<double> w(cols);
+	for (size_t k = 0; k < cols && k < rows; ++k) {
+		if (isEvaluationCancelled()) {
+			return;
+		}
+
+		double norm = 0;
+		for (size_t i = k; i < rows; ++i) {
+			norm += block[i * cols + k] * block[i * cols + k];
+		}
+		norm = std::sqrt(norm);
+		if (norm == 0) {
+			continue;
+		}
+
+		// v = x - alpha e1 is stored over the column, alpha has the opposite sign of x1
+		double first = block[k * cols + k];
+		double alpha = first > 0 ? -norm : norm;
+		block[k * cols + k] = first - alpha;
+		double tau = 1 / (norm * norm - alpha * first);
+
+		// w^T = tau v^T A row by row, then A -= v w^T
+		std::fill(w.begin() + k + 1, w.end(), 0);
+		for (size_t i = k; i < rows; ++i) {
+			const double* row = block + i * cols;
+			for (size_t j = k + 1; j < cols; ++j) {
+				w[j] += row[k] * row[j];
+			}
+		}
+		for (size_t i = k; i < rows; ++i) {
+			double* row = block + i * cols;
+			double koef = tau * row[k];
+			for (size_t j = k + 1; j < cols; ++j) {
+				row[j] -= koef * w[j];
+			}
+		}
+
+		block[k * cols + k] = alpha;
+		for (size_t i = k + 1; i < rows; ++i) {
+			block[i * cols + k] = 0;
+		}
+	}
+}
+
+bool leastSquaresSolve(const Matrix<double>& system, std::vector<double>& solution,
+					   double& residual, std::string& error) {
+	size_t m = system.getRow();
+	size_t cols = system.getCol();
+	size_t n = cols - 1;
+
+	// one block per worker, each of them reduced to its (n + 1) x (n + 1) triangle
+	size_t blocks = std::max<size_t>(1, std::min(workersCount(), m / std::max(MIN_BLOCK_ROWS, cols)));
+	size_t block_rows = (m + blocks - 1) / blocks;
+	// the blocks finished are the progress
+	std::vector<double> data(system.data(), system.data() + m * cols);
+	std::atomic<size_t> finished{0};
+	parallelFor(0, blocks, [&](size_t b) {
+		size_t begin = b * block_rows;
+		size_t end = std::min(m, begin + block_rows);
+		triangularize(&data[begin * cols], end - begin, cols);
+		reportProgress(++finished, blocks);
+	});
+	if (isEvaluationCancelled()) {
+		error = "Evaluation cancelled";
+		return false;
+	}
+
+	// stack the triangles and factor them once more
+	std::vector<double> stacked;
+	for (size_t b = 0; b < blocks; ++b) {
+		size_t begin = b * block_rows;
+		size_t rows = std::min(std::min(m, begin + block_rows) - begin, cols);
+		stacked.insert(stacked.end(), data.begin() + begin * cols, data.begin() + (begin + rows) * cols);
+	}
+	size_t stacked_rows = stacked.size() / cols;
+	if (blocks > 1) {
+		triangularize(stacked.data(), stacked_rows, cols);
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+	}
+
+	auto r = [&stacked, cols](size_t i, size_t j) {
+		return stacked[i * cols + j];
+	};
+
+	// R x = Q^T b, a negligible diagonal entry means A is rank deficient
+	double largest = 0;
+	for (size_t k = 0; k < n; ++k) {
+		largest = std::max(largest, std::abs(r(k, k)));
+	}
+	for (size_t k = 0; k < n; ++k) {
+		if (std::abs(r(k, k)) <= DBL_EPSILON * m * largest) {
+			return false;
+		}
+	}
+
+	solution.assign(n, 0);
+	for (size_t i = n; i-- > 0;) {
+		double value = r(i, n);
+		for (size_t j = i + 1; j < n; ++j) {
+			value -= r(i, j) * solution[j];
+		}
+		solution[i] = value / r(i, i);
+	}
+	residual = stacked_rows > n ? std::abs(r(n, n)) : 0;
+
+	return true;
+}
@@ -0,0 +1,313 @@
+#include "matrixfunction.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+// largest 1-norms for which the padé approximants of degree 3, 5, 7, 9 and 13
+// reach double precision without scaling
+static const double PADE_THETA[] = {1.495585217958292e-2, 2.539398330063230e-1,
+									9.504178996162932e-1, 2.097847961257068, 5.371920351148152};
+
+// coefficients of the padé approximants, b_k multiplies A^k
+static const double PADE_3[] = {120, 60, 12, 1};
+static const double PADE_5[] = {30240, 15120, 3360, 420, 30, 1};
+static const double PADE_7[] = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+static const double PADE_9[] = {17643225600, 8821612800, 2075673600, 302702400, 30270240,
+								2162160, 110880, 3960, 90, 1};
+static const double PADE_13[] = {64764752532480000, 32382376266240000, 7771770303897600,
+								 1187353796428800, 129060195264000, 10559470521600, 670442572800,
+								 33522128640, 1323241920, 40840800, 960960, 16380, 182, 1};
+
+// gauss-legendre nodes and weights on [0, 1] for the logarithm
+static const double LEGENDRE_NODES[] = {0.0198550717512319, 0.1016667612931866, 0.2372337950418355, 0.4082826787521751,
+										0.5917173212478249, 0.7627662049581645, 0.8983332387068134, 0.9801449282487681};
+static const double LEGENDRE_WEIGHTS[] = {0.0506142681451881, 0.1111905172266872, 0.1568533229389437, 0.1813418916891810,
+										  0.1813418916891810, 0.1568533229389437, 0.1111905172266872, 0.0506142681451881};
+
+// 1-norm of A - I below which the quadrature of the logarithm is accurate
+static const double LOGARITHM_RADIUS = 0.25;
+
+// angle the spectrum of a complex matrix is turned by when it touches the branch cut
+static const double BRANCH_ANGLE = 1e-8;
+
+// iterations of the square root and square roots of the logarithm before giving up
+static const int MAX_ITERATIONS = 100;
+static const int MAX_SQUARE_ROOTS = 64;
+
+// largest column sum
+template <typename Scalar>
+static double norm1(const Matrix<Scalar>& matrix) {
+	std::vector<double> sums(matrix.getCol(), 0);
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			sums[j] += std::abs(matrix[i][j]);
+		}
+	}
+
+	return sums.empty() ? 0 : *std::max_element(sums.begin(), sums.end());
+}
+
+template <typename Scalar>
+static Matrix<Scalar> identity(size_t n) {
+	Matrix<Scalar> result(n, n);
+	for (size_t i = 0; i < n; ++i) {
+		result[i][i] = 1;
+	}
+
+	return result;
+}
+
+// overwrite B with A^-1 B by lu with partial pivoting, log |det A| is accumulated on the way;
+// false if A is singular
+template <typename Scalar>
+static bool solveInPlace(Matrix<Scalar> a, Matrix<Scalar>& b, double& log_determinant) {
+	size_t n = a.getRow();
+	size_t m = b.getCol();
+	double scale = std::max(norm1(a), DBL_MIN);
+	log_determinant = 0;
+
+	for (size_t k = 0; k < n; ++k) {
+		size_t pivot = k;
+		for (size_t i = k + 1; i < n; ++i) {
+			if (std::abs(a[i][k]) > std::abs(a[pivot][k])) {
+				pivot = i;
+			}
+		}
+		if (std::abs(a[pivot][k]) <= n * DBL_EPSILON * scale) {
+			return false;
+		}
+		if (pivot != k) {
+			std::swap_ranges(a[k], a[k] + n, a[pivot]);
+			std::swap_ranges(b[k], b[k] + m, b[pivot]);
+		}
+		log_determinant += std::log(std::abs(a[k][k]));
+
+		for (size_t i = k + 1; i < n; ++i) {
+			Scalar koef = a[i][k] / a[k][k];
+			if (koef == Scalar(0)) {
+				continue;
+			}
+			for (size_t j = k + 1; j < n; ++j) {
+				a[i][j] -= koef * a[k][j];
+			}
+			for (size_t j = 0; j < m; ++j) {
+				b[i][j] -= koef * b[k][j];
+			}
+		}
+	}
+
+	for (size_t k = n; k-- > 0;) {
+		for (size_t i = 0; i < k; ++i) {
+			Scalar koef = a[i][k] / a[k][k];
+			if (koef == Scalar(0)) {
+				continue;
+			}
+			for (size_t j = 0; j < m; ++j) {
+				b[i][j] -= koef * b[k][j];
+			}
+		}
+		for (size_t j = 0; j < m; ++j) {
+			b[k][j] /= a[k][k];
+		}
+	}
+
+	return true;
+}
+
+// even and odd parts V, U of the padé numerator for the degrees below 13
+template <typename Scalar>
+static void padeParts(const Matrix<Scalar>& a, const double* b, size_t degree, Matrix<Scalar>& u, Matrix<Scalar>& v) {
+	size_t n = a.getRow();
+	Matrix<Scalar> square = a * a;
+	Matrix<Scalar> power = identity<Scalar>(n);
+	Matrix<Scalar> odd(n, n);
+	v = Matrix<Scalar>(n, n);
+	for (size_t k = 0; k <= degree; k += 2) {
+		odd += power * Scalar(b[k + 1]);
+		v += power * Scalar(b[k]);
+		if (k + 2 <= degree) {
+			power = power * square;
+		}
+	}
+	u = a * odd;
+}
+
+template <typename Scalar>
+bool exponential(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error) {
+	size_t n = matrix.getRow();
+	double norm = norm1(matrix);
+	Matrix<Scalar> u;
+	Matrix<Scalar> v;
+	int squarings = 0;
+
+	const double* coefficients[] = {PADE_3, PADE_5, PADE_7, PADE_9};
+	size_t degree = 3;
+	for (size_t i = 0; i < 4 && degree != 0; ++i, degree += 2) {
+		if (norm <= PADE_THETA[i]) {
+			padeParts(matrix, coefficients[i], degree, u, v);
+			degree = 0;
+			break;
+		}
+	}
+
+	if (degree != 0) {
+		// degree 13 after scaling A by 2^-s, the powers are shared between U and V
+		if (norm > PADE_THETA[4]) {
+			squarings = static_cast<int>(std::ceil(std::log2(norm / PADE_THETA[4])));
+		}
+		Matrix<Scalar> a = matrix * Scalar(std::ldexp(1.0, -squarings));
+		Matrix<Scalar> a2 = a * a;
+		Matrix<Scalar> a4 = a2 * a2;
+		Matrix<Scalar> a6 = a4 * a2;
+		const double* b = PADE_13;
+		Matrix<Scalar> id = identity<Scalar>(n);
+
+		Matrix<Scalar> high = a6 * Scalar(b[13]) + a4 * Scalar(b[11]) + a2 * Scalar(b[9]);
+		u = a * (a6 * high + a6 * Scalar(b[7]) + a4 * Scalar(b[5]) + a2 * Scalar(b[3]) + id * Scalar(b[1]));
+		high = a6 * Scalar(b[12]) + a4 * Scalar(b[10]) + a2 * Scalar(b[8]);
+		v = a6 * high + a6 * Scalar(b[6]) + a4 * Scalar(b[4]) + a2 * Scalar(b[2]) + id * Scalar(b[0]);
+	}
+
+	// r = (V - U)^-1 (V + U), then undo the scaling by squaring
+	result = v + u;
+	double log_determinant;
+	if (!solveInPlace(v - u, result, log_determinant)) {
+		error = "Semantic error: matrix exponential overflowed";
+		return false;
+	}
+	for (int i = 0; i < squarings; ++i) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(i, squarings);
+
+		result = result * result;
+	}
+
+	return true;
+}
+
+// product form of the denman-beavers iteration, M_k -> I and Y_k -> A^1/2 with one
+// inversion per step; scaling by |det M_k|^(-1/2n) speeds up the first iterations
+template <typename Scalar>
+static bool denmanBeavers(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error) {
+	size_t n = matrix.getRow();
+	Matrix<Scalar> id = identity<Scalar>(n);
+	Matrix<Scalar> m = matrix;
+	Matrix<Scalar> y = matrix;
+	double tolerance = 10 * n * DBL_EPSILON;
+	bool is_scaled = true;
+
+	for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(iteration, MAX_ITERATIONS);
+
+		Matrix<Scalar> m_inverse = id;
+		double log_determinant;
+		if (!solveInPlace(m, m_inverse, log_determinant)) {
+			error = "Semantic error: can not take a square root of a singular matrix";
+			return false;
+		}
+
+		double mu = is_scaled ? std::exp(-log_determinant / (2 * n)) : 1;
+		Matrix<Scalar> factor = (id + m_inverse * Scalar(1 / (mu * mu))) * Scalar(0.5 * mu);
+		y = y * factor;
+		m = (id + (m * Scalar(mu * mu) + m_inverse * Scalar(1 / (mu * mu))) * Scalar(0.5)) * Scalar(0.5);
+
+		double distance = norm1(m - id);
+		is_scaled = distance > 1e-2;
+		if (distance <= tolerance) {
+			result = y;
+			return true;
+		}
+	}
+
+	error = "Semantic error: matrix has no principal square root in this type";
+	return false;
+}
+
+template <typename Scalar>
+bool squareRoot(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error) {
+	if (denmanBeavers(matrix, result, error)) {
+		return true;
+	}
+	if (isEvaluationCancelled()) {
+		return false;
+	}
+
+	// a complex matrix with eigenvalues on the negative real axis still has a principal root,
+	// sqrt(-1) = i; the iteration can not leave the real line there, so the spectrum is turned
+	// off the branch cut by a tiny angle and the root is turned back by half of it
+	if constexpr (std::is_same_v<Scalar, std::complex<double>>) {
+		std::string rotated_error;
+		Scalar angle = std::polar(1.0, -BRANCH_ANGLE);
+		if (denmanBeavers(Matrix<Scalar>(matrix * angle), result, rotated_error)) {
+			result *= std::polar(1.0, BRANCH_ANGLE / 2);
+			error = "";
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template <typename Scalar>
+bool logarithm(const Matrix<Scalar>& matrix, Matrix<Scalar>& result, std::string& error) {
+	size_t n = matrix.getRow();
+	Matrix<Scalar> id = identity<Scalar>(n);
+	Matrix<Scalar> x = matrix;
+	int roots = 0;
+	while (norm1(x - id) > LOGARITHM_RADIUS) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(roots, MAX_SQUARE_ROOTS);
+
+		if (roots == MAX_SQUARE_ROOTS || !squareRoot(Matrix<Scalar>(x), x, error)) {
+			if (isEvaluationCancelled()) {
+				error = "Evaluation cancelled";
+			}
+			else if (error == "Semantic error: can not take a square root of a singular matrix") {
+				error = "Semantic error: can not take a logarithm of a singular matrix";
+			}
+			else {
+				error = "Semantic error: matrix has no principal logarithm in this type";
+			}
+			return false;
+		}
+		++roots;
+	}
+
+	// log(I + R) = sum of w_j (I + t_j R)^-1 R
+	Matrix<Scalar> r = x - id;
+	result = Matrix<Scalar>(n, n);
+	for (size_t j = 0; j < 8; ++j) {
+		Matrix<Scalar> term = r;
+		double log_determinant;
+		if (!solveInPlace(id + r * Scalar(LEGENDRE_NODES[j]), term, log_determinant)) {
+			error = "Semantic error: can not take a logarithm of a singular matrix";
+			return false;
+		}
+		result += term * Scalar(LEGENDRE_WEIGHTS[j]);
+	}
+	result *= Scalar(std::ldexp(1.0, roots));
+
+	return true;
+}
+
+template bool exponential(const Matrix<double>&, Matrix<double>&, std::string&);
+template bool exponential(const Matrix<std::complex<double>>&, Matrix<std::complex<double>>&, std::string&);
+template bool squareRoot(const Matrix<double>&, Matrix<double>&, std::string&);
+template bool squareRoot(const Matrix<std::complex<double>>&, Matrix<std::complex<double>>&, std::string&);
+template bool logarithm(const Matrix<double>&, Matrix<double>&, std::string&);
+template bool logarithm(const Matrix<std::complex<double>>&, Matrix<std::complex<double>>&, std::string&);
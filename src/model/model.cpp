@@ -1,728 +1,3605 @@
 #include "model.h" // include header file
+#include "modular.h" // exact determinant and solver
+#include "refinement.h" // mixed precision solver
+#include "leastsquares.h" // overdetermined systems
+#include "krylov.h" // iterative solvers
+#include "progress.h" // cancellation of long evaluations
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <system_error>
 
+// residues are kept below 2^31 so that a product fits into size_t
+static const size_t MAX_MODULUS = 2147483647;
+
+// priority of the comma, which binds weakest of all operators
+static const int COMMA_PRIORITY = 5;
+
+// digits of an integer in an expression which is kept as it is written, it fits into long long
+static const size_t MAX_INTEGER_DIGITS = 18;
+
+// relative tolerance and probe vectors of the randomized sketches when not given
+static const double DEFAULT_SKETCH_TOLERANCE = 1e-6;
+static const size_t DEFAULT_OVERSAMPLING = 10;
+
+// entries a kronecker product may have when it has to be written out
+static const size_t MAX_KRONECKER_ENTRIES = 1 << 24;
+
+// expressions kept up to date when the variables they read change
+static const size_t MAX_LIVE_EXPRESSIONS = 64;
+
+// compiled expressions kept in every field
+static const size_t MAX_PROGRAMS = 64;
+
+// numbered subtrees kept in every field before the numbering starts again
+static const size_t MAX_SUBTREES = 1 << 20;
+
+// operators and brackets with their kinds and priorities, the lower the priority the tighter
+// the operator binds; a function is an operator of the operand after it
+struct lexEntry {
+	std::string_view text_;
+	tokenKind kind_;
+	int priority_;
+	nodeKind node_;
+};
+
+static const lexEntry LEX_TABLE[] = {
+	{"+", binaryToken, 4, plusNode}, {"-", binaryToken, 4, minusNode}, {"*", binaryToken, 3, multiplyNode},
+	{".*", binaryToken, 3, hadamardNode}, {"/", binaryToken, 3, divideNode}, {"^", binaryToken, 2, powerNode},
+	{",", binaryToken, COMMA_PRIORITY, commaNode}, {"tr", functionToken, 1, traceNode}, {"inv", functionToken, 1, inverseNode},
+	{"det", functionToken, 1, determinantNode}, {"rk", functionToken, 1, rankNode}, {"trans", functionToken, 1, transposeNode},
+	{"eig", functionToken, 1, eigenvaluesNode}, {"charpoly", functionToken, 1, charpolyNode}, {"svd", functionToken, 1, svdNode},
+	{"pinv", functionToken, 1, pinvNode}, {"solve", functionToken, 1, solveNode}, {"rankest", functionToken, 1, rankestNode},
+	{"svdk", functionToken, 1, svdkNode}, {"normest", functionToken, 1, normestNode}, {"expm", functionToken, 1, expmNode},
+	{"logm", functionToken, 1, logmNode}, {"sqrtm", functionToken, 1, sqrtmNode}, {"kron", functionToken, 1, kronNode},
+	{"(", openToken, 0, varNode}, {")", closeToken, 0, varNode}, {"[", openSquareToken, 0, varNode},
+	{"]", closeSquareToken, 0, varNode}, {":", separatorToken, 0, varNode}, {";", separatorToken, 0, varNode}
+};
+
+// names of the node kinds in the order of nodeKind, for the printed tree and the keys of subtrees
+static const std::string_view NODE_NAMES[] = {
+	"var", "number", "+", "-", "*", ".*", "/", "^", ",", "tr", "inv", "det", "rk", "trans", "eig", "charpoly", "svd",
+	"pinv", "solve", "rankest", "svdk", "normest", "expm", "logm", "sqrtm", "kron", "[]", "hcat", "vcat"
+};
+
+static const lexEntry* findLexEntry(std::string_view text) {
+	for (const lexEntry& entry : LEX_TABLE) {
+		if (entry.text_ == text) {
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+// beginning of an operator, which may be longer
+static bool isLexPrefix(std::string_view text) {
+	for (const lexEntry& entry : LEX_TABLE) {
+		if (entry.text_.substr(0, text.length()) == text) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 // calculation
 
 // set up values
-void Token::setUpMatrix(const std::vector<std::vector<float>>& matrix, std::string& error) {
+template <typename Field>
+void Token<Field>::setUpView(const std::shared_ptr<const Matrix<Field>>& matrix) {
 	is_ans_number_ = false;
-	ans_matrix_ = matrix;
+	ans_views_ = {wholeView(matrix)};
 }
 
-void Token::setUpNumber(const std::string& num, std::string& error) {
-	char* pend;
+template <typename Field>
+void Token<Field>::setUpNumber(const std::string& num, std::string& error) {
 	is_ans_number_ = true;
-	ans_float_ = std::strtof(num.c_str(), &pend);
-	if (pend == num.c_str()) {
-		error = "Syntax error: wrong format for a real number";
+	if (!fieldTraits<Field>::parse(num, ans_number_)) {
+		error = "Syntax error: wrong format for a number";
 		return;
 	}
 	return;
 }
 
-void Token::setUpNumber(float num) {
+template <typename Field>
+void Token<Field>::setUpNumber(const Field& num) {
 	is_ans_number_ = true;
-	ans_float_ = num;
+	ans_number_ = num;
 	return;
 }
 
+// answer matrix, a view which is left at this point covers a whole matrix
+template <typename Field>
+const Matrix<Field>& Token<Field>::matrix() const {
+	if (isView()) {
+		return *ans_views_[0].source_;
+	}
+
+	return ans_matrix_;
+}
+
+// kronecker products kept as factors
+
+template <typename Field>
+static void getDimensions(const Token<Field>& node, size_t& rows, size_t& cols) {
+	if (node.isKronecker()) {
+		kroneckerSize(node.ans_factors_, rows, cols);
+		return;
+	}
+	if (node.isView()) {
+		viewsSize(node.ans_views_, rows, cols);
+		return;
+	}
+	rows = node.ans_matrix_.getRow();
+	cols = node.ans_matrix_.getCol();
+}
+
+static bool fitsMemory(size_t rows, size_t cols) {
+	return cols == 0 || rows <= MAX_KRONECKER_ENTRIES / cols;
+}
+
+template <typename Field>
+static bool isSquareKronecker(const std::vector<Matrix<Field>>& factors) {
+	for (const Matrix<Field>& factor : factors) {
+		if (factor.getRow() != factor.getCol()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// write out a kronecker product, the arguments of a function are reached through its commas
+template <typename Field>
+static void materializeKronecker(Token<Field>* node, std::string& error) {
+	if (error != "" || !node) {
+		return;
+	}
+
+	if (node->kind_ == commaNode) {
+		materializeKronecker(node->left_, error);
+		materializeKronecker(node->right_, error);
+		return;
+	}
+
+	if (!node->isKronecker()) {
+		return;
+	}
+
+	size_t rows;
+	size_t cols;
+	getDimensions(*node, rows, cols);
+	if (!fitsMemory(rows, cols)) {
+		error = "Semantic error: kronecker product is too large to be written out";
+		return;
+	}
+
+	node->ans_matrix_ = kroneckerProduct(node->ans_factors_);
+	node->ans_factors_.clear();
+}
+
+// views into other matrices
+
+// assemble the pieces of a view, a view of a whole matrix is read in place
+template <typename Field>
+static void materializeViews(Token<Field>* node) {
+	if (!node) {
+		return;
+	}
+
+	if (node->kind_ == commaNode) {
+		materializeViews(node->left_);
+		materializeViews(node->right_);
+		return;
+	}
+
+	if (!node->isView() || isWholeView(node->ans_views_)) {
+		return;
+	}
+
+	node->ans_matrix_ = assembleViews(node->ans_views_);
+	node->ans_views_.clear();
+}
+
+// turn the answer matrix into a view of itself, the matrix is moved into shared storage;
+// the storage itself is not const, so that its last owner may take it over
+template <typename Field>
+static void makeView(Token<Field>& node) {
+	if (node.isView() || node.is_ans_number_) {
+		return;
+	}
+
+	node.ans_views_ = {wholeView<Field>(std::make_shared<Matrix<Field>>(std::move(node.ans_matrix_)))};
+}
+
+// take over the storage of an operand which no later step reads, so that the node writes
+// its answer in place; not if the other operand is the same node or the storage is shared
+template <typename Field>
+static bool takeMatrix(Token<Field>& node, Token<Field>& operand, const Token<Field>& other) {
+	if (!operand.is_last_read_ || &operand == &other || operand.is_ans_number_ || operand.isKronecker()) {
+		return false;
+	}
+
+	if (!operand.isView()) {
+		node.ans_matrix_ = std::move(operand.ans_matrix_);
+	}
+	else if (isWholeView(operand.ans_views_) && operand.ans_views_[0].source_.use_count() == 1) {
+		node.ans_matrix_ = std::move(const_cast<Matrix<Field>&>(*operand.ans_views_[0].source_));
+		operand.ans_views_.clear();
+	}
+	else {
+		return false;
+	}
+	node.is_in_place_ = true;
+
+	return true;
+}
+
+// drop the answer of a register which no later step reads, a number costs nothing to keep
+template <typename Field>
+static void releaseAnswer(Token<Field>& node) {
+	node.ans_matrix_ = Matrix<Field>();
+	node.ans_factors_.clear();
+	node.ans_views_.clear();
+}
+
+// pieces of a block, a number is a 1 x 1 matrix which is not kept in its node,
+// since other operators may read the same node as a number
+template <typename Field>
+static std::vector<matrixView<Field>> getBlockViews(Token<Field>& node) {
+	if (!node.is_ans_number_) {
+		makeView(node);
+		return node.ans_views_;
+	}
+
+	Matrix<Field> matrix(1, 1);
+	matrix[0][0] = node.ans_number_;
+	return {wholeView(std::make_shared<const Matrix<Field>>(std::move(matrix)))};
+}
+
+// product where one of the operands is a kronecker product
+template <typename Field>
+static void multiplyKronecker(Token<Field>& lhs, Token<Field>& rhs, Token<Field>& result, std::string& error) {
+	result.is_ans_number_ = false;
+
+	// a number scales the first factor
+	if (lhs.is_ans_number_ || rhs.is_ans_number_) {
+		const Field& number = lhs.is_ans_number_ ? lhs.ans_number_ : rhs.ans_number_;
+		result.ans_factors_ = lhs.is_ans_number_ ? rhs.ans_factors_ : lhs.ans_factors_;
+		result.ans_factors_[0] = number * result.ans_factors_[0];
+		return;
+	}
+
+	size_t lhs_rows;
+	size_t lhs_cols;
+	size_t rhs_rows;
+	size_t rhs_cols;
+	getDimensions(lhs, lhs_rows, lhs_cols);
+	getDimensions(rhs, rhs_rows, rhs_cols);
+	if (lhs_cols != rhs_rows) {
+		error = "Semantic error: can't multiply such matrices";
+		return;
+	}
+
+	// (A x B)(C x D) = AC x BD when the factors can be multiplied pairwise
+	const std::vector<Matrix<Field>>& lhs_factors = lhs.ans_factors_;
+	const std::vector<Matrix<Field>>& rhs_factors = rhs.ans_factors_;
+	if (lhs.isKronecker() && rhs.isKronecker() && lhs_factors.size() == rhs_factors.size()) {
+		bool is_matching = true;
+		for (size_t t = 0; t < lhs_factors.size(); ++t) {
+			is_matching = is_matching && lhs_factors[t].getCol() == rhs_factors[t].getRow();
+		}
+
+		if (is_matching) {
+			result.ans_factors_.resize(lhs_factors.size());
+			for (size_t t = 0; t < lhs_factors.size(); ++t) {
+				result.ans_factors_[t] = multiply(lhs_factors[t], rhs_factors[t]);
+			}
+			return;
+		}
+	}
+
+	if (!fitsMemory(lhs_rows, rhs_cols)) {
+		error = "Semantic error: product is too large to be written out";
+		return;
+	}
+
+	// otherwise the other operand is written out and the factors are applied mode by mode,
+	// on the right through X K = (K^T X^T)^T
+	if (lhs.isKronecker()) {
+		// a shared node times itself keeps its factors, they are still read as lhs
+		if (&lhs == &rhs) {
+			result.ans_matrix_ = kroneckerApply(lhs_factors, kroneckerProduct(rhs_factors));
+			return;
+		}
+
+		materializeKronecker(&rhs, error);
+		if (error == "") {
+			result.ans_matrix_ = kroneckerApply(lhs_factors, rhs.matrix());
+		}
+		return;
+	}
+
+	std::vector<Matrix<Field>> transposed;
+	for (const Matrix<Field>& factor : rhs_factors) {
+		transposed.push_back(factor.transposed());
+	}
+	result.ans_matrix_ = kroneckerApply(transposed, lhs.matrix().transposed()).transposed();
+}
+
+// integer power of a square matrix, negative powers go through the inverse
+template <typename Field>
+static bool matrixPower(const Matrix<Field>& matr, long long exponent, Matrix<Field>& result, std::string& error) {
+	if (exponent == 0) {
+		Matrix<Field> identity(matr.getRow(), matr.getCol());
+		for (size_t i = 0; i < identity.getRow(); ++i) {
+			identity[i][i] = 1;
+		}
+		result = identity;
+		return true;
+	}
+
+	if (exponent < 0) {
+		if (fieldTraits<Field>::isZero(determinant(matr))) {
+			error = "Semantic error: matrix is a singular matrix";
+			return false;
+		}
+		result = pow(inverse(matr), -exponent);
+		return true;
+	}
+
+	result = pow(matr, exponent);
+	return true;
+}
+
 // universal calculate function
-void Var::calc(std::string& error) {}
+template <typename Field>
+void Var<Field>::calc(std::string& error) {}
 
-void Number::calc(std::string& error) {}
+template <typename Field>
+void Number<Field>::calc(std::string& error) {}
 
 // token's children
-void Plus::calc(std::string& error) {
+template <typename Field>
+void Plus<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_ || !right_) {
+	if (!this->left_ || !this->right_) {
 		error = "Syntax error: not enough operands for plus";
 		return;
 	}
 
-	if (left_->is_ans_number_ && !right_->is_ans_number_ ||
-		!left_->is_ans_number_ && right_->is_ans_number_) {
+	if (this->left_->is_ans_number_ && !this->right_->is_ans_number_ ||
+		!this->left_->is_ans_number_ && this->right_->is_ans_number_) {
 		error = "Semantic error: can't add number and matrix";
 		return;
 	}
 
-	if (!left_->is_ans_number_) {
-		Matrix<float> matr1(left_->ans_matrix_);
-		Matrix<float> matr2(right_->ans_matrix_);
-		if (matr1.getRow() != matr2.getRow() || matr1.getCol() != matr2.getCol()) {
+	// the sum is written straight from the pieces of views, without assembling them first
+	if (!this->left_->is_ans_number_) {
+		size_t rows1;
+		size_t cols1;
+		size_t rows2;
+		size_t cols2;
+		getDimensions(*this->left_, rows1, cols1);
+		getDimensions(*this->right_, rows2, cols2);
+		if (rows1 != rows2 || cols1 != cols2) {
 			error = "Semantic error: can't add matrices of different dimensions";
 			return;
 		}
 
-		is_ans_number_ = false;
-		ans_matrix_ = (matr1 + matr2).getMatrix();
+		// the sum is written into the storage of the left operand, or else of the right one
+		this->is_ans_number_ = false;
+		if (takeMatrix(*this, *this->left_, *this->right_)) {
+			makeView(*this->right_);
+			addViews(this->ans_matrix_, this->right_->ans_views_, false);
+		}
+		else if (takeMatrix(*this, *this->right_, *this->left_)) {
+			makeView(*this->left_);
+			addViews(this->ans_matrix_, this->left_->ans_views_, false);
+		}
+		else {
+			makeView(*this->left_);
+			this->ans_matrix_ = assembleViews(this->left_->ans_views_);
+			makeView(*this->right_);
+			addViews(this->ans_matrix_, this->right_->ans_views_, false);
+		}
 		return;
 	}
 
-	is_ans_number_ = true;
-	ans_float_ = left_->ans_float_ + right_->ans_float_;
+	this->is_ans_number_ = true;
+	this->ans_number_ = this->left_->ans_number_ + this->right_->ans_number_;
 	return;
 }
 
-void Minus::calc(std::string& error) {
+template <typename Field>
+void Minus<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_ || !right_) {
+	if (!this->left_ || !this->right_) {
 		error = "Syntax error: not enough operands for minus";
 		return;
 	}
 
-	if (left_->is_ans_number_ && !right_->is_ans_number_ ||
-		!left_->is_ans_number_ && right_->is_ans_number_) {
+	if (this->left_->is_ans_number_ && !this->right_->is_ans_number_ ||
+		!this->left_->is_ans_number_ && this->right_->is_ans_number_) {
 		error = "Semantic error: can't subtract number and matrix";
 		return;
 	}
 
-	if (!left_->is_ans_number_) {
-		Matrix<float> matr1(left_->ans_matrix_);
-		Matrix<float> matr2(right_->ans_matrix_);
-		if (matr1.getRow() != matr2.getRow() || matr1.getCol() != matr2.getCol()) {
+	// the sum is written straight from the pieces of views, without assembling them first
+	if (!this->left_->is_ans_number_) {
+		size_t rows1;
+		size_t cols1;
+		size_t rows2;
+		size_t cols2;
+		getDimensions(*this->left_, rows1, cols1);
+		getDimensions(*this->right_, rows2, cols2);
+		if (rows1 != rows2 || cols1 != cols2) {
 			error = "Semantic error: can not subtract matrices of different dimensions";
 			return;
 		}
 
-		is_ans_number_ = false;
-		ans_matrix_ = (matr1 - matr2).getMatrix();
+		// the difference is written into the storage of the left operand, or else of the right one
+		this->is_ans_number_ = false;
+		if (takeMatrix(*this, *this->left_, *this->right_)) {
+			makeView(*this->right_);
+			addViews(this->ans_matrix_, this->right_->ans_views_, true);
+		}
+		else if (takeMatrix(*this, *this->right_, *this->left_)) {
+			makeView(*this->left_);
+			subtractFromViews(this->ans_matrix_, this->left_->ans_views_);
+		}
+		else {
+			makeView(*this->left_);
+			this->ans_matrix_ = assembleViews(this->left_->ans_views_);
+			makeView(*this->right_);
+			addViews(this->ans_matrix_, this->right_->ans_views_, true);
+		}
 		return;
 	}
 
-	is_ans_number_ = true;
-	ans_float_ = left_->ans_float_ - right_->ans_float_;
+	this->is_ans_number_ = true;
+	this->ans_number_ = this->left_->ans_number_ - this->right_->ans_number_;
 	return;
 }
 
-void Multiply::calc(std::string& error) {
+template <typename Field>
+void Multiply<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_ || !right_) {
+	if (!this->left_ || !this->right_) {
 		error = "Syntax error:: not enough operands for multiply";
 		return;
 	}
 
-	if (left_->is_ans_number_ && !right_->is_ans_number_) {
-		is_ans_number_ = false;
-		ans_matrix_ = (left_->ans_float_ * Matrix<float>(right_->ans_matrix_)).getMatrix();
+	if (this->left_->isKronecker() || this->right_->isKronecker()) {
+		multiplyKronecker(*this->left_, *this->right_, *this, error);
 		return;
 	}
 
-	if (!left_->is_ans_number_ && right_->is_ans_number_) {
-		is_ans_number_ = false;
-		ans_matrix_ = (right_->ans_float_ * Matrix<float>(left_->ans_matrix_)).getMatrix();
+	// a matrix scaled by a number is scaled in place when no later step reads it
+	if (this->left_->is_ans_number_ != this->right_->is_ans_number_) {
+		Token<Field>& number = this->left_->is_ans_number_ ? *this->left_ : *this->right_;
+		Token<Field>& matrix = this->left_->is_ans_number_ ? *this->right_ : *this->left_;
+		this->is_ans_number_ = false;
+		if (takeMatrix(*this, matrix, number)) {
+			this->ans_matrix_ *= number.ans_number_;
+		}
+		else {
+			this->ans_matrix_ = number.ans_number_ * matrix.matrix();
+		}
 		return;
 	}
 
-	if (left_->is_ans_number_) {
-		is_ans_number_ = true;
-		ans_float_ = left_->ans_float_ * right_->ans_float_;
+	if (this->left_->is_ans_number_) {
+		this->is_ans_number_ = true;
+		this->ans_number_ = this->left_->ans_number_ * this->right_->ans_number_;
 		return;
 	}
 
-	Matrix<float> matr1(left_->ans_matrix_);
-	Matrix<float> matr2(right_->ans_matrix_);
+	const Matrix<Field>& matr1 = this->left_->matrix();
+	const Matrix<Field>& matr2 = this->right_->matrix();
 	if (matr1.getCol() != matr2.getRow()) {
 		error = "Semantic error: can't multiply such matrices";
 		return;
 	}
 
-	is_ans_number_ = false;
-	ans_matrix_ = (matr1 * matr2).getMatrix();
+	this->is_ans_number_ = false;
+	this->ans_matrix_ = multiply(matr1, matr2);
 	return;
 }
 
-void Divide::calc(std::string& error) {
+template <typename Field>
+void Divide<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_ || !right_) {
+	if (!this->left_ || !this->right_) {
 		error = "Syntax error: not enough operands for divide";
 		return;
 	}
 
-	if (!left_->is_ans_number_ || !right_->is_ans_number_) {
+	if (!this->left_->is_ans_number_ || !this->right_->is_ans_number_) {
 		error = "Semantic error: can not divide matrices";
 		return;
 	}
 
-	if (std::abs(right_->ans_float_) == 0.0) {
+	if (fieldTraits<Field>::isZero(this->right_->ans_number_)) {
 		error = "Semantic error: can not divide by 0";
 		return;
 	}
 
-	is_ans_number_ = true;
-	ans_float_ = left_->ans_float_ / right_->ans_float_;
+	this->is_ans_number_ = true;
+	this->ans_number_ = this->left_->ans_number_ / this->right_->ans_number_;
 	return;
 }
 
-void Power::calc(std::string& error) {
+// integer value of a number: an integer written in the expression is taken as it is written,
+// since a residue keeps it only modulo its modulus, other numbers as their field holds them
+template <typename Field>
+static bool getInteger(const Token<Field>& node, long long& value) {
+	if (node.kind_ == numberNode && static_cast<const Number<Field>&>(node).is_integer_) {
+		value = static_cast<const Number<Field>&>(node).integer_;
+		return true;
+	}
+
+	return node.is_ans_number_ && fieldTraits<Field>::toInteger(node.ans_number_, value);
+}
+
+template <typename Field>
+void Power<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_ || !right_) {
+	if (!this->left_ || !this->right_) {
 		error = "Syntax error: not enough operands to do power";
 		return;
 	}
 
-	if (!right_->is_ans_number_) {
+	if (!this->right_->is_ans_number_) {
 		error = "Semantic error: can not take matrix as the power";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
-		is_ans_number_ = true;
-		ans_float_ = std::pow(left_->ans_float_, right_->ans_float_);
+	// the exponent of a residue is an integer of the expression, not a residue itself
+	long long exponent;
+	bool is_integer = getInteger(*this->right_, exponent);
+	if (std::is_same_v<Field, residue<0>> && !is_integer) {
+		error = "Semantic error: the power of a residue must be an integer written in the expression";
 		return;
 	}
 
-	is_ans_number_ = false;
-	int exponent = right_->ans_float_;
-	float diff = right_->ans_float_ - exponent;
-	if (diff > 0) {
+	if (this->left_->is_ans_number_) {
+		this->is_ans_number_ = true;
+		if constexpr (std::is_same_v<Field, residue<0>>) {
+			fieldTraits<Field>::power(this->left_->ans_number_, exponent, this->ans_number_, error);
+		}
+		else {
+			fieldTraits<Field>::power(this->left_->ans_number_, this->right_->ans_number_, this->ans_number_, error);
+		}
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	if (!is_integer) {
 		error = "Semantic error: can not take a maatrix to a float power";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
+	// (A x B)^k = A^k x B^k for square factors
+	if (this->left_->isKronecker()) {
+		const std::vector<Matrix<Field>>& factors = this->left_->ans_factors_;
+		if (isSquareKronecker(factors)) {
+			std::vector<Matrix<Field>> powers(factors.size());
+			for (size_t t = 0; t < factors.size(); ++t) {
+				if (!matrixPower(factors[t], exponent, powers[t], error)) {
+					return;
+				}
+			}
+			this->ans_factors_ = powers;
+			return;
+		}
+
+		materializeKronecker(this->left_, error);
+		if (error != "") {
+			return;
+		}
+	}
+
+	const Matrix<Field>& matr = this->left_->matrix();
 	if (matr.getRow() != matr.getCol()) {
 		error = "Semantic error: can not take a power of a non square matrix";
 		return;
 	}
 
-	is_ans_number_ = false;
-	ans_matrix_ = pow(matr, exponent).getMatrix();
+	matrixPower(matr, exponent, this->ans_matrix_, error);
 	return;
 }
 
-void Trace::calc(std::string& error) {
+// tr(X*Y) from the rows of X and the columns of Y, only the diagonal of the product is computed;
+// a number or a kronecker product is multiplied out first, as the product would be
+template <typename Field>
+static void traceProduct(Token<Field>& lhs, Token<Field>& rhs, Token<Field>& result, std::string& error) {
+	materializeViews(&lhs);
+	materializeViews(&rhs);
+	if (lhs.is_ans_number_ || rhs.is_ans_number_ || lhs.isKronecker() || rhs.isKronecker()) {
+		Multiply<Field> product;
+		product.left_ = &lhs;
+		product.right_ = &rhs;
+		product.calc(error);
+
+		Trace<Field> trace;
+		trace.left_ = &product;
+		trace.calc(error);
+		result.is_ans_number_ = true;
+		result.ans_number_ = trace.ans_number_;
+		return;
+	}
+
+	const Matrix<Field>& matr1 = lhs.matrix();
+	const Matrix<Field>& matr2 = rhs.matrix();
+	if (matr1.getCol() != matr2.getRow()) {
+		error = "Semantic error: can't multiply such matrices";
+		return;
+	}
+	if (matr1.getRow() != matr2.getCol()) {
+		error = "Semantic error: can not take trace of a non square matrix";
+		return;
+	}
+
+	result.is_ans_number_ = true;
+	result.ans_number_ = Field(0);
+	for (size_t i = 0; i < matr1.getRow(); ++i) {
+		for (size_t k = 0; k < matr1.getCol(); ++k) {
+			result.ans_number_ += matr1[i][k] * matr2[k][i];
+		}
+	}
+}
+
+template <typename Field>
+void Trace<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_) {
+	if (!this->left_) {
 		error = "Syntax error: not enough operands to do trace";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
+	if (this->left_->kind_ == commaNode) {
+		traceProduct(*this->left_->left_, *this->left_->right_, *this, error);
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
 		error = "Semantic error: can not take trace of a number";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
-	if (matr.getRow() != matr.getCol()) {
+	// tr(A x B) = tr(A) tr(B) for square factors
+	if (this->left_->isKronecker()) {
+		if (isSquareKronecker(this->left_->ans_factors_)) {
+			this->is_ans_number_ = true;
+			this->ans_number_ = Field(1);
+			for (const Matrix<Field>& factor : this->left_->ans_factors_) {
+				this->ans_number_ *= factor.trace();
+			}
+			return;
+		}
+
+		materializeKronecker(this->left_, error);
+		if (error != "") {
+			return;
+		}
+	}
+
+	size_t rows;
+	size_t cols;
+	getDimensions(*this->left_, rows, cols);
+	if (rows != cols) {
 		error = "Semantic error: can not take trace of a non square matrix";
 		return;
 	}
 
-	is_ans_number_ = true;
-	ans_float_ = matr.trace();
+	// the diagonal is read through the pieces of a view
+	this->is_ans_number_ = true;
+	if (this->left_->isView()) {
+		this->ans_number_ = traceViews(this->left_->ans_views_);
+		return;
+	}
+	this->ans_number_ = this->left_->ans_matrix_.trace();
 	return;
 }
 
-void Determinant::calc(std::string& error) {
+// det(X, Y) is the determinant of X*Y and det(c, X) the one of c*X, the rewrites build them in
+// floating fields, where the product is not formed and the determinants are multiplied without overflow
+template <typename Field>
+static void determinantProduct(Token<Field>& lhs, Token<Field>& rhs, Token<Field>& result, std::string& error) {
+	// a kronecker product keeps its factors, whose determinants give the one of the product
+	if (lhs.isKronecker() || rhs.isKronecker()) {
+		Multiply<Field> product;
+		product.left_ = &lhs;
+		product.right_ = &rhs;
+		product.calc(error);
+
+		Determinant<Field> determinant;
+		determinant.left_ = &product;
+		determinant.calc(error);
+		result.is_ans_number_ = true;
+		result.ans_number_ = determinant.ans_number_;
+		return;
+	}
+
+	materializeViews(&lhs);
+	materializeViews(&rhs);
+
+	if (rhs.is_ans_number_) {
+		error = "Semantic error: can not take determinant of a number";
+		return;
+	}
+
+	const Matrix<Field>& matr2 = rhs.matrix();
+	if (lhs.is_ans_number_) {
+		if (matr2.getRow() != matr2.getCol()) {
+			error = "Semantic error: can not find determinant of a non square matrix";
+			return;
+		}
+
+		result.is_ans_number_ = true;
+		result.ans_number_ = scaledDeterminant(lhs.ans_number_, matr2, static_cast<const Matrix<Field>*>(nullptr));
+		return;
+	}
+
+	const Matrix<Field>& matr1 = lhs.matrix();
+	if (matr1.getCol() != matr2.getRow()) {
+		error = "Semantic error: can't multiply such matrices";
+		return;
+	}
+	if (matr1.getRow() != matr1.getCol() || matr2.getRow() != matr2.getCol()) {
+		error = "Semantic error: can not find determinant of a non square matrix";
+		return;
+	}
+
+	result.is_ans_number_ = true;
+	result.ans_number_ = scaledDeterminant(Field(1), matr1, &matr2);
+}
+
+template <typename Field>
+void Determinant<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_) {
+	if (!this->left_) {
 		error = "Syntax error: not enough operands to find determinant";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
+	if (this->left_->kind_ == commaNode) {
+		determinantProduct(*this->left_->left_, *this->left_->right_, *this, error);
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
 		error = "Semantic error: can not take determinant of a number";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
+	// det(A x B) = det(A)^m det(B)^n for A of size n and B of size m, a square product
+	// with a factor which is not square has deficient rank
+	if (this->left_->isKronecker()) {
+		size_t rows;
+		size_t cols;
+		getDimensions(*this->left_, rows, cols);
+		if (rows != cols) {
+			error = "Semantic error: can not find determinant of a non square matrix";
+			return;
+		}
+
+		const std::vector<Matrix<Field>>& factors = this->left_->ans_factors_;
+		this->is_ans_number_ = true;
+		this->ans_number_ = Field(isSquareKronecker(factors) ? 1 : 0);
+		for (size_t t = 0; t < factors.size() && isSquareKronecker(factors); ++t) {
+			this->ans_number_ *= raisePower(determinant(factors[t]), rows / factors[t].getRow());
+		}
+		return;
+	}
+
+	const Matrix<Field>& matr = this->left_->matrix();
 	if (matr.getRow() != matr.getCol()) {
 		error = "Semantic error: can not find determinant of a non square matrix";
 		return;
 	}
 
-	is_ans_number_ = true;
-	ans_float_ = matr.det();
+	this->is_ans_number_ = true;
+	this->ans_number_ = determinant(matr);
 	return;
 }
 
-void Rank::calc(std::string& error) {
+template <typename Field>
+void Rank<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_) {
+	if (!this->left_) {
 		error = "Syntax error: not enough operands to find rank";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
+	if (this->left_->is_ans_number_) {
 		error = "Semantic error: can not find rank of a number";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
-	is_ans_number_ = true;
-	ans_float_ = matr.rank();
+	// rk(A x B) = rk(A) rk(B)
+	if (this->left_->isKronecker()) {
+		size_t product = 1;
+		for (const Matrix<Field>& factor : this->left_->ans_factors_) {
+			product *= rank(factor);
+		}
+		this->is_ans_number_ = true;
+		this->ans_number_ = Field(static_cast<int>(product));
+		return;
+	}
+
+	this->is_ans_number_ = true;
+	this->ans_number_ = Field(static_cast<int>(rank(this->left_->matrix())));
 }
 
-void Transpose::calc(std::string& error) {
+template <typename Field>
+void Transpose<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_) {
+	if (!this->left_) {
 		error = "Syntax error: not enough operands to find the tranpose";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
+	if (this->left_->is_ans_number_) {
 		error = "Semantic error: can not tranpose a number";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
-	is_ans_number_ = false;
-	ans_matrix_ = matr.transposed().getMatrix();
+	if (this->left_->isKronecker()) {
+		this->is_ans_number_ = false;
+		for (const Matrix<Field>& factor : this->left_->ans_factors_) {
+			this->ans_factors_.push_back(factor.transposed());
+		}
+		return;
+	}
+
+	// only the strides of the view are swapped
+	makeView(*this->left_);
+	this->is_ans_number_ = false;
+	this->ans_views_ = transposeViews(this->left_->ans_views_);
 	return;
 }
 
-void Inverse::calc(std::string& error) {
+template <typename Field>
+void Inverse<Field>::calc(std::string& error) {
 	if (error != "") {
 		return;
 	}
 
-	if (!left_) {
+	if (!this->left_) {
 		error = "Syntax error: not enough operands to find the inverse";
 		return;
 	}
 
-	if (left_->is_ans_number_) {
+	if (this->left_->is_ans_number_) {
 		error = "Semantic error: can not take an inverse of a number";
 		return;
 	}
 
-	Matrix<float> matr(left_->ans_matrix_);
+	// (A x B)^-1 = A^-1 x B^-1, a square product with a factor which is not square is singular
+	if (this->left_->isKronecker()) {
+		size_t rows;
+		size_t cols;
+		getDimensions(*this->left_, rows, cols);
+		if (rows != cols) {
+			error = "Semantic error: can not take an inverse of a non square matrix";
+			return;
+		}
+
+		const std::vector<Matrix<Field>>& factors = this->left_->ans_factors_;
+		std::vector<Matrix<Field>> inverses;
+		for (const Matrix<Field>& factor : factors) {
+			if (factor.getRow() != factor.getCol() || fieldTraits<Field>::isZero(determinant(factor))) {
+				error = "Semantic error: matrix is a singular matrix";
+				return;
+			}
+			inverses.push_back(inverse(factor));
+		}
+		this->is_ans_number_ = false;
+		this->ans_factors_ = inverses;
+		return;
+	}
+
+	const Matrix<Field>& matr = this->left_->matrix();
 	if (matr.getRow() != matr.getCol()) {
 		error = "Semantic error: can not take an inverse of a non square matrix";
 		return;
 	}
 
-	if (matr.det() == 0) {
+	if (fieldTraits<Field>::isZero(determinant(matr))) {
 		error = "Semantic error: matrix is a singular matrix";
 		return;
 	}
 
-	is_ans_number_ = false;
-	ans_matrix_ = matr.inverted().getMatrix();
+	this->is_ans_number_ = false;
+	this->ans_matrix_ = inverse(matr);
 	return;
 }
 
-// initialize static member
+template <typename Field>
+void CharacteristicPolynomial<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
 
-Model::sptrModel Model::model_ = nullptr;
+	if (!this->left_) {
+		error = "Syntax error: not enough operands to find the characteristic polynomial";
+		return;
+	}
 
-// create a single object of the class
+	if (this->left_->is_ans_number_) {
+		error = "Semantic error: can not find the characteristic polynomial of a number";
+		return;
+	}
 
-Model::sptrModel Model::createModel() {
-	if (model_ == nullptr) {
-		model_ = Model::sptrModel(new Model());
+	const Matrix<Field>& matr = this->left_->matrix();
+	if (matr.getRow() != matr.getCol()) {
+		error = "Semantic error: can not find the characteristic polynomial of a non square matrix";
+		return;
 	}
 
-	return model_;
+	this->is_ans_number_ = false;
+	this->ans_matrix_ = characteristicPolynomial(matr);
+	return;
 }
 
-Answer Model::processQuery(const Query& query) {
-	if (query.type_of_query_ == init) {
+template <typename Field>
+void Eigenvalues<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_) {
+		error = "Syntax error: not enough operands to find eigenvalues";
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
+		error = "Semantic error: can not find eigenvalues of a number";
+		return;
+	}
+
+	const Matrix<Field>& matr = this->left_->matrix();
+	if (matr.getRow() != matr.getCol()) {
+		error = "Semantic error: can not find eigenvalues of a non square matrix";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	eigenvalues(matr, this->ans_matrix_, error);
+	return;
+}
+
+template <typename Field>
+void SingularValues<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_) {
+		error = "Syntax error: not enough operands to find singular values";
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
+		error = "Semantic error: can not find singular values of a number";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	singularValues(this->left_->matrix(), this->ans_matrix_, error);
+	return;
+}
+
+template <typename Field>
+void PseudoInverse<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_) {
+		error = "Syntax error: not enough operands to find the pseudo-inverse";
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
+		error = "Semantic error: can not take a pseudo-inverse of a number";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	pseudoInverse(this->left_->matrix(), this->ans_matrix_, error);
+	return;
+}
+
+// exp, log and sqrt share the checks of their operand
+template <typename Field>
+static void calcMatrixFunction(Token<Field>& token, matrixFunctionType function, const std::string& name, std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!token.left_) {
+		error = "Syntax error: not enough operands to take " + name;
+		return;
+	}
+
+	if (token.left_->is_ans_number_) {
+		error = "Semantic error: can not take " + name + " of a number";
+		return;
+	}
+
+	const Matrix<Field>& matr = token.left_->matrix();
+	if (matr.getRow() != matr.getCol()) {
+		error = "Semantic error: can not take " + name + " of a non square matrix";
+		return;
+	}
+
+	token.is_ans_number_ = false;
+	matrixFunction(matr, function, token.ans_matrix_, error);
+}
+
+template <typename Field>
+void Exponential<Field>::calc(std::string& error) {
+	calcMatrixFunction(*this, exponentialFunction, "the exponential", error);
+}
+
+template <typename Field>
+void Logarithm<Field>::calc(std::string& error) {
+	calcMatrixFunction(*this, logarithmFunction, "the logarithm", error);
+}
+
+template <typename Field>
+void SquareRoot<Field>::calc(std::string& error) {
+	calcMatrixFunction(*this, squareRootFunction, "the square root", error);
+}
+
+template <typename Field>
+void Comma<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_ || !this->right_) {
+		error = "Syntax error: missing argument";
+		return;
+	}
+
+	return;
+}
+
+// arguments of a function in order, the commas between them chain to the left
+template <typename Field>
+static std::vector<const Token<Field>*> getArguments(const Token<Field>& function) {
+	std::vector<const Token<Field>*> arguments;
+	const Token<Field>* node = function.left_;
+	while (node->kind_ == commaNode) {
+		arguments.push_back(node->right_);
+		node = node->left_;
+	}
+	arguments.push_back(node);
+	std::reverse(arguments.begin(), arguments.end());
+
+	return arguments;
+}
+
+// nonnegative integer argument of a function
+template <typename Field>
+static bool getCountArgument(const Token<Field>& argument, const std::string& name, size_t& count, std::string& error) {
+	long long value;
+	if (!argument.is_ans_number_ || !getInteger(argument, value) || value < 0) {
+		error = "Semantic error: " + name + " must be a nonnegative integer";
+		return false;
+	}
+	count = static_cast<size_t>(value);
+
+	return true;
+}
+
+template <typename Field>
+void Kronecker<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_) {
+		error = "Syntax error: not enough operands for the kronecker product";
+		return;
+	}
+
+	// factors of nested products are concatenated
+	std::vector<Matrix<Field>> factors;
+	for (const Token<Field>* argument : getArguments(*this)) {
+		if (argument->is_ans_number_) {
+			error = "Semantic error: can not take the kronecker product of a number";
+			return;
+		}
+
+		if (argument->isKronecker()) {
+			factors.insert(factors.end(), argument->ans_factors_.begin(), argument->ans_factors_.end());
+		}
+		else {
+			factors.push_back(argument->matrix());
+		}
+	}
+
+	size_t rows;
+	size_t cols;
+	if (!kroneckerSize(factors, rows, cols)) {
+		error = "Semantic error: kronecker product is too large";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	this->ans_factors_ = factors;
+}
+
+template <typename Field>
+void Hadamard<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_ || !this->right_) {
+		error = "Syntax error: not enough operands for the entrywise product";
+		return;
+	}
+
+	Token<Field>& lhs = *this->left_;
+	Token<Field>& rhs = *this->right_;
+
+	// a number scales the matrix as in an ordinary product
+	if (lhs.is_ans_number_ || rhs.is_ans_number_) {
+		if (lhs.isKronecker() || rhs.isKronecker()) {
+			multiplyKronecker(lhs, rhs, *this, error);
+			return;
+		}
+
+		this->is_ans_number_ = lhs.is_ans_number_ && rhs.is_ans_number_;
+		if (this->is_ans_number_) {
+			this->ans_number_ = lhs.ans_number_ * rhs.ans_number_;
+		}
+		else if (lhs.is_ans_number_) {
+			this->ans_matrix_ = lhs.ans_number_ * rhs.matrix();
+		}
+		else {
+			this->ans_matrix_ = rhs.ans_number_ * lhs.matrix();
+		}
+		return;
+	}
+
+	size_t lhs_rows;
+	size_t lhs_cols;
+	size_t rhs_rows;
+	size_t rhs_cols;
+	getDimensions(lhs, lhs_rows, lhs_cols);
+	getDimensions(rhs, rhs_rows, rhs_cols);
+	if (lhs_rows != rhs_rows || lhs_cols != rhs_cols) {
+		error = "Semantic error: can not take the entrywise product of matrices of different dimensions";
+		return;
+	}
+
+	// (A x B) .* (C x D) = (A .* C) x (B .* D) when the factors have the same sizes
+	this->is_ans_number_ = false;
+	if (lhs.isKronecker() && rhs.isKronecker() && lhs.ans_factors_.size() == rhs.ans_factors_.size()) {
+		const std::vector<Matrix<Field>>& lhs_factors = lhs.ans_factors_;
+		const std::vector<Matrix<Field>>& rhs_factors = rhs.ans_factors_;
+		bool is_matching = true;
+		for (size_t t = 0; t < lhs_factors.size(); ++t) {
+			is_matching = is_matching && lhs_factors[t].getRow() == rhs_factors[t].getRow() &&
+						  lhs_factors[t].getCol() == rhs_factors[t].getCol();
+		}
+
+		if (is_matching) {
+			for (size_t t = 0; t < lhs_factors.size(); ++t) {
+				this->ans_factors_.push_back(hadamardProduct(lhs_factors[t], rhs_factors[t]));
+			}
+			return;
+		}
+	}
+
+	materializeKronecker(&lhs, error);
+	materializeKronecker(&rhs, error);
+	if (error != "") {
+		return;
+	}
+
+	this->ans_matrix_ = hadamardProduct(lhs.matrix(), rhs.matrix());
+}
+
+template <typename Field>
+void Slice<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_) {
+		error = "Syntax error: not enough operands to slice";
+		return;
+	}
+
+	if (this->left_->is_ans_number_) {
+		error = "Semantic error: can not slice a number";
+		return;
+	}
+
+	size_t rows;
+	size_t cols;
+	getDimensions(*this->left_, rows, cols);
+	size_t row_first = rows_.is_all_ ? 1 : rows_.first_;
+	size_t row_last = rows_.is_all_ ? rows : rows_.last_;
+	size_t col_first = cols_.is_all_ ? 1 : cols_.first_;
+	size_t col_last = cols_.is_all_ ? cols : cols_.last_;
+	if (row_first > row_last || row_last > rows || col_first > col_last || col_last > cols) {
+		error = "Semantic error: slice is out of the matrix";
+		return;
+	}
+
+	makeView(*this->left_);
+	std::vector<matrixView<Field>> views = sliceViews(this->left_->ans_views_, row_first - 1, row_last, col_first - 1, col_last);
+
+	// an entry given by two indices is a number
+	if (rows_.is_index_ && cols_.is_index_) {
+		this->is_ans_number_ = true;
+		this->ans_number_ = views[0].get(0, 0);
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	this->ans_views_ = views;
+}
+
+template <typename Field>
+void Concatenation<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	if (!this->left_ || !this->right_) {
+		error = "Syntax error: not enough blocks to concatenate";
+		return;
+	}
+
+	// numbers are taken as 1 x 1 blocks
+	size_t rows1 = 1;
+	size_t cols1 = 1;
+	size_t rows2 = 1;
+	size_t cols2 = 1;
+	if (!this->left_->is_ans_number_) {
+		getDimensions(*this->left_, rows1, cols1);
+	}
+	if (!this->right_->is_ans_number_) {
+		getDimensions(*this->right_, rows2, cols2);
+	}
+
+	if (is_vertical_ && cols1 != cols2) {
+		error = "Semantic error: can not put blocks with different numbers of columns one above the other";
+		return;
+	}
+	if (!is_vertical_ && rows1 != rows2) {
+		error = "Semantic error: can not put blocks with different numbers of rows side by side";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	this->ans_views_ = concatenateViews(getBlockViews(*this->left_), getBlockViews(*this->right_), is_vertical_);
+}
+
+template <typename Field>
+void Solve<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	std::vector<const Token<Field>*> arguments = getArguments(*this);
+	const Token<Field>& matrix = *arguments[0];
+	const Token<Field>& rhs = *arguments[1];
+	if (matrix.is_ans_number_ || rhs.is_ans_number_) {
+		error = "Semantic error: solve takes a matrix and a right-hand side";
+		return;
+	}
+
+	if (matrix.matrix().getRow() != matrix.matrix().getCol()) {
+		error = "Semantic error: can not solve a system with a non square matrix";
+		return;
+	}
+
+	if (matrix.matrix().getRow() != rhs.matrix().getRow()) {
+		error = "Semantic error: right-hand side has a wrong number of rows";
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	solveSystem(matrix.matrix(), rhs.matrix(), options_, this->ans_matrix_, iterations_, residual_, error);
+	return;
+}
+
+// rankest(A), rankest(A, tolerance) or rankest(A, tolerance, oversampling)
+template <typename Field>
+void ApproximateRank<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	std::vector<const Token<Field>*> arguments = getArguments(*this);
+	if (arguments[0]->is_ans_number_) {
+		error = "Semantic error: can not estimate the rank of a number";
+		return;
+	}
+
+	double tolerance = DEFAULT_SKETCH_TOLERANCE;
+	size_t oversampling = DEFAULT_OVERSAMPLING;
+	if (arguments.size() > 1) {
+		if (!arguments[1]->is_ans_number_) {
+			error = "Semantic error: tolerance must be a number";
+			return;
+		}
+		tolerance = fieldTraits<Field>::magnitude(arguments[1]->ans_number_);
+	}
+	if (arguments.size() > 2 && !getCountArgument(*arguments[2], "oversampling", oversampling, error)) {
+		return;
+	}
+
+	size_t rank;
+	if (approximateRank(arguments[0]->matrix(), tolerance, oversampling, rank, error)) {
+		this->is_ans_number_ = true;
+		this->ans_number_ = Field(static_cast<long long>(rank));
+	}
+	return;
+}
+
+// svdk(A, count) or svdk(A, count, oversampling)
+template <typename Field>
+void LeadingSingularValues<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	std::vector<const Token<Field>*> arguments = getArguments(*this);
+	const Token<Field>& matrix = *arguments[0];
+	if (matrix.is_ans_number_) {
+		error = "Semantic error: can not find singular values of a number";
+		return;
+	}
+
+	size_t count;
+	size_t oversampling = DEFAULT_OVERSAMPLING;
+	if (!getCountArgument(*arguments[1], "number of singular values", count, error)) {
+		return;
+	}
+	if (count == 0 || count > std::min(matrix.matrix().getRow(), matrix.matrix().getCol())) {
+		error = "Semantic error: matrix does not have that many singular values";
+		return;
+	}
+	if (arguments.size() > 2 && !getCountArgument(*arguments[2], "oversampling", oversampling, error)) {
+		return;
+	}
+
+	this->is_ans_number_ = false;
+	leadingSingularValues(matrix.matrix(), count, oversampling, this->ans_matrix_, error);
+	return;
+}
+
+// normest(A) or normest(A, tolerance)
+template <typename Field>
+void NormEstimate<Field>::calc(std::string& error) {
+	if (error != "") {
+		return;
+	}
+
+	std::vector<const Token<Field>*> arguments = getArguments(*this);
+	if (arguments[0]->is_ans_number_) {
+		error = "Semantic error: can not estimate the norm of a number";
+		return;
+	}
+
+	double tolerance = DEFAULT_SKETCH_TOLERANCE;
+	if (arguments.size() > 1) {
+		if (!arguments[1]->is_ans_number_) {
+			error = "Semantic error: tolerance must be a number";
+			return;
+		}
+		tolerance = fieldTraits<Field>::magnitude(arguments[1]->ans_number_);
+	}
+
+	this->is_ans_number_ = true;
+	normEstimate(arguments[0]->matrix(), tolerance, this->ans_number_, error);
+	return;
+}
+
+// instantiate the tokens once for every field
+
+#define INSTANTIATE_TOKENS(Field) \
+	template struct Token<Field>; \
+	template struct Var<Field>; \
+	template struct Number<Field>; \
+	template struct Plus<Field>; \
+	template struct Minus<Field>; \
+	template struct Multiply<Field>; \
+	template struct Divide<Field>; \
+	template struct Power<Field>; \
+	template struct Trace<Field>; \
+	template struct Determinant<Field>; \
+	template struct Rank<Field>; \
+	template struct Transpose<Field>; \
+	template struct Inverse<Field>; \
+	template struct CharacteristicPolynomial<Field>; \
+	template struct Eigenvalues<Field>; \
+	template struct SingularValues<Field>; \
+	template struct PseudoInverse<Field>; \
+	template struct ApproximateRank<Field>; \
+	template struct LeadingSingularValues<Field>; \
+	template struct NormEstimate<Field>; \
+	template struct Exponential<Field>; \
+	template struct Logarithm<Field>; \
+	template struct SquareRoot<Field>; \
+	template struct Kronecker<Field>; \
+	template struct Hadamard<Field>; \
+	template struct Slice<Field>; \
+	template struct Concatenation<Field>; \
+	template struct Comma<Field>; \
+	template struct Solve<Field>;
+
+INSTANTIATE_TOKENS(float)
+INSTANTIATE_TOKENS(double)
+INSTANTIATE_TOKENS(complexNumber)
+INSTANTIATE_TOKENS(rationalNumber)
+INSTANTIATE_TOKENS(residue<0>)
+
+// initialize static member
+
+Model::sptrModel Model::model_ = nullptr;
+
+// create a single object of the class
+
+Model::sptrModel Model::createModel() {
+	if (model_ == nullptr) {
+		model_ = Model::sptrModel(new Model());
+	}
+
+	return model_;
+}
+
+Answer Model::processQuery(const Query& query) {
+	if (query.type_of_query_ == init) {
 		return handleInitQuery(query);
 	}
-	else if (query.type_of_query_ == solveEq) {
-		return handleSolveEqQuery(query);
+	else if (query.type_of_query_ == solveEq) {
+		return handleSolveEqQuery(query);
+	}
+	return handleCalcExpQuery(query);
+}
+
+// private constructor for singleton pattern
+
+Model::Model()
+{
+	variables_.resize(26);
+	versions_.resize(26);
+}
+
+// query handlers
+
+Answer Model::handleInitQuery(const Query& query) {
+	Answer ans;
+
+	if (query.is_ans_used_) {
+		if (ans_type_ == "") {
+			ans.error_message_ = "Cannot initialize variable with an empty answer";
+			return ans;
+		}
+
+		size_t modulus = 0;
+		fieldType field = getFieldType(ans_type_, modulus, ans.error_message_);
+		if (field == realField) {
+			storeVariableFromAnswer<float>(query.variable_used_, ans.error_message_);
+		}
+		else if (field == doubleField) {
+			storeVariableFromAnswer<double>(query.variable_used_, ans.error_message_);
+		}
+		else if (field == complexField) {
+			storeVariableFromAnswer<complexNumber>(query.variable_used_, ans.error_message_);
+		}
+		else if (field == rationalField) {
+			storeVariableFromAnswer<rationalNumber>(query.variable_used_, ans.error_message_);
+		}
+		else if (field == moduloField) {
+			modulusScope scope(modulus);
+			storeVariableFromAnswer<residue<0>>(query.variable_used_, ans.error_message_);
+		}
+
+		if (ans.error_message_ == "") {
+			++versions_[query.variable_used_];
+			ans.recomputed_ = recomputeDependents(query.variable_used_);
+		}
+		return ans;
+	}
+
+	// validate the cells in the chosen type, the variable keeps its text so that
+	// it can be used later in any other type
+	size_t modulus = 0;
+	fieldType field = getFieldType(query.type_, modulus, ans.error_message_);
+	if (field == realField) {
+		Matrix<float> matrix;
+		isMatrixValid(query.matrix_, matrix, ans.error_message_);
+	}
+	else if (field == doubleField) {
+		Matrix<double> matrix;
+		isMatrixValid(query.matrix_, matrix, ans.error_message_);
+	}
+	else if (field == complexField) {
+		Matrix<complexNumber> matrix;
+		isMatrixValid(query.matrix_, matrix, ans.error_message_);
+	}
+	else if (field == rationalField) {
+		Matrix<rationalNumber> matrix;
+		isMatrixValid(query.matrix_, matrix, ans.error_message_);
+	}
+	else if (field == moduloField) {
+		modulusScope scope(modulus);
+		Matrix<residue<0>> matrix;
+		isMatrixValid(query.matrix_, matrix, ans.error_message_);
+	}
+
+	if (ans.error_message_ != "") {
+		return ans;
+	}
+
+	variables_[query.variable_used_] = query.matrix_;
+	++versions_[query.variable_used_];
+	unparseVariables();
+	ans.recomputed_ = recomputeDependents(query.variable_used_);
+
+	return ans;
+}
+
+Answer Model::handleSolveEqQuery(const Query& query) {
+	Answer ans;
+
+	Matrix<double> system;
+	isMatrixValid(query.matrix_, system, ans.error_message_);
+
+	if (ans.error_message_ != "") {
+		return ans;
+	}
+	system_.assign(system.getRow(), std::vector<float>(system.getCol()));
+	for (size_t i = 0; i < system.getRow(); ++i) {
+		for (size_t j = 0; j < system.getCol(); ++j) {
+			system_[i][j] = system[i][j];
+		}
+	}
+	bool is_square = system.getRow() + 1 == system.getCol();
+
+	// iterative methods for square systems when the user picked one
+	krylovOptions options;
+	if (!getSolveOptions(query, options, ans.error_message_)) {
+		return ans;
+	}
+	if (options.method_ != directMethod) {
+		if (!is_square) {
+			ans.error_message_ = "Semantic error: iterative methods need as many equations as unknowns";
+			return ans;
+		}
+
+		size_t n = system.getRow();
+		Matrix<double> matrix(n, n);
+		std::vector<double> rhs(n);
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = 0; j < n; ++j) {
+				matrix[i][j] = system[i][j];
+			}
+			rhs[i] = system[i][n];
+		}
+
+		// the compressed form pays off once most of the matrix is zero
+		std::vector<double> solution;
+		sparseMatrix compressed(matrix);
+		bool is_solved = compressed.density() <= KRYLOV_SPARSE_DENSITY
+						 ? krylovSolve(compressed, rhs, options, solution, ans.iterations_, ans.residual_, ans.error_message_)
+						 : krylovSolve(matrix, rhs, options, solution, ans.iterations_, ans.residual_, ans.error_message_);
+		if (!is_solved) {
+			return ans;
+		}
+
+		ans.ans_matrix_.assign(n, std::vector<float>(n + 1, 0));
+		for (size_t i = 0; i < n; ++i) {
+			ans.ans_matrix_[i][i] = 1;
+			ans.ans_matrix_[i][n] = solution[i];
+		}
+
+		return ans;
+	}
+
+	// square systems with exact coefficients get the exact solution of the multi-modular engine
+	std::vector<std::vector<long long>> exact_system;
+	if (is_square && getExactSystem(query.matrix_, exact_system)) {
+		std::vector<std::pair<bigInteger, bigInteger>> solution;
+		std::string error;
+		if (modularSolve(exact_system, solution, error)) {
+			size_t n = solution.size();
+			ans.ans_matrix_.assign(n, std::vector<float>(n + 1, 0));
+			for (size_t i = 0; i < n; ++i) {
+				ans.ans_matrix_[i][i] = 1;
+				ans.ans_matrix_[i][n] = solution[i].first.toDouble() / solution[i].second.toDouble();
+			}
+
+			return ans;
+		}
+	}
+
+	// the other square systems are factored in float and refined in double
+	std::vector<double> refined;
+	if (is_square && refinedSolve(system, refined, ans.refinement_steps_, ans.residual_, ans.error_message_)) {
+		size_t n = refined.size();
+		ans.ans_matrix_.assign(n, std::vector<float>(n + 1, 0));
+		for (size_t i = 0; i < n; ++i) {
+			ans.ans_matrix_[i][i] = 1;
+			ans.ans_matrix_[i][n] = refined[i];
+		}
+
+		return ans;
+	}
+	if (ans.error_message_ != "") {
+		return ans;
+	}
+	ans.refinement_steps_ = 0;
+	ans.residual_ = 0;
+
+	// overdetermined systems of full column rank get their least squares solution
+	std::vector<double> fitted;
+	if (system.getRow() + 1 > system.getCol() && leastSquaresSolve(system, fitted, ans.residual_, ans.error_message_)) {
+		size_t n = fitted.size();
+		ans.is_least_squares_ = true;
+		ans.ans_matrix_.assign(n, std::vector<float>(n + 1, 0));
+		for (size_t i = 0; i < n; ++i) {
+			ans.ans_matrix_[i][i] = 1;
+			ans.ans_matrix_[i][n] = fitted[i];
+		}
+
+		return ans;
+	}
+	if (ans.error_message_ != "") {
+		return ans;
+	}
+
+	Matrix<float> equation(system_);
+	ans.ans_matrix_ = equation.getReducedRowEchelonForm().getMatrix();
+
+	for (int i = 0; i < ans.ans_matrix_.size(); ++i) {
+		for (int j = 0; j < ans.ans_matrix_[i].size(); ++j) {
+			if (ans.ans_matrix_[i][j] == -0.0) {
+				ans.ans_matrix_[i][j] = 0;
+			}
+		}
+	}
+
+	return ans;
+}
+
+Answer Model::handleCalcExpQuery(const Query& query) {
+	Answer ans;
+	std::string exp = query.exp_;
+	std::vector<lexToken> tokens;
+	if (!splitIntoTokens(tokens, exp)) {
+		ans.error_message_ = "Invalid syntax: brackets";
+
+		return ans;
+	}
+
+	if (!getSolveOptions(query, solve_options_, ans.error_message_)) {
+		return ans;
+	}
+
+	ans = evaluate(tokens, query.type_, true);
+	ans.exp_ = exp;
+	keepLiveExpression(query, tokens);
+
+	return ans;
+}
+
+// pick the instantiation of the evaluator for the type of the query
+Answer Model::evaluate(const std::vector<lexToken>& tokens, const std::string& type, bool is_ans_kept) {
+	Answer ans;
+
+	size_t modulus = 0;
+	fieldType field = getFieldType(type, modulus, ans.error_message_);
+	if (field == realField) {
+		return calcExpression<float>(tokens, type, is_ans_kept);
+	}
+	if (field == doubleField) {
+		return calcExpression<double>(tokens, type, is_ans_kept);
+	}
+	if (field == complexField) {
+		return calcExpression<complexNumber>(tokens, type, is_ans_kept);
+	}
+	if (field == rationalField) {
+		return calcExpression<rationalNumber>(tokens, type, is_ans_kept);
+	}
+	if (field == moduloField) {
+		modulusScope scope(modulus);
+		return calcExpression<residue<0>>(tokens, type, is_ans_kept);
+	}
+
+	return ans;
+}
+
+// live expressions
+
+// remember the expression with the variables it reads, an expression which reads ans
+// is not kept, since the answer changes with every query
+void Model::keepLiveExpression(const Query& query, const std::vector<lexToken>& tokens) {
+	liveExpression expression;
+	expression.exp_ = query.exp_;
+	expression.type_ = query.type_;
+	expression.solve_options_ = solve_options_;
+	expression.reads_.assign(variables_.size(), false);
+	for (const lexToken& token : tokens) {
+		if (token.text_ == "ans") {
+			return;
+		}
+		if (token.text_[0] >= 'A' && token.text_[0] <= 'Z') {
+			expression.reads_[token.text_[0] - 'A'] = true;
+		}
+	}
+
+	for (size_t i = 0; i < live_.size(); ++i) {
+		if (live_[i].exp_ == expression.exp_ && live_[i].type_ == expression.type_) {
+			live_.erase(live_.begin() + i);
+			break;
+		}
+	}
+	if (live_.size() == MAX_LIVE_EXPRESSIONS) {
+		live_.erase(live_.begin());
+	}
+	live_.push_back(expression);
+}
+
+// evaluate again the expressions which read the variable, subtrees which do not read it
+// are found in the cache; the answer of the last query is left as it is
+std::vector<Answer> Model::recomputeDependents(int variable) {
+	std::vector<Answer> answers;
+	krylovOptions options = solve_options_;
+	for (const liveExpression& expression : live_) {
+		if (!expression.reads_[variable]) {
+			continue;
+		}
+
+		// the tokens point into the text, which is kept instead of them
+		std::vector<lexToken> tokens;
+		splitIntoTokens(tokens, expression.exp_);
+		solve_options_ = expression.solve_options_;
+		Answer ans = evaluate(tokens, expression.type_, false);
+		ans.exp_ = expression.exp_;
+		answers.push_back(ans);
+	}
+	solve_options_ = options;
+
+	return answers;
+}
+
+bool Model::getSolveOptions(const Query& query, krylovOptions& options, std::string& error) {
+	options = krylovOptions();
+	if (!parseSolveMethod(query.solve_method_, options.method_)) {
+		error = "Semantic error: unknown solver";
+		return false;
+	}
+	if (!parsePreconditioner(query.preconditioner_, options.preconditioner_)) {
+		error = "Semantic error: unknown preconditioner";
+		return false;
+	}
+
+	return true;
+}
+
+// field of the query type: "real", "double", "complex", "rational" or "modulo p"
+fieldType Model::getFieldType(const std::string& type, size_t& modulus, std::string& error) {
+	if (type == "real" || type == "") {
+		return realField;
+	}
+	if (type == "double") {
+		return doubleField;
+	}
+	if (type == "complex") {
+		return complexField;
+	}
+	if (type == "rational") {
+		return rationalField;
+	}
+
+	const std::string prefix = "modulo ";
+	if (type.compare(0, prefix.length(), prefix) == 0) {
+		modulus = 0;
+		for (size_t i = prefix.length(); i < type.length(); ++i) {
+			if (type[i] < '0' || type[i] > '9' || modulus > MAX_MODULUS) {
+				error = "Semantic error: wrong modulus";
+				return noField;
+			}
+			modulus = modulus * 10 + (type[i] - '0');
+		}
+
+		if (modulus > MAX_MODULUS || !isPrimeNumber(modulus)) {
+			error = "Semantic error: modulus must be a prime number below 2^31";
+			return noField;
+		}
+
+		return moduloField;
+	}
+
+	error = "Semantic error: unknown type";
+	return noField;
+}
+
+// evaluate the expression in one field
+template <typename Field>
+Answer Model::calcExpression(const std::vector<lexToken>& tokens, const std::string& type, bool is_ans_kept) {
+	Answer ans;
+
+	std::shared_ptr<compiledProgram<Field>> program = getProgram<Field>(tokens, type, ans.error_message_);
+	if (ans.error_message_ != "") {
+		return ans;
+	}
+	std::cout << "---------------" << std::endl;
+
+	resultCache<Field>& cache = getStore<Field>(type).cache_;
+	size_t hits = cache.hits();
+	size_t misses = cache.misses();
+	runProgram(*program, cache, ans.error_message_);
+	ans.cache_hits_ = cache.hits() - hits;
+	ans.cache_misses_ = cache.misses() - misses;
+	ans.rewrites_ = program->rewrites_;
+	ans.cubic_before_ = program->cubic_before_;
+	ans.cubic_after_ = program->cubic_after_;
+	// the iterations of all the solve operators computed for this query and their worst residual
+	for (const programStep<Field>& step : program->steps_) {
+		ans.in_place_ += step.node_->is_in_place_ ? 1 : 0;
+		if (step.node_->kind_ == solveNode) {
+			const Solve<Field>& solve = static_cast<const Solve<Field>&>(*step.node_);
+			ans.iterations_ += solve.iterations_;
+			ans.residual_ = std::max(ans.residual_, solve.residual_);
+		}
+	}
+
+	Token<Field>* calc_tree = program->steps_.back().node_;
+	materializeKronecker(calc_tree, ans.error_message_);
+	materializeViews(calc_tree);
+
+	if (ans.error_message_ == "") {
+		storeAnswer(*calc_tree, type, ans, is_ans_kept);
+	}
+
+	return ans;
+}
+
+// values converted into one type, every type keeps its own so switching between them keeps the caches
+template <typename Field>
+fieldStore<Field>& Model::getStore(const std::string& type) {
+	fieldStore<Field>& store = std::get<std::map<std::string, fieldStore<Field>>>(stores_)[type];
+	if (store.variables_.size() != variables_.size()) {
+		store.variables_.assign(variables_.size(), nullptr);
+		store.is_parsed_.assign(variables_.size(), false);
+	}
+
+	return store;
+}
+
+// variables are parsed again in every type after one of them changes
+void Model::unparseVariables() {
+	std::apply([&](auto&... stores) {
+		auto unparse = [&](auto& by_type) {
+			for (auto& [type, store] : by_type) {
+				store.is_parsed_.assign(variables_.size(), false);
+			}
+		};
+		(unparse(stores), ...);
+	}, stores_);
+}
+
+template <typename Field>
+bool Model::getVariable(int variable, const std::string& type, std::shared_ptr<const Matrix<Field>>& matrix, std::string& error) {
+	fieldStore<Field>& store = getStore<Field>(type);
+	if (!store.is_parsed_[variable]) {
+		if (variables_[variable].empty()) {
+			error = "Semantic error: variable is not initialized";
+			return false;
+		}
+		Matrix<Field> parsed;
+		if (!isMatrixValid(variables_[variable], parsed, error)) {
+			return false;
+		}
+		store.variables_[variable] = std::make_shared<const Matrix<Field>>(std::move(parsed));
+		store.is_parsed_[variable] = true;
+	}
+
+	matrix = store.variables_[variable];
+
+	return true;
+}
+
+// number of a variable with its version in the table of the field, of the answer if variable is -1
+template <typename Field>
+size_t Model::getVariableKey(int variable, const std::string& type) {
+	std::string name = variable == -1 ? "ans#" + std::to_string(ans_version_)
+									  : std::string(1, 'A' + variable) + "#" + std::to_string(versions_[variable]);
+
+	return getStore<Field>(type).subtrees_.getKey(name);
+}
+
+// keep the answer of the last expression if is_kept and fill in the answer for the view
+template <typename Field>
+void Model::storeAnswer(Token<Field>& tree, const std::string& type, Answer& ans, bool is_kept) {
+	// the answer takes over the storage of the root, or shares it with a variable
+	makeView(tree);
+	if (is_kept) {
+		fieldStore<Field>& store = getStore<Field>(type);
+		store.is_ans_number_ = tree.is_ans_number_;
+		store.ans_number_ = tree.ans_number_;
+		store.ans_matrix_ = tree.is_ans_number_ ? nullptr : tree.ans_views_[0].source_;
+		ans_type_ = type;
+		++ans_version_;
+	}
+	const Matrix<Field>& matrix = tree.matrix();
+
+	ans.type_ = type;
+	ans.is_ans_number_ = tree.is_ans_number_;
+
+	if constexpr (std::is_floating_point_v<Field>) {
+		// snap values which are almost integers
+		auto snap = [](Field value) -> float {
+			Field rounded = std::round(value);
+			return std::abs(value - rounded) < 0.00001 ? rounded : value;
+		};
+
+		if (tree.is_ans_number_) {
+			ans.ans_float_ = tree.ans_number_;
+		}
+		else {
+			ans.ans_matrix_.assign(matrix.getRow(), std::vector<float>(matrix.getCol()));
+			for (size_t i = 0; i < matrix.getRow(); ++i) {
+				for (size_t j = 0; j < matrix.getCol(); ++j) {
+					ans.ans_matrix_[i][j] = snap(matrix[i][j]);
+				}
+			}
+		}
+	}
+
+	if (tree.is_ans_number_) {
+		ans.ans_string_ = fieldTraits<Field>::toString(tree.ans_number_);
+	}
+	else {
+		ans.ans_matrix_string_.assign(matrix.getRow(), std::vector<std::string>(matrix.getCol()));
+		for (size_t i = 0; i < matrix.getRow(); ++i) {
+			for (size_t j = 0; j < matrix.getCol(); ++j) {
+				ans.ans_matrix_string_[i][j] = fieldTraits<Field>::toString(matrix[i][j]);
+			}
+		}
+	}
+}
+
+// initialize a variable with the last answer
+template <typename Field>
+void Model::storeVariableFromAnswer(int variable, std::string& error) {
+	fieldStore<Field>& store = getStore<Field>(ans_type_);
+	if (store.is_ans_number_) {
+		error = "Cannot initialize variable with number";
+		return;
+	}
+
+	const Matrix<Field>& matrix = *store.ans_matrix_;
+	std::vector<std::vector<std::string>> text(matrix.getRow(), std::vector<std::string>(matrix.getCol()));
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			text[i][j] = fieldTraits<Field>::toString(matrix[i][j]);
+		}
+	}
+
+	variables_[variable] = text;
+	unparseVariables();
+	store.variables_[variable] = store.ans_matrix_;
+	store.is_parsed_[variable] = true;
+}
+
+// checkers
+
+// check if cells really represent numbers of the field
+template <typename Field>
+bool Model::isMatrixValid(const std::vector<std::vector<std::string>>& matrix, Matrix<Field>& result, std::string& error) {
+	result = Matrix<Field>(matrix.size(), matrix[0].size());
+
+	for (size_t i = 0; i < matrix.size(); ++i) {
+		for (size_t j = 0; j < matrix[i].size(); ++j) {
+			if (!fieldTraits<Field>::parse(matrix[i][j], result[i][j])) {
+				error = "Syntax error: the cells do not represent numbers of the chosen type";
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// parse a cell as an exact fraction, false if it does not fit into 64 bits
+bool Model::getExactCell(const std::string& cell, long long& numerator, long long& denominator) {
+	numerator = 0;
+	denominator = 1;
+	bool is_negative = false;
+	bool after_point = false;
+	bool after_slash = false;
+	long long divisor = 0;
+	const long long limit = 1e15;
+
+	for (size_t i = 0; i < cell.length(); ++i) {
+		long long& cur = after_slash ? divisor : numerator;
+		if (cell[i] == '-' && i == 0) {
+			is_negative = true;
+		}
+		else if (cell[i] == '.' && !after_point) {
+			after_point = true;
+		}
+		else if (cell[i] == '/' && !after_slash) {
+			after_slash = true;
+			after_point = false;
+		}
+		else if (cell[i] >= '0' && cell[i] <= '9') {
+			cur = cur * 10 + (cell[i] - '0');
+			if (after_point) {
+				if (after_slash) {
+					numerator *= 10;
+				}
+				else {
+					denominator *= 10;
+				}
+			}
+			if (cur > limit || numerator > limit || denominator > limit) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+
+	if (after_slash) {
+		if (divisor == 0) {
+			return false;
+		}
+		denominator *= divisor;
+		if (denominator > limit) {
+			return false;
+		}
+	}
+
+	if (is_negative) {
+		numerator = -numerator;
+	}
+
+	return true;
+}
+
+// turn an exact system into integers by clearing denominators row by row
+bool Model::getExactSystem(const std::vector<std::vector<std::string>>& matrix, std::vector<std::vector<long long>>& system) {
+	system.resize(matrix.size());
+	for (size_t i = 0; i < matrix.size(); ++i) {
+		std::vector<long long> numerators(matrix[i].size());
+		std::vector<long long> denominators(matrix[i].size());
+		long long common = 1;
+		for (size_t j = 0; j < matrix[i].size(); ++j) {
+			if (!getExactCell(matrix[i][j], numerators[j], denominators[j])) {
+				return false;
+			}
+			long long divisor = std::gcd(common, denominators[j]);
+			if (__builtin_mul_overflow(common / divisor, denominators[j], &common)) {
+				return false;
+			}
+		}
+
+		system[i].resize(matrix[i].size());
+		for (size_t j = 0; j < matrix[i].size(); ++j) {
+			if (__builtin_mul_overflow(numerators[j], common / denominators[j], &system[i][j])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Model::isDigit(char symbol) {
+	return symbol == '.' || (symbol >= '0' && symbol <= '9');
+}
+
+// ":" for all the rows or columns, "a" or "a:b" for positive integers a and b
+bool Model::isSliceRange(const std::vector<lexToken>& tokens, int start, int end, sliceRange& range, std::string& error) {
+	range = sliceRange();
+	if (end - start == 1 && tokens[start].text_ == ":") {
+		return true;
+	}
+
+	auto getIndex = [](std::string_view token, size_t& index) {
+		if (token.empty() || token.length() > 9 || token.find_first_not_of("0123456789") != std::string_view::npos) {
+			return false;
+		}
+		index = 0;
+		for (char digit : token) {
+			index = index * 10 + (digit - '0');
+		}
+		return index > 0;
+	};
+
+	bool is_valid = false;
+	if (end - start == 1) {
+		is_valid = getIndex(tokens[start].text_, range.first_);
+		range.is_index_ = true;
+		range.last_ = range.first_;
+	}
+	else if (end - start == 3 && tokens[start + 1].text_ == ":") {
+		is_valid = getIndex(tokens[start].text_, range.first_) && getIndex(tokens[start + 2].text_, range.last_);
+	}
+
+	if (!is_valid) {
+		error = "Syntax error: slice bounds must be positive integers";
+		return false;
+	}
+	range.is_all_ = false;
+
+	return true;
+}
+
+// how many arguments separated by commas a function takes
+void Model::getArgumentsCount(nodeKind function, size_t& least, size_t& most) {
+	least = 1;
+	most = 1;
+	switch (function) {
+	case solveNode:
+	case kronNode:
+		least = 2;
+		most = 2;
+		break;
+	case rankestNode:
+		most = 3;
+		break;
+	case svdkNode:
+		least = 2;
+		most = 3;
+		break;
+	case normestNode:
+		most = 2;
+		break;
+	default:
+		break;
+	}
+}
+
+// split the expression into tokens in one pass, the longest text which is still the beginning of
+// an operator is taken, so "tr" of "trans" and "svd" of "svdk" are not cut off; every token gets
+// its kind, its priority and its matching bracket as it is read; false if the brackets do not match
+bool Model::splitIntoTokens(std::vector<lexToken>& tokens, const std::string& exp) {
+	std::string_view text = exp;
+	std::vector<int> open;
+	size_t start = 0;
+	for (size_t i = 0; i < text.length(); ++i) {
+		std::string_view token = text.substr(start, i + 1 - start);
+		bool has_next = i + 1 < text.length();
+
+		// a point before a star is the entrywise product, not a decimal point
+		if (token == "." && has_next && text[i + 1] == '*') {
+			continue;
+		}
+
+		const lexEntry* entry = findLexEntry(token);
+		bool is_end;
+		if (entry || token[0] >= 'A' && token[0] <= 'Z' || token == "ans") {
+			is_end = !has_next || !isLexPrefix(text.substr(start, i + 2 - start));
+		}
+		else if (isImaginaryUnit(exp, i) && (token == "i" || isDigit(token[0]))) {
+			// imaginary unit closes a number, "2i" or a single "i"
+			is_end = true;
+		}
+		else {
+			is_end = !has_next || isDigit(text[i]) && !isDigit(text[i + 1]) && !isImaginaryUnit(exp, i + 1);
+		}
+		if (!is_end) {
+			continue;
+		}
+
+		lexToken lexed;
+		lexed.text_ = token;
+		if (entry) {
+			lexed.kind_ = entry->kind_;
+			lexed.priority_ = entry->priority_;
+			lexed.node_ = entry->node_;
+		}
+
+		int index = tokens.size();
+		if (lexed.kind_ == openToken || lexed.kind_ == openSquareToken) {
+			open.push_back(index);
+		}
+		else if (lexed.kind_ == closeToken || lexed.kind_ == closeSquareToken) {
+			tokenKind match = lexed.kind_ == closeToken ? openToken : openSquareToken;
+			if (open.empty() || tokens[open.back()].kind_ != match) {
+				return false;
+			}
+			lexed.match_ = open.back();
+			tokens[open.back()].match_ = index;
+			open.pop_back();
+		}
+		tokens.push_back(lexed);
+		start = i + 1;
+	}
+
+	return open.empty();
+}
+
+// 'i' which is not the beginning of "inv"
+bool Model::isImaginaryUnit(const std::string& exp, int pos) {
+	return pos < exp.length() && exp[pos] == 'i' && (pos + 1 == exp.length() || exp[pos + 1] != 'n');
+}
+
+// number of an integer, kept in the field and as it is written
+template <typename Field>
+static Number<Field>* makeInteger(nodeArena<Token<Field>>& nodes, int value) {
+	Number<Field>* number = nodes.template make<Number<Field>>();
+	number->kind_ = numberNode;
+	number->setUpNumber(Field(value));
+	number->is_integer_ = true;
+	number->integer_ = value;
+
+	return number;
+}
+
+// turn tokens into calc tree by precedence climbing: every token is read once, an operator
+// takes as its right operand only what binds tighter than itself, so that equal operators
+// chain to the left, and the comma, which binds weakest, separates the arguments of functions
+template <typename Field>
+Token<Field>* Model::getCalcTree(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes, const std::string& type,
+								 std::string& error) {
+	int pos = 0;
+	Token<Field>* tree = parseExpression<Field>(tokens, nodes, pos, COMMA_PRIORITY, true, type, error);
+	if (error == "" && pos != tokens.size()) {
+		error = "Invalid syntax";
+	}
+	if (error != "") {
+		return nullptr;
+	}
+
+	return tree;
+}
+
+// operators up to the priority limit; a unary minus may only start a range, that is the whole
+// expression, a bracket, an argument or a block, and it takes what binds tighter than a sum
+template <typename Field>
+Token<Field>* Model::parseExpression(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+									 int& pos, int limit, bool is_range_start, const std::string& type, std::string& error) {
+	Token<Field>* lhs;
+	bool is_unary = is_range_start && pos < tokens.size() && tokens[pos].text_ == "-";
+	if (!is_unary) {
+		lhs = parseOperand<Field>(tokens, nodes, pos, type, error);
+	}
+
+	while (error == "" && (is_unary || pos < tokens.size() && tokens[pos].kind_ == binaryToken && tokens[pos].priority_ <= limit)) {
+		Token<Field>* node = makeNode<Field>(tokens[pos].node_, nodes);
+		int priority = tokens[pos++].priority_;
+		node->left_ = lhs;
+		if (is_unary) {
+			// unary minus is subtraction from zero
+			node->left_ = makeInteger<Field>(nodes, 0);
+			is_unary = false;
+		}
+		node->right_ = parseExpression<Field>(tokens, nodes, pos, priority - 1, node->kind_ == commaNode, type, error);
+		lhs = node;
+
+		// commas may only separate the arguments of a function, chaining to the left
+		if (error == "" && (node->right_->kind_ == commaNode || node->left_->kind_ == commaNode && node->kind_ != commaNode)) {
+			error = "Syntax error: comma outside of a function";
+		}
+	}
+	if (error != "") {
+		return nullptr;
+	}
+
+	return lhs;
+}
+
+// functions with their argument, then slices X[rows, cols] of them, so that a slice binds
+// weaker than functions and tr(A)[1, 1] slices the trace
+template <typename Field>
+Token<Field>* Model::parseOperand(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+								  int& pos, const std::string& type, std::string& error) {
+	Token<Field>* node = parseApplication<Field>(tokens, nodes, pos, type, error);
+	while (error == "" && pos < tokens.size() && tokens[pos].kind_ == openSquareToken) {
+		node = parseSlice<Field>(tokens, nodes, pos, node, error);
+	}
+	if (error != "") {
+		return nullptr;
+	}
+
+	return node;
+}
+
+template <typename Field>
+Token<Field>* Model::parseApplication(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+									  int& pos, const std::string& type, std::string& error) {
+	if (pos == tokens.size() || tokens[pos].kind_ != functionToken) {
+		return parseAtom<Field>(tokens, nodes, pos, type, error);
+	}
+
+	Token<Field>* node = makeNode<Field>(tokens[pos++].node_, nodes);
+	node->left_ = parseApplication<Field>(tokens, nodes, pos, type, error);
+	if (error != "") {
+		return nullptr;
+	}
+
+	size_t count = 1;
+	for (Token<Field>* argument = node->left_; argument->kind_ == commaNode; argument = argument->left_) {
+		++count;
+	}
+
+	size_t least;
+	size_t most;
+	getArgumentsCount(node->kind_, least, most);
+	if (count < least || count > most) {
+		error = "Syntax error: wrong number of arguments of " + std::string(NODE_NAMES[node->kind_]);
+		return nullptr;
+	}
+
+	return node;
+}
+
+// variable, number, expression in brackets or block matrix
+template <typename Field>
+Token<Field>* Model::parseAtom(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+							   int& pos, const std::string& type, std::string& error) {
+	if (pos == tokens.size()) {
+		error = "Invalid syntax";
+		return nullptr;
+	}
+
+	if (tokens[pos].kind_ == openToken) {
+		int close = tokens[pos++].match_;
+		Token<Field>* node = parseExpression<Field>(tokens, nodes, pos, COMMA_PRIORITY, true, type, error);
+		if (error == "" && pos != close) {
+			error = "Invalid syntax";
+		}
+		++pos;
+		return error == "" ? node : nullptr;
+	}
+
+	if (tokens[pos].kind_ == openSquareToken) {
+		return parseBlock<Field>(tokens, nodes, pos, type, error);
+	}
+
+	if (tokens[pos].kind_ != operandToken) {
+		error = "Invalid syntax";
+		return nullptr;
+	}
+
+	std::string_view token = tokens[pos++].text_;
+	Token<Field>* node;
+	if (token == "ans") {
+		if (ans_type_ != type) {
+			error = "Semantic error: answer was computed in another type";
+			return nullptr;
+		}
+
+		fieldStore<Field>& store = getStore<Field>(type);
+		if (store.is_ans_number_) {
+			node = nodes.template make<Number<Field>>();
+			node->kind_ = numberNode;
+			node->setUpNumber(store.ans_number_);
+			return node;
+		}
+		node = nodes.template make<Var<Field>>();
+		node->kind_ = varNode;
+		node->key_ = getVariableKey<Field>(-1, type);
+		node->setUpView(store.ans_matrix_);
+		return node;
+	}
+
+	if (token[0] >= 'A' && token[0] <= 'Z') {
+		Var<Field>* var = nodes.template make<Var<Field>>();
+		var->kind_ = varNode;
+		var->variable_ = token[0] - 'A';
+		var->key_ = getVariableKey<Field>(var->variable_, type);
+		std::shared_ptr<const Matrix<Field>> matrix;
+		if (getVariable(var->variable_, type, matrix, error)) {
+			var->setUpView(matrix);
+		}
+		return var;
+	}
+
+	// an integer is also kept as it is written, for the exponents of powers
+	Number<Field>* number = nodes.template make<Number<Field>>();
+	number->kind_ = numberNode;
+	number->setUpNumber(std::string(token), error);
+	number->is_integer_ = token.length() <= MAX_INTEGER_DIGITS && token.find_first_not_of("0123456789") == std::string_view::npos;
+	for (size_t i = 0; i < token.length() && number->is_integer_; ++i) {
+		number->integer_ = number->integer_ * 10 + (token[i] - '0');
+	}
+	return number;
+}
+
+// node of an operator
+template <typename Field>
+Token<Field>* Model::makeNode(nodeKind kind, nodeArena<Token<Field>>& nodes) {
+	Token<Field>* node = nullptr;
+	switch (kind) {
+	case plusNode:
+		node = nodes.template make<Plus<Field>>();
+		break;
+	case minusNode:
+		node = nodes.template make<Minus<Field>>();
+		break;
+	case multiplyNode:
+		node = nodes.template make<Multiply<Field>>();
+		break;
+	case hadamardNode:
+		node = nodes.template make<Hadamard<Field>>();
+		break;
+	case divideNode:
+		node = nodes.template make<Divide<Field>>();
+		break;
+	case powerNode:
+		node = nodes.template make<Power<Field>>();
+		break;
+	case commaNode:
+		node = nodes.template make<Comma<Field>>();
+		break;
+	case traceNode:
+		node = nodes.template make<Trace<Field>>();
+		break;
+	case inverseNode:
+		node = nodes.template make<Inverse<Field>>();
+		break;
+	case determinantNode:
+		node = nodes.template make<Determinant<Field>>();
+		break;
+	case rankNode:
+		node = nodes.template make<Rank<Field>>();
+		break;
+	case transposeNode:
+		node = nodes.template make<Transpose<Field>>();
+		break;
+	case eigenvaluesNode:
+		node = nodes.template make<Eigenvalues<Field>>();
+		break;
+	case charpolyNode:
+		node = nodes.template make<CharacteristicPolynomial<Field>>();
+		break;
+	case svdNode:
+		node = nodes.template make<SingularValues<Field>>();
+		break;
+	case pinvNode:
+		node = nodes.template make<PseudoInverse<Field>>();
+		break;
+	case solveNode: {
+		Solve<Field>* solve = nodes.template make<Solve<Field>>();
+		solve->options_ = solve_options_;
+		node = solve;
+		break;
+	}
+	case rankestNode:
+		node = nodes.template make<ApproximateRank<Field>>();
+		break;
+	case svdkNode:
+		node = nodes.template make<LeadingSingularValues<Field>>();
+		break;
+	case normestNode:
+		node = nodes.template make<NormEstimate<Field>>();
+		break;
+	case expmNode:
+		node = nodes.template make<Exponential<Field>>();
+		break;
+	case logmNode:
+		node = nodes.template make<Logarithm<Field>>();
+		break;
+	case sqrtmNode:
+		node = nodes.template make<SquareRoot<Field>>();
+		break;
+	case kronNode:
+		node = nodes.template make<Kronecker<Field>>();
+		break;
+	default:
+		// leaves, slices and blocks carry more than their kind and are made where they are read
+		return nullptr;
+	}
+	node->kind_ = kind;
+
+	return node;
+}
+
+// slice [rows, cols] at pos of the node before it
+template <typename Field>
+Token<Field>* Model::parseSlice(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+								int& pos, Token<Field>* node, std::string& error) {
+	int open = pos;
+	int close = tokens[open].match_;
+	pos = close + 1;
+
+	int comma = -1;
+	for (int i = open + 1; i < close; ++i) {
+		if (tokens[i].text_ == ",") {
+			if (comma != -1) {
+				error = "Syntax error: slice takes a range of rows and a range of columns";
+				return nullptr;
+			}
+			comma = i;
+		}
+	}
+
+	if (comma == -1) {
+		error = "Syntax error: slice takes a range of rows and a range of columns";
+		return nullptr;
 	}
-	return handleCalcExpQuery(query);
+
+	Slice<Field>* slice = nodes.template make<Slice<Field>>();
+	slice->kind_ = sliceNode;
+	if (!isSliceRange(tokens, open + 1, comma, slice->rows_, error) ||
+		!isSliceRange(tokens, comma + 1, close, slice->cols_, error)) {
+		return nullptr;
+	}
+	slice->left_ = node;
+
+	return slice;
 }
 
-// private constructor for singleton pattern
+// block matrix [A, B; C, D] at pos, rows are separated by semicolons and blocks in a row by commas
+template <typename Field>
+Token<Field>* Model::parseBlock(const std::vector<lexToken>& tokens, nodeArena<Token<Field>>& nodes,
+								int& pos, const std::string& type, std::string& error) {
+	auto concatenate = [&nodes](Token<Field>* lhs, Token<Field>* rhs, bool is_vertical) {
+		Concatenation<Field>* node = nodes.template make<Concatenation<Field>>();
+		node->kind_ = is_vertical ? vcatNode : hcatNode;
+		node->is_vertical_ = is_vertical;
+		node->left_ = lhs;
+		node->right_ = rhs;
+		return node;
+	};
+
+	int close = tokens[pos++].match_;
+	Token<Field>* block = nullptr;
+	Token<Field>* row = nullptr;
+	while (true) {
+		Token<Field>* entry = parseExpression<Field>(tokens, nodes, pos, COMMA_PRIORITY - 1, true, type, error);
+		if (error == "" && tokens[pos].text_ != "," && tokens[pos].text_ != ";" && pos != close) {
+			error = "Invalid syntax";
+		}
+		if (error != "") {
+			return nullptr;
+		}
+		row = row ? concatenate(row, entry, false) : entry;
 
-Model::Model(): is_ans_number_(false)
-{
-	priority_["+"] = 4;
-	priority_["-"] = 4;
-	priority_["*"] = 3;
-	priority_["/"] = 3;
-	priority_["^"] = 2;
-	priority_["tr"] = 1;
-	priority_["inv"] = 1;
-	priority_["det"] = 1;
-	priority_["rk"] = 1;
-	priority_["trans"] = 1;
-	variables_.resize(26);
+		if (pos == close || tokens[pos].text_ == ";") {
+			block = block ? concatenate(block, row, true) : row;
+			row = nullptr;
+		}
+		if (pos++ == close) {
+			return block;
+		}
+	}
 }
 
-// query handlers
+// rewriting of the tree
+
+// whether a subtree always evaluates to a number
+template <typename Field>
+static bool isScalarTree(const Token<Field>& node) {
+	switch (node.kind_) {
+	case numberNode:
+	case traceNode:
+	case determinantNode:
+	case rankNode:
+	case rankestNode:
+	case normestNode:
+		return true;
+	case sliceNode: {
+		const Slice<Field>& slice = static_cast<const Slice<Field>&>(node);
+		return slice.rows_.is_index_ && slice.cols_.is_index_;
+	}
+	case powerNode:
+		return isScalarTree(*node.left_);
+	case plusNode:
+	case minusNode:
+	case multiplyNode:
+	case divideNode:
+	case hadamardNode:
+		return isScalarTree(*node.left_) && isScalarTree(*node.right_);
+	default:
+		return false;
+	}
+}
 
-Answer Model::handleInitQuery(const Query& query) {
-	Answer ans;
+// dimensions of a matrix subtree when they are known before the evaluation
+template <typename Field>
+static bool getStaticShape(const Token<Field>& node, size_t& rows, size_t& cols) {
+	switch (node.kind_) {
+	case varNode:
+		getDimensions(node, rows, cols);
+		return true;
+	case transposeNode:
+		return getStaticShape(*node.left_, cols, rows);
+	case inverseNode:
+	case expmNode:
+	case logmNode:
+	case sqrtmNode:
+	case powerNode:
+		return getStaticShape(*node.left_, rows, cols);
+	case plusNode:
+	case minusNode:
+	case hadamardNode:
+		return getStaticShape(*node.left_, rows, cols) || getStaticShape(*node.right_, rows, cols);
+	case multiplyNode: {
+		if (isScalarTree(*node.left_)) {
+			return getStaticShape(*node.right_, rows, cols);
+		}
+		if (isScalarTree(*node.right_)) {
+			return getStaticShape(*node.left_, rows, cols);
+		}
 
-	if (query.is_ans_used_) {
-		if (is_ans_number_) {
-			ans.error_message_ = "Cannot initialize variable with number";
-			return ans;
+		size_t inner;
+		return getStaticShape(*node.left_, rows, inner) && getStaticShape(*node.right_, inner, cols);
+	}
+	default:
+		return false;
+	}
+}
+
+template <typename Field>
+static bool isStaticSquare(const Token<Field>& node, size_t& size) {
+	size_t cols;
+	return getStaticShape(node, size, cols) && size == cols;
+}
+
+// operators of cubic cost in the shared tree, a shared node is counted once
+template <typename Field>
+static size_t countCubic(const Token<Field>* node, std::set<const Token<Field>*>& counted) {
+	if (!node || !counted.insert(node).second) {
+		return 0;
+	}
+
+	size_t cubic = 0;
+	switch (node->kind_) {
+	case determinantNode:
+		// det(X, Y) factors both matrices, det(c, X) only one
+		cubic = node->left_->kind_ == commaNode && !isScalarTree(*node->left_->left_) ? 2 : 1;
+		break;
+	case inverseNode:
+	case rankNode:
+	case charpolyNode:
+	case eigenvaluesNode:
+	case svdNode:
+	case pinvNode:
+	case solveNode:
+	case expmNode:
+	case logmNode:
+	case sqrtmNode:
+		cubic = 1;
+		break;
+	case multiplyNode:
+		cubic = !isScalarTree(*node->left_) && !isScalarTree(*node->right_) ? 1 : 0;
+		break;
+	case powerNode:
+		cubic = !isScalarTree(*node->left_) ? 1 : 0;
+		break;
+	default:
+		break;
+	}
+
+	return cubic + countCubic(node->left_, counted) + countCubic(node->right_, counted);
+}
+
+// nodes of the shared tree which read every node
+template <typename Field>
+static void countReaders(const Token<Field>* node, std::map<const Token<Field>*, int>& readers) {
+	if (!node || !readers.emplace(node, 0).second) {
+		return;
+	}
+
+	for (const Token<Field>* child : {node->left_, node->right_}) {
+		countReaders(child, readers);
+		if (child) {
+			++readers[child];
 		}
+	}
+}
 
-		variables_[query.variable_used_] = ans_matrix_float_;
+// rewrite the children first, then apply the rules at the node until none of them fits;
+// a shared node is rewritten once and its replacement takes over its readers, every rule applied is logged
+template <typename Field>
+Token<Field>* Model::simplifyTree(Token<Field>* node, nodeArena<Token<Field>>& nodes, std::map<const Token<Field>*, int>& readers,
+								  std::map<const Token<Field>*, Token<Field>*>& simplified, std::vector<std::string>& rewrites) {
+	if (!node) {
+		return node;
+	}
 
-		return ans;
+	auto found = simplified.find(node);
+	if (found != simplified.end()) {
+		return found->second;
 	}
 
-	isMatrixValid(query.matrix_, query.variable_used_, init, ans.error_message_);
-	if (ans.error_message_ != "") {
-		return ans;
+	Token<Field>* original = node;
+	node->left_ = simplifyTree(node->left_, nodes, readers, simplified, rewrites);
+	node->right_ = simplifyTree(node->right_, nodes, readers, simplified, rewrites);
+
+	std::string rule;
+	for (Token<Field>* next = applyRewrite(node, nodes, readers, rule); next; next = applyRewrite(node, nodes, readers, rule)) {
+		rewrites.push_back(rule);
+		readers[next] += readers[node];
+		node = simplifyTree(next, nodes, readers, simplified, rewrites);
 	}
+	simplified[original] = node;
 
-	return ans;
+	return node;
 }
 
-Answer Model::handleSolveEqQuery(const Query& query) {
-	Answer ans;
+// one identity which makes the node cheaper to evaluate, empty if none fits;
+// the identities keep the value, but a singular X in inv(inv(X)) is no longer reported
+template <typename Field>
+Token<Field>* Model::applyRewrite(Token<Field>* node, nodeArena<Token<Field>>& nodes,
+								  const std::map<const Token<Field>*, int>& readers, std::string& rule) {
+	auto make = [this, &nodes](nodeKind kind, Token<Field>* left, Token<Field>* right) {
+		Token<Field>* result = makeNode<Field>(kind, nodes);
+		result->left_ = left;
+		result->right_ = right;
+		return result;
+	};
+
+	auto slice = [&nodes](Token<Field>* left, const sliceRange& rows, const sliceRange& cols) {
+		Slice<Field>* result = nodes.template make<Slice<Field>>();
+		result->kind_ = sliceNode;
+		result->rows_ = rows;
+		result->cols_ = cols;
+		result->left_ = left;
+		return result;
+	};
+
+	// a product which another node reads is computed anyway, so it is not taken apart
+	auto isReadOnce = [&readers](const Token<Field>* product) {
+		auto found = readers.find(product);
+		return found == readers.end() || found->second <= 1;
+	};
+
+	nodeKind kind = node->kind_;
+	Token<Field>* left = node->left_;
+	Token<Field>* right = node->right_;
+
+	// arithmetics of numbers is done once here, errors are left for the evaluation
+	if ((kind == plusNode || kind == minusNode || kind == multiplyNode || kind == divideNode || kind == powerNode) &&
+		left->kind_ == numberNode && right->kind_ == numberNode) {
+		std::string error;
+		node->calc(error);
+		if (error != "") {
+			return nullptr;
+		}
 
-	isMatrixValid(query.matrix_, 0, solveEq, ans.error_message_);
+		// integers written in the expression stay integers, so that they may be exponents
+		Number<Field>* number = nodes.template make<Number<Field>>();
+		number->kind_ = numberNode;
+		number->setUpNumber(node->ans_number_);
+		const Number<Field>& lhs = static_cast<const Number<Field>&>(*left);
+		const Number<Field>& rhs = static_cast<const Number<Field>&>(*right);
+		if (lhs.is_integer_ && rhs.is_integer_) {
+			long long& value = number->integer_;
+			number->is_integer_ = kind == plusNode && !__builtin_add_overflow(lhs.integer_, rhs.integer_, &value) ||
+								  kind == minusNode && !__builtin_sub_overflow(lhs.integer_, rhs.integer_, &value) ||
+								  kind == multiplyNode && !__builtin_mul_overflow(lhs.integer_, rhs.integer_, &value);
+		}
+		rule = "constant folding";
+		return number;
+	}
 
-	if (ans.error_message_ != "") {
-		return ans;
+	// trans(trans(X)) -> X
+	if (kind == transposeNode && left->kind_ == transposeNode) {
+		rule = "trans(trans(X)) -> X";
+		return left->left_;
 	}
 
-	Matrix<float> equation(system_);
-	ans.ans_matrix_ = equation.getReducedRowEchelonForm().getMatrix();
+	// inv(inv(X)) -> X
+	if (kind == inverseNode && left->kind_ == inverseNode) {
+		rule = "inv(inv(X)) -> X";
+		return left->left_;
+	}
 
-	for (int i = 0; i < ans.ans_matrix_.size(); ++i) {
-		for (int j = 0; j < ans.ans_matrix_[i].size(); ++j) {
-			if (ans.ans_matrix_[i][j] == -0.0) {
-				ans.ans_matrix_[i][j] = 0;
-			}
-		}
+	// det(trans(X)) -> det(X), rk(trans(X)) -> rk(X)
+	if ((kind == determinantNode || kind == rankNode) && left->kind_ == transposeNode) {
+		rule = kind == determinantNode ? "det(trans(X)) -> det(X)" : "rk(trans(X)) -> rk(X)";
+		return make(kind, left->left_, nullptr);
 	}
 
-	return ans;
-}
+	size_t size;
+	size_t other;
+	// det(c*X) -> c^n*det(X), floating fields take det(c, X), which scales the pivots of X
+	// instead of forming c^n, which may overflow where the determinant does not
+	constexpr bool is_floating = std::is_floating_point_v<Field> || std::is_same_v<Field, complexNumber>;
+	if (kind == determinantNode && left->kind_ == multiplyNode && isScalarTree(*left->left_) && isStaticSquare(*left->right_, size)) {
+		if (is_floating) {
+			rule = "det(c*X) -> det(c, X)";
+			return make(determinantNode, make(commaNode, left->left_, left->right_), nullptr);
+		}
 
-Answer Model::handleCalcExpQuery(const Query& query) {
-	Answer ans;
-	std::string exp = query.exp_;
-	std::vector<std::string> tokens;
-	splitIntoTokens(tokens, exp);
+		rule = "det(c*X) -> c^n*det(X)";
+		Token<Field>* exponent = makeInteger<Field>(nodes, static_cast<int>(size));
+		return make(multiplyNode, make(powerNode, left->left_, exponent), make(determinantNode, left->right_, nullptr));
+	}
 
-	if (!correctBrackets(tokens)) {
-		ans.error_message_ = "Invalid syntax: brackets";
+	// det(X*Y) -> det(X)*det(Y), floating fields take det(X, Y), which multiplies the pivots of both
+	// factors, since their determinants may overflow where the one of the product does not
+	if (kind == determinantNode && left->kind_ == multiplyNode && isReadOnce(left) && isStaticSquare(*left->left_, size) &&
+		isStaticSquare(*left->right_, other) && size == other) {
+		if (is_floating) {
+			rule = "det(X*Y) -> det(X, Y)";
+			return make(determinantNode, make(commaNode, left->left_, left->right_), nullptr);
+		}
 
-		return ans;
+		rule = "det(X*Y) -> det(X)*det(Y)";
+		return make(multiplyNode, make(determinantNode, left->left_, nullptr), make(determinantNode, left->right_, nullptr));
 	}
 
-	std::shared_ptr<Token> calc_tree = nullptr;
-	calc_tree = getCalcTree(tokens, 0, tokens.size(), ans.error_message_);
+	// tr(X+Y) -> tr(X)+tr(Y), tr(X-Y) -> tr(X)-tr(Y)
+	if (kind == traceNode && (left->kind_ == plusNode || left->kind_ == minusNode) && isStaticSquare(*left->left_, size) &&
+		isStaticSquare(*left->right_, other) && size == other) {
+		rule = left->kind_ == plusNode ? "tr(X+Y) -> tr(X)+tr(Y)" : "tr(X-Y) -> tr(X)-tr(Y)";
+		return make(left->kind_, make(traceNode, left->left_, nullptr), make(traceNode, left->right_, nullptr));
+	}
 
-	printTree(calc_tree);
-	std::cout << "---------------" << std::endl;
+	// tr(c*X) -> c*tr(X)
+	if (kind == traceNode && left->kind_ == multiplyNode && isScalarTree(*left->left_) && !isScalarTree(*left->right_)) {
+		rule = "tr(c*X) -> c*tr(X)";
+		return make(multiplyNode, left->left_, make(traceNode, left->right_, nullptr));
+	}
+
+	// tr(X*Y) -> tr(X, Y), the trace of a product only needs its diagonal
+	if (kind == traceNode && left->kind_ == multiplyNode && isReadOnce(left) && !isScalarTree(*left->left_) && !isScalarTree(*left->right_)) {
+		rule = "tr(X*Y) -> tr(X, Y)";
+		return make(traceNode, make(commaNode, left->left_, left->right_), nullptr);
+	}
 
-	calc(calc_tree, ans.error_message_);
+	// a slice is pushed down to the operands, so that only the entries it keeps are computed;
+	// the shapes are checked first, so that the errors stay the same
+	if (kind == sliceNode) {
+		const Slice<Field>& cut = static_cast<const Slice<Field>&>(*node);
+		bool is_entry = cut.rows_.is_index_ && cut.cols_.is_index_;
+		sliceRange all;
+		size_t rows;
+		size_t cols;
+		size_t other_rows;
+		size_t other_cols;
 
-	if (ans.error_message_ == "") {
-		ans.is_ans_number_ = calc_tree->is_ans_number_;
-		is_ans_number_ = calc_tree->is_ans_number_;
-		if (is_ans_number_) {
-			ans.ans_float_ = calc_tree->ans_float_;
-			ans_float_ = calc_tree->ans_float_;
+		// (X*Y)[r, c] -> X[r, :]*Y[:, c], an entry of a product is the trace of a row times a column
+		if (left->kind_ == multiplyNode && isReadOnce(left) && getStaticShape(*left->left_, rows, cols) &&
+			getStaticShape(*left->right_, other_rows, other_cols) && cols == other_rows) {
+			Token<Field>* product = make(multiplyNode, slice(left->left_, cut.rows_, all), slice(left->right_, all, cut.cols_));
+			rule = "(X*Y)[r, c] -> X[r, :]*Y[:, c]";
+			return is_entry ? make(traceNode, product, nullptr) : product;
 		}
-		else {
-			ans_matrix_float_.resize(calc_tree->ans_matrix_.size());
-			for (int i = 0; i < calc_tree->ans_matrix_.size(); ++i) {
-				ans_matrix_float_[i].resize(calc_tree->ans_matrix_[i].size());
-				for (int j = 0; j < calc_tree->ans_matrix_[i].size(); ++j) {
-					int int_value = calc_tree->ans_matrix_[i][j];
-					if (calc_tree->ans_matrix_[i][j] - int_value < 0.00001) {
-						ans_matrix_float_[i][j] = int_value;
-					}
-					else {
-						ans_matrix_float_[i][j] = calc_tree->ans_matrix_[i][j];
-					}
-				}
-			}
-			ans.ans_matrix_ = ans_matrix_float_;
+
+		// (c*X)[r, c] -> c*X[r, c]
+		if (left->kind_ == multiplyNode && isScalarTree(*left->left_) && getStaticShape(*left->right_, rows, cols)) {
+			rule = "(c*X)[r, c] -> c*X[r, c]";
+			return make(multiplyNode, left->left_, slice(left->right_, cut.rows_, cut.cols_));
 		}
-	}
 
-	return ans;
-}
+		// (X+Y)[r, c] -> X[r, c]+Y[r, c], also for - and .*
+		if ((left->kind_ == plusNode || left->kind_ == minusNode || left->kind_ == hadamardNode) && getStaticShape(*left->left_, rows, cols) &&
+			getStaticShape(*left->right_, other_rows, other_cols) && rows == other_rows && cols == other_cols) {
+			std::string sign(NODE_NAMES[left->kind_]);
+			rule = "(X" + sign + "Y)[r, c] -> X[r, c]" + sign + "Y[r, c]";
+			return make(left->kind_, slice(left->left_, cut.rows_, cut.cols_), slice(left->right_, cut.rows_, cut.cols_));
+		}
 
-// checkers
+		// trans(X)[r, c] -> trans(X[c, r])
+		if (left->kind_ == transposeNode && getStaticShape(*left->left_, rows, cols)) {
+			Token<Field>* entries = slice(left->left_, cut.cols_, cut.rows_);
+			rule = "trans(X)[r, c] -> trans(X[c, r])";
+			return is_entry ? entries : make(transposeNode, entries, nullptr);
+		}
+	}
 
-// check if cells really represent real numbers
-void Model::isMatrixValid(const std::vector<std::vector<std::string>>& matrix, int variable, int query_type, std::string& error) {
-	std::vector<std::vector<float>> copy;
-	int row = matrix.size();
-	int col = matrix[0].size();
-	copy.resize(row);
-	for (int i = 0; i < row; ++i) {
-		copy[i].resize(col);
+	// numbers are moved to the front of products, so that a matrix is scaled once: X*c -> c*X
+	if (kind == multiplyNode && !isScalarTree(*left) && isScalarTree(*right)) {
+		rule = "X*c -> c*X";
+		return make(multiplyNode, right, left);
 	}
 
-	for (int i = 0; i < row; ++i) {
-		for (int j = 0; j < col; ++j) {
-			std::string first = "";
-			std::string second = "";
-			int cur = 0;
+	// X*(c*Y) -> c*(X*Y)
+	if (kind == multiplyNode && !isScalarTree(*left) && right->kind_ == multiplyNode && isScalarTree(*right->left_)) {
+		rule = "X*(c*Y) -> c*(X*Y)";
+		return make(multiplyNode, right->left_, make(multiplyNode, left, right->right_));
+	}
 
-			while (cur < matrix[i][j].length() && matrix[i][j][cur] != '/') {
-				first += matrix[i][j][cur++];
-			}
+	// (c*X)*Y -> c*(X*Y)
+	if (kind == multiplyNode && left->kind_ == multiplyNode && isScalarTree(*left->left_) && !isScalarTree(*left->right_) && !isScalarTree(*right)) {
+		rule = "(c*X)*Y -> c*(X*Y)";
+		return make(multiplyNode, left->left_, make(multiplyNode, left->right_, right));
+	}
 
-			for (int k = cur + 1; k < matrix[i][j].length(); ++k) {
-				second += matrix[i][j][k];
-			}
+	// c*(d*X) -> (c*d)*X
+	if (kind == multiplyNode && isScalarTree(*left) && right->kind_ == multiplyNode && isScalarTree(*right->left_) && !isScalarTree(*right->right_)) {
+		rule = "c*(d*X) -> (c*d)*X";
+		return make(multiplyNode, make(multiplyNode, left, right->left_), right->right_);
+	}
 
-			if (first == "") {
-				error = "Syntax error: the cells do not represent real numbers";
-				return;
-			}
+	return nullptr;
+}
 
-			char* pend1;
-			copy[i][j] = std::strtof(first.c_str(), &pend1);
+// sharing of subtrees
 
-			if (pend1 == first.c_str()) {
-				error = "Syntax error: the cells do not represent real numbers";
-				return;
-			}
+// exact form of a number, the printed form of a float is rounded
+template <typename Field>
+static std::string getNumberKey(const Field& value) {
+	auto exact = [](double real) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%a", real);
+		return std::string(buffer);
+	};
 
-			if (second != "") {
-				char* pend2;
-				float second_num = std::strtof(second.c_str(), &pend2);
-				if (pend2 == second.c_str()) {
-					error = "Syntax error: the cells do not represent real numbers";
-					return;
-				}
-				if (second_num == 0.0) {
-					error = "Division by zero";
-					return;
-				}
+	if constexpr (std::is_floating_point_v<Field>) {
+		return exact(value);
+	}
+	else if constexpr (std::is_same_v<Field, complexNumber>) {
+		return exact(value.re()) + " " + exact(value.im());
+	}
+	else {
+		return fieldTraits<Field>::toString(value);
+	}
+}
 
-				copy[i][j] /= second_num;
-			}
+// number of a subtree from the numbers of its children: the operator with its parameters, an
+// integer as it is written or the exact value of another number; a variable gets its number with
+// its version when it is read
+template <typename Field>
+static size_t getSubtreeKey(const Token<Field>& node, subtreeTable& table) {
+	if (node.kind_ == varNode) {
+		return node.key_;
+	}
+	if (node.kind_ == numberNode) {
+		const Number<Field>& number = static_cast<const Number<Field>&>(node);
+		return table.getKey(number.is_integer_ ? "integer " + std::to_string(number.integer_) : getNumberKey(node.ans_number_));
+	}
+
+	std::string key(NODE_NAMES[node.kind_]);
+	if (node.kind_ == sliceNode) {
+		const Slice<Field>& slice = static_cast<const Slice<Field>&>(node);
+		for (const sliceRange* range : {&slice.rows_, &slice.cols_}) {
+			key += range->is_all_ ? " :" : " " + std::to_string(range->first_) + ":" + std::to_string(range->last_) +
+										   (range->is_index_ ? "i" : "");
 		}
 	}
+	else if (node.kind_ == solveNode) {
+		const krylovOptions& options = static_cast<const Solve<Field>&>(node).options_;
+		key += " " + std::to_string(options.method_) + " " + std::to_string(options.preconditioner_) + " " +
+			   getNumberKey(options.tolerance_) + " " + std::to_string(options.max_iterations_) + " " +
+			   std::to_string(options.restart_);
+	}
 
-	if (query_type == init) {
-		variables_[variable] = copy;
+	return table.getKey(key, node.left_->key_, node.right_ ? node.right_->key_ : 0);
+}
+
+// the children are shared first, then the node is replaced by an equal one met before
+template <typename Field>
+Token<Field>* Model::shareSubtrees(Token<Field>* node, subtreeTable& table,
+												   std::unordered_map<size_t, Token<Field>*>& subtrees) {
+	if (!node) {
+		return node;
 	}
-	else {
-		system_ = copy;
+
+	node->left_ = shareSubtrees(node->left_, table, subtrees);
+	node->right_ = shareSubtrees(node->right_, table, subtrees);
+	node->key_ = getSubtreeKey(*node, table);
+
+	auto found = subtrees.find(node->key_);
+	if (found == subtrees.end()) {
+		subtrees[node->key_] = node;
+		return node;
 	}
 
-	return;
+	return found->second;
 }
 
-bool Model::isDigit(char symbol) {
-	return symbol == '.' || (symbol >= '0' && symbol <= '9');
-}
+// compiling of the tree
 
-// checks if brackets sequence is correct
-bool Model::correctBrackets(const std::vector<std::string>& tokens) {
-	std::stack<std::string> br;
-	int cnt = 0;
-	for (int i = 0; i < tokens.size(); ++i) {
-		if (tokens[i] == "(") {
-			++cnt;
-			br.push("(");
-		}
-		if (tokens[i] == ")") {
-			if (br.empty()) return false;
-			--cnt;
-		}
+// registers of the subtree in the order of evaluation, a shared node gets one register
+template <typename Field>
+static int addSteps(Token<Field>* node, std::map<const Token<Field>*, int>& registers,
+					compiledProgram<Field>& program) {
+	auto found = registers.find(node);
+	if (found != registers.end()) {
+		return found->second;
 	}
 
-	if (cnt) {
-		return false;
+	programStep<Field> step;
+	step.node_ = node;
+	if (node->left_) {
+		step.left_ = addSteps(node->left_, registers, program);
+	}
+	if (node->right_) {
+		step.right_ = addSteps(node->right_, registers, program);
+	}
+	if (node->kind_ == varNode) {
+		step.variable_ = static_cast<const Var<Field>&>(*node).variable_;
 	}
+	step.is_cached_ = node->left_ && node->kind_ != commaNode;
 
-	return true;
+	int index = program.steps_.size();
+	registers[node] = index;
+	program.steps_.push_back(step);
+
+	return index;
 }
 
-bool Model::isOperator(const std::string& token) {
-	return token == "+" || token == "-" || token == "*" || token == "/" || token == "^" ||
-		   token == "tr" || token == "inv" || token == "det" || token == "rk" ||
-		   token == "trans";
+// registers whose answers the step reads; a function reads its arguments through its commas
+template <typename Field>
+static void getReads(const std::vector<programStep<Field>>& steps, int index, std::vector<int>& reads) {
+	for (int operand : {steps[index].left_, steps[index].right_}) {
+		if (operand == -1) {
+			continue;
+		}
+		if (steps[operand].node_->kind_ == commaNode) {
+			getReads(steps, operand, reads);
+		}
+		else if (std::find(reads.begin(), reads.end(), operand) == reads.end()) {
+			reads.push_back(operand);
+		}
+	}
 }
 
-// split expression into tokens
-void Model::splitIntoTokens(std::vector<std::string>& tokens, const std::string& exp) {
-	std::string token = "";
-	for (int i = 0; i < exp.length(); ++i) {
-		token += exp[i];
+// whether the answer of a step is a matrix of its own, which its reader may write into;
+// a variable, a view into other matrices and a kronecker product are not
+template <typename Field>
+static bool ownsMatrix(const programStep<Field>& step) {
+	nodeKind kind = step.node_->kind_;
+	return step.variable_ == -1 && !isScalarTree(*step.node_) && kind != sliceNode && kind != transposeNode &&
+		   kind != hcatNode && kind != vcatNode && kind != kronNode;
+}
 
-		if (token == "(" || token == ")" || isOperator(token) || (token[0] >= 'A' && token[0] <= 'Z') || token == "ans") {
-			if (token == "tr" && i + 1 < exp.length() && exp[i + 1] == 'a') {
-				continue;
-			}
-			tokens.push_back(token);
-			token = "";
+// the answer of a step whose only reader writes into its storage is not cached, since the cache
+// would hold on to the storage: a sum or a difference takes either operand, a matrix scaled by
+// a number takes the matrix
+template <typename Field>
+static void keepReusedOutOfCache(std::vector<programStep<Field>>& steps) {
+	std::vector<int> readers(steps.size(), 0);
+	std::vector<int> reader(steps.size(), -1);
+	for (size_t i = 0; i < steps.size(); ++i) {
+		if (steps[i].node_->kind_ == commaNode) {
+			continue;
 		}
-		else if (i + 1 == exp.length() || i + 1 < exp.length() && isDigit(exp[i]) && !isDigit(exp[i + 1])) {
-			tokens.push_back(token);
-			token = "";
+		std::vector<int> reads;
+		getReads(steps, i, reads);
+		for (int operand : reads) {
+			++readers[operand];
+			reader[operand] = i;
 		}
 	}
-}
 
-// turn tokens into calc tree
-std::shared_ptr<Token> Model::getCalcTree(const std::vector<std::string>& tokens, int start, int end, std::string& error) {
-	// remove outer brackets
-	bool stop = false;
-	while (!stop) {
-		int cnt = 0;
-		bool has_outer_br = true;
-		for (int i = start; i < end; ++i) {
-			if (tokens[i] == "(") ++cnt;
-			if (tokens[i] == ")") --cnt;
+	for (size_t i = 0; i + 1 < steps.size(); ++i) {
+		if (readers[i] != 1 || isScalarTree(*steps[i].node_)) {
+			continue;
+		}
 
-			if (cnt == 0 && i + 1 < end || start + 1 == end) {
-				has_outer_br = false;
-				break;
-			}
+		// the right operand of a sum or a difference is taken when the left one can not be
+		const programStep<Field>& next = steps[reader[i]];
+		const Token<Field>& node = *next.node_;
+		int other = next.left_ == static_cast<int>(i) ? next.right_ : next.left_;
+		bool is_left_taken = next.left_ != -1 && readers[next.left_] == 1 && ownsMatrix(steps[next.left_]);
+		bool is_taken = (node.kind_ == plusNode || node.kind_ == minusNode) && next.left_ != next.right_ &&
+						(next.left_ == static_cast<int>(i) || !is_left_taken) ||
+						node.kind_ == multiplyNode && other != -1 && isScalarTree(*steps[other].node_);
+		if (is_taken) {
+			steps[i].is_cached_ = false;
 		}
+	}
+}
 
-		if (has_outer_br) {
-			++start;
-			--end;
+// opcodes of the steps whose operands are known to be numbers or matrices of fitting shapes, from
+// the leaves up; the answer of a step calling calc is a number or a matrix of a known shape only
+// if calc succeeds, and a failed step stops the steps reading it anyway
+template <typename Field>
+static void resolveOpcodes(std::vector<programStep<Field>>& steps) {
+	for (programStep<Field>& step : steps) {
+		const Token<Field>& node = *step.node_;
+		nodeKind kind = node.kind_;
+		const programStep<Field>* left = step.left_ == -1 ? nullptr : &steps[step.left_];
+		const programStep<Field>* right = step.right_ == -1 ? nullptr : &steps[step.right_];
+		auto isNumber = [](const programStep<Field>* operand) {
+			return operand && operand->kind_ == numberAnswer;
+		};
+		auto isMatrix = [](const programStep<Field>* operand) {
+			return operand && operand->kind_ == matrixAnswer;
+		};
+		auto setMatrix = [&step](stepOpcode opcode, size_t rows, size_t cols) {
+			step.opcode_ = opcode;
+			step.kind_ = matrixAnswer;
+			step.rows_ = rows;
+			step.cols_ = cols;
+		};
+
+		if ((kind == plusNode || kind == minusNode || kind == multiplyNode || kind == divideNode) && isNumber(left) && isNumber(right)) {
+			step.opcode_ = kind == plusNode ? addNumbers : kind == minusNode ? subtractNumbers
+						 : kind == multiplyNode ? multiplyNumbers : divideNumbers;
+			step.kind_ = numberAnswer;
 		}
-		else {
-			stop = true;
+		else if ((kind == plusNode || kind == minusNode) && isMatrix(left) && isMatrix(right) && left->rows_ == right->rows_ &&
+				 left->cols_ == right->cols_) {
+			setMatrix(kind == plusNode ? addMatrices : subtractMatrices, left->rows_, left->cols_);
+		}
+		else if (kind == multiplyNode && isNumber(left) && isMatrix(right)) {
+			setMatrix(scaleMatrix, right->rows_, right->cols_);
+		}
+		else if (kind == multiplyNode && isMatrix(left) && isNumber(right)) {
+			setMatrix(scaleMatrix, left->rows_, left->cols_);
+		}
+		else if (kind == multiplyNode && isMatrix(left) && isMatrix(right) && left->cols_ == right->rows_) {
+			setMatrix(multiplyMatrices, left->rows_, right->cols_);
+		}
+		else if ((kind == traceNode || kind == determinantNode) && isMatrix(left) && left->rows_ == left->cols_) {
+			step.opcode_ = kind == traceNode ? traceMatrix : determinantMatrix;
+			step.kind_ = numberAnswer;
+		}
+		else if (kind == numberNode || kind != commaNode && isScalarTree(node)) {
+			step.kind_ = numberAnswer;
+		}
+		else if (kind != commaNode && getStaticShape(node, step.rows_, step.cols_)) {
+			step.kind_ = matrixAnswer;
 		}
 	}
+}
 
-	// find inflection point
-	int max_priority = -1;
-	int pos = -1;
-	int br = 0;
-	for (int i = end - 1; i >= start; --i) {
-		if (tokens[i] == "(") --br;
-		if (tokens[i] == ")") ++br;
-		if (isOperator(tokens[i])) {
-			if (priority_[tokens[i]] - 4 * br > max_priority) {
-				max_priority = priority_[tokens[i]] - 4 * br;
-				pos = i;
+// the rewrites read the shapes of the variables, so the program is kept by the text together
+// with the shapes; an expression which reads ans is compiled every time, since ans may be a number
+template <typename Field>
+std::shared_ptr<compiledProgram<Field>> Model::getProgram(const std::vector<lexToken>& tokens, const std::string& type, std::string& error) {
+	fieldStore<Field>& store = getStore<Field>(type);
+	if (store.subtrees_.size() > MAX_SUBTREES) {
+		// the numbers start again, so nothing keyed by the old ones is kept
+		store.subtrees_.clear();
+		store.cache_.clear();
+		store.programs_.clear();
+	}
+
+	std::string key;
+	bool is_kept = true;
+	for (const lexToken& token : tokens) {
+		key.append(token.text_).append(" ");
+		if (token.text_ == "ans") {
+			is_kept = false;
+		}
+		else if (token.text_[0] >= 'A' && token.text_[0] <= 'Z') {
+			// a variable which can not be read is reported by the compilation
+			std::shared_ptr<const Matrix<Field>> matrix;
+			std::string variable_error;
+			if (!getVariable(token.text_[0] - 'A', type, matrix, variable_error)) {
+				is_kept = false;
+				continue;
 			}
+			key += std::to_string(matrix->getRow()) + "x" + std::to_string(matrix->getCol()) + " ";
 		}
 	}
 
-	// base case
-	if (pos == -1) {
-		std::shared_ptr<Token> node;
-		if (end - start != 1 || isOperator(tokens[start])) {
-			error = "Invalid syntax";
+	auto found = store.programs_.find(key);
+	if (is_kept && found != store.programs_.end()) {
+		if (!bindProgram(*found->second, type, error)) {
 			return nullptr;
 		}
+		return found->second;
+	}
 
-		if ((tokens[start][0] >= 'A' && tokens[start][0] <= 'Z') || tokens[start] == "ans") {
-			if (tokens[start] == "ans") {
-				if (is_ans_number_) {
-					node = std::shared_ptr<Number>(new Number());
-					node->type_ = "number";
-					node->setUpNumber(ans_float_);
-					return node;
-				}
-				else {
-					node = std::shared_ptr<Var>(new Var());
-					node->type_ = "var";
-					node->setUpMatrix(ans_matrix_float_, error);
-					return node;
-				}
-			}
-			node = std::shared_ptr<Var>(new Var());
-			node->type_ = "var";
-			node->setUpMatrix(variables_[tokens[start][0] - 'A'], error);
-			return node;
+	std::shared_ptr<compiledProgram<Field>> program = compileProgram<Field>(tokens, type, error);
+	if (is_kept && program) {
+		if (store.programs_.size() == MAX_PROGRAMS) {
+			store.programs_.clear();
 		}
-
-		node = std::shared_ptr<Number>(new Number());
-		node->type_ = "number";
-		node->setUpNumber(tokens[start], error);
-		return node;
+		store.programs_[key] = program;
 	}
 
-	// split at inflection point
-	std::shared_ptr<Token> node;
-	if (tokens[pos] == "+") {
-		node = std::shared_ptr<Plus>(new Plus());
+	return program;
+}
+
+template <typename Field>
+std::shared_ptr<compiledProgram<Field>> Model::compileProgram(const std::vector<lexToken>& tokens, const std::string& type, std::string& error) {
+	std::shared_ptr<compiledProgram<Field>> program(new compiledProgram<Field>());
+	if constexpr (std::is_same_v<Field, residue<0>>) {
+		program->modulus_ = residue<0>::modulus();
 	}
-	else if (tokens[pos] == "-") {
-		node = std::shared_ptr<Minus>(new Minus());
+	nodeArena<Token<Field>>& nodes = program->nodes_;
+	Token<Field>* calc_tree = getCalcTree<Field>(tokens, nodes, type, error);
+	if (error != "") {
+		return nullptr;
 	}
-	else if (tokens[pos] == "*") {
-		node = std::shared_ptr<Multiply>(new Multiply());
+
+	if (calc_tree->kind_ == commaNode) {
+		error = "Syntax error: comma outside of a function";
+		return nullptr;
 	}
-	else if (tokens[pos] == "/") {
-		node = std::shared_ptr<Divide>(new Divide());
+
+	// the tree is shared first, so that the rewrites know which subtrees have several readers,
+	// and again after them, since they may build equal subtrees
+	subtreeTable& table = getStore<Field>(type).subtrees_;
+	std::unordered_map<size_t, Token<Field>*> subtrees;
+	calc_tree = shareSubtrees(calc_tree, table, subtrees);
+
+	std::set<const Token<Field>*> counted;
+	program->cubic_before_ = countCubic(calc_tree, counted);
+
+	std::map<const Token<Field>*, int> readers;
+	std::map<const Token<Field>*, Token<Field>*> simplified;
+	countReaders(calc_tree, readers);
+	calc_tree = simplifyTree(calc_tree, nodes, readers, simplified, program->rewrites_);
+
+	subtrees.clear();
+	calc_tree = shareSubtrees(calc_tree, table, subtrees);
+	counted.clear();
+	program->cubic_after_ = countCubic(calc_tree, counted);
+
+	printTree(calc_tree);
+
+	std::map<const Token<Field>*, int> registers;
+	addSteps(calc_tree, registers, *program);
+	keepReusedOutOfCache(program->steps_);
+	resolveOpcodes(program->steps_);
+
+	return program;
+}
+
+// clear the registers of a program run before, read the variables again and renew the keys,
+// which carry the versions of the variables
+template <typename Field>
+bool Model::bindProgram(compiledProgram<Field>& program, const std::string& type, std::string& error) {
+	for (programStep<Field>& step : program.steps_) {
+		Token<Field>& node = *step.node_;
+		if (step.variable_ != -1) {
+			std::shared_ptr<const Matrix<Field>> matrix;
+			if (!getVariable(step.variable_, type, matrix, error)) {
+				return false;
+			}
+			node.setUpView(matrix);
+			node.key_ = getVariableKey<Field>(step.variable_, type);
+			continue;
+		}
+
+		if (node.kind_ == numberNode) {
+			continue;
+		}
+
+		node.is_ans_number_ = false;
+		node.ans_number_ = Field(0);
+		node.ans_matrix_ = Matrix<Field>();
+		node.ans_factors_.clear();
+		node.ans_views_.clear();
+		node.is_in_place_ = false;
+		if (node.kind_ == solveNode) {
+			Solve<Field>& solve = static_cast<Solve<Field>&>(node);
+			solve.options_ = solve_options_;
+			solve.iterations_ = 0;
+			solve.residual_ = 0;
+		}
+		node.key_ = getSubtreeKey(node, getStore<Field>(type).subtrees_);
 	}
-	else if (tokens[pos] == "^") {
-		node = std::shared_ptr<Power>(new Power());
+
+	return true;
+}
+
+// steps run concurrently on the pool, each one as soon as the registers it reads are ready
+template <typename Field>
+struct programRun {
+	programRun(size_t size): waiting_(size), unread_(size), reads_(size), readers_(size), dependents_(size),
+							 chained_(size), errors_(size), is_failed_(size, false) {}
+
+	std::vector<std::atomic<size_t>> waiting_; // operands of the step which are not ready
+	std::vector<std::atomic<size_t>> unread_; // steps which still have to read the register
+	std::vector<std::vector<int>> reads_; // registers read by the step
+	std::vector<std::vector<int>> readers_; // steps reading the register, in order
+	std::vector<std::vector<int>> dependents_; // steps with the register as an operand
+	std::vector<std::vector<int>> chained_; // readers which run after the step, since they may change the same answer
+	std::vector<std::string> errors_;
+	std::vector<char> is_failed_; // whether the step or one of its operands failed
+	std::mutex mutex_; // guards chained_ and the cache
+	taskGroup group_;
+};
+
+// a reader may write out a kronecker product or assemble the pieces of a view in place,
+// so the readers of such an answer run one after another, in the order of the program
+template <typename Field>
+static void chainReaders(programRun<Field>& run, const Token<Field>& node, int index) {
+	const std::vector<int>& readers = run.readers_[index];
+	bool is_changed_by_readers = node.isKronecker() || node.isView() && !isWholeView(node.ans_views_);
+	if (!is_changed_by_readers || readers.size() < 2) {
+		return;
 	}
-	else if (tokens[pos] == "tr") {
-		node = std::shared_ptr<Trace>(new Trace());
+
+	std::lock_guard<std::mutex> lock(run.mutex_);
+	for (size_t k = 1; k < readers.size(); ++k) {
+		++run.waiting_[readers[k]];
+		run.chained_[readers[k - 1]].push_back(readers[k]);
 	}
-	else if (tokens[pos] == "det") {
-		node = std::shared_ptr<Determinant>(new Determinant());
+}
+
+// run the opcode of the step straight on the answers of its operands, whose kinds and shapes were
+// checked when the program was compiled; false if an operand is kept as a kronecker product or as
+// pieces of views, then the step calls calc
+template <typename Field>
+static bool runOpcode(const programStep<Field>& step, Token<Field>& node, std::string& error) {
+	Token<Field>& left = *node.left_;
+	Token<Field>& right = node.right_ ? *node.right_ : left;
+	auto isDense = [](const Token<Field>& operand) {
+		return operand.is_ans_number_ || !operand.isKronecker() && (!operand.isView() || isWholeView(operand.ans_views_));
+	};
+	if (!isDense(left) || !isDense(right)) {
+		return false;
 	}
-	else if (tokens[pos] == "rk") {
-		node = std::shared_ptr<Rank>(new Rank());
+
+	node.is_ans_number_ = step.kind_ == numberAnswer;
+	switch (step.opcode_) {
+	case addNumbers:
+		node.ans_number_ = left.ans_number_ + right.ans_number_;
+		return true;
+	case subtractNumbers:
+		node.ans_number_ = left.ans_number_ - right.ans_number_;
+		return true;
+	case multiplyNumbers:
+		node.ans_number_ = left.ans_number_ * right.ans_number_;
+		return true;
+	case divideNumbers:
+		if (fieldTraits<Field>::isZero(right.ans_number_)) {
+			error = "Semantic error: can not divide by 0";
+			return true;
+		}
+		node.ans_number_ = left.ans_number_ / right.ans_number_;
+		return true;
+	case addMatrices:
+		if (takeMatrix(node, left, right)) {
+			node.ans_matrix_ += right.matrix();
+		}
+		else if (takeMatrix(node, right, left)) {
+			node.ans_matrix_ += left.matrix();
+		}
+		else {
+			node.ans_matrix_ = left.matrix() + right.matrix();
+		}
+		return true;
+	case subtractMatrices:
+		if (takeMatrix(node, left, right)) {
+			node.ans_matrix_ -= right.matrix();
+		}
+		else if (takeMatrix(node, right, left)) {
+			makeView(left);
+			subtractFromViews(node.ans_matrix_, left.ans_views_);
+		}
+		else {
+			node.ans_matrix_ = left.matrix() - right.matrix();
+		}
+		return true;
+	case scaleMatrix: {
+		Token<Field>& number = left.is_ans_number_ ? left : right;
+		Token<Field>& matrix = left.is_ans_number_ ? right : left;
+		if (takeMatrix(node, matrix, number)) {
+			node.ans_matrix_ *= number.ans_number_;
+		}
+		else {
+			node.ans_matrix_ = number.ans_number_ * matrix.matrix();
+		}
+		return true;
+	}
+	case multiplyMatrices:
+		node.ans_matrix_ = multiply(left.matrix(), right.matrix());
+		return true;
+	case traceMatrix:
+		node.ans_number_ = left.matrix().trace();
+		return true;
+	case determinantMatrix:
+		node.ans_number_ = determinant(left.matrix());
+		return true;
+	default:
+		return false;
 	}
-	else if (tokens[pos] == "trans") {
-		node = std::shared_ptr<Transpose>(new Transpose());
+}
+
+// a first pass from the answer down looks the registers up in the cache, the operands of a
+// register found there are not needed unless another register needs them; then the needed
+// registers are computed as a graph of tasks, independent subtrees at the same time; the answer
+// of a register is released once its last reader has finished, and a reader which is the last
+// one may take over its storage; the error of the first failed step in the order of the program
+// is reported, as if the steps ran one after another; once the evaluation is cancelled the steps
+// left fail without being computed
+template <typename Field>
+void Model::runProgram(compiledProgram<Field>& program, resultCache<Field>& cache, std::string& error) {
+	// the tasks of the run take the modulus of the program from this thread
+	modulusScope scope(std::is_same_v<Field, residue<0>> ? program.modulus_ : residue<0>::modulus());
+	std::vector<programStep<Field>>& steps = program.steps_;
+	std::vector<bool> is_needed(steps.size(), false);
+	std::vector<bool> is_found(steps.size(), false);
+	is_needed.back() = true;
+
+	for (size_t i = steps.size(); i-- > 0;) {
+		if (!is_needed[i]) {
+			continue;
+		}
+
+		Token<Field>& node = *steps[i].node_;
+		cachedResult<Field> result;
+		if (steps[i].is_cached_ && cache.find(node.key_, result)) {
+			node.is_ans_number_ = result.is_ans_number_;
+			node.ans_number_ = result.ans_number_;
+			node.ans_factors_ = result.ans_factors_;
+			node.ans_views_ = result.ans_views_;
+			is_found[i] = true;
+			continue;
+		}
+
+		if (steps[i].left_ != -1) {
+			is_needed[steps[i].left_] = true;
+		}
+		if (steps[i].right_ != -1) {
+			is_needed[steps[i].right_] = true;
+		}
 	}
-	else if (tokens[pos] == "inv") {
-		node = std::shared_ptr<Inverse>(new Inverse());
+
+	std::vector<bool> is_computed(steps.size(), false);
+	for (size_t i = 0; i < steps.size(); ++i) {
+		is_computed[i] = is_needed[i] && !is_found[i] && steps[i].node_->left_;
 	}
 
-	node->type_ = tokens[pos];
+	programRun<Field> run(steps.size());
+	for (size_t i = 0; i < steps.size(); ++i) {
+		if (!is_computed[i]) {
+			continue;
+		}
 
-	if (tokens[pos].length() == 1) {
-		node->left_ = getCalcTree(tokens, start, pos, error);
-		node->right_ = getCalcTree(tokens, pos + 1, end, error);
-	}
-	else {
-		node->left_ = getCalcTree(tokens, start + 1, end, error);
-		node->right_ = nullptr;
+		int left = steps[i].left_;
+		int right = steps[i].right_;
+		for (int operand : {left, right == left ? -1 : right}) {
+			if (operand != -1 && is_computed[operand]) {
+				++run.waiting_[i];
+				run.dependents_[operand].push_back(i);
+			}
+		}
+		if (steps[i].node_->kind_ != commaNode) {
+			getReads(steps, i, run.reads_[i]);
+			for (int operand : run.reads_[i]) {
+				++run.unread_[operand];
+				run.readers_[operand].push_back(i);
+			}
+		}
 	}
 
-	node->type_ = tokens[pos];
+	std::function<void(int)> compute = [&](int i) {
+		programStep<Field>& step = steps[i];
+		Token<Field>& node = *step.node_;
+		std::string& step_error = run.errors_[i];
+		for (int operand : {step.left_, step.right_}) {
+			run.is_failed_[i] = run.is_failed_[i] || operand != -1 && run.is_failed_[operand];
+		}
+		if (!run.is_failed_[i] && isEvaluationCancelled()) {
+			step_error = "Evaluation cancelled";
+			run.is_failed_[i] = true;
+		}
 
-	return node;
-}
+		if (!run.is_failed_[i]) {
+			// the last reader may write into the storage of an operand
+			std::vector<Token<Field>*> last_reads;
+			for (Token<Field>* operand : {node.left_, node.right_}) {
+				int index = operand == node.left_ ? step.left_ : step.right_;
+				if (operand && run.unread_[index] == 1) {
+					operand->is_last_read_ = true;
+					last_reads.push_back(operand);
+				}
+			}
+
+			if (step.opcode_ == callStep || !runOpcode(step, node, step_error)) {
+				if (!node.acceptsKronecker()) {
+					materializeKronecker(node.left_, step_error);
+					materializeKronecker(node.right_, step_error);
+				}
+				if (!node.acceptsViews()) {
+					materializeViews(node.left_);
+					materializeViews(node.right_);
+				}
+				node.calc(step_error);
+			}
+			// a kernel stopped by the cancellation leaves a partial answer, which is never cached
+			if (step_error == "" && isEvaluationCancelled()) {
+				step_error = "Evaluation cancelled";
+			}
+			run.is_failed_[i] = step_error != "";
+
+			// the matrix is moved into shared storage, which the cache holds on to
+			if (step.is_cached_ && step_error == "") {
+				if (!node.isKronecker()) {
+					makeView(node);
+				}
+				cachedResult<Field> result;
+				result.is_ans_number_ = node.is_ans_number_;
+				result.ans_number_ = node.ans_number_;
+				result.ans_factors_ = node.ans_factors_;
+				result.ans_views_ = node.ans_views_;
+				std::lock_guard<std::mutex> lock(run.mutex_);
+				cache.insert(node.key_, result);
+			}
+
+			for (Token<Field>* operand : last_reads) {
+				operand->is_last_read_ = false;
+			}
+		}
+
+		if (!run.is_failed_[i]) {
+			chainReaders(run, node, i);
+		}
+		for (int operand : run.reads_[i]) {
+			if (--run.unread_[operand] == 0) {
+				releaseAnswer(*steps[operand].node_);
+			}
+		}
+
+		std::vector<int> next = run.dependents_[i];
+		{
+			std::lock_guard<std::mutex> lock(run.mutex_);
+			next.insert(next.end(), run.chained_[i].begin(), run.chained_[i].end());
+		}
+		for (int other : next) {
+			if (--run.waiting_[other] == 0) {
+				run.group_.run([&compute, other]() { compute(other); });
+			}
+		}
+	};
+
+	// registers ready before the run, leaves and answers found in the cache
+	for (size_t i = 0; i < steps.size(); ++i) {
+		if (is_needed[i] && !is_computed[i]) {
+			chainReaders(run, *steps[i].node_, i);
+		}
+	}
+	std::vector<int> ready;
+	for (size_t i = 0; i < steps.size(); ++i) {
+		if (is_computed[i] && run.waiting_[i] == 0) {
+			ready.push_back(i);
+		}
+	}
+	for (int i : ready) {
+		run.group_.run([&compute, i]() { compute(i); });
+	}
+	run.group_.wait();
 
-// calculate expression
-void Model::calc(std::shared_ptr<Token> tree, std::string& error) {
-	if (tree->left_) calc(tree->left_, error);
-	if (tree->right_) calc(tree->right_, error);
-	tree->calc(error);
+	for (size_t i = 0; i < steps.size() && error == ""; ++i) {
+		error = run.errors_[i];
+	}
 }
 
 // print out tree
-void Model::printTree(std::shared_ptr<Token> node) {
+template <typename Field>
+void Model::printTree(Token<Field>* node) {
 	if (node == nullptr) {
 		return;
 	}
 
-	std::cerr << node->type_ << std::endl;
+	std::cerr << NODE_NAMES[node->kind_] << std::endl;
 	printTree(node->left_);
 	printTree(node->right_);
 }
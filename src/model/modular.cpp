@@ -0,0 +1,232 @@
+#include "modular.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+// kernels for every prime, instantiated once at compile time
+
+using determinantKernel = size_t (*)(const std::vector<std::vector<long long>>&);
+using solveKernel = bool (*)(const std::vector<std::vector<long long>>&, size_t&, std::vector<size_t>&);
+
+template <size_t... I>
+std::array<determinantKernel, sizeof...(I)> makeDeterminantKernels(std::index_sequence<I...>) {
+	return {{ &determinantModulo<MODULAR_PRIMES[I]>... }};
+}
+
+template <size_t... I>
+std::array<solveKernel, sizeof...(I)> makeSolveKernels(std::index_sequence<I...>) {
+	return {{ &solveModulo<MODULAR_PRIMES[I]>... }};
+}
+
+static const std::array<determinantKernel, MODULAR_PRIMES.size()> determinant_kernels =
+	makeDeterminantKernels(std::make_index_sequence<MODULAR_PRIMES.size()>());
+static const std::array<solveKernel, MODULAR_PRIMES.size()> solve_kernels =
+	makeSolveKernels(std::make_index_sequence<MODULAR_PRIMES.size()>());
+
+// log2 of the smallest prime, every prime adds at least that many bits to the modulus
+static const double PRIME_BITS = std::log2(static_cast<double>(MODULAR_PRIMES.back()));
+
+// log2 of the hadamard bound: the product of euclidean norms of the rows
+static double hadamardBits(const std::vector<std::vector<long long>>& matrix, size_t columns) {
+	double bits = 0;
+	for (size_t i = 0; i < matrix.size(); ++i) {
+		double norm = 0;
+		for (size_t j = 0; j < columns; ++j) {
+			double value = static_cast<double>(matrix[i][j]);
+			norm += value * value;
+		}
+		bits += 0.5 * std::log2(std::max(norm, 1.0));
+	}
+
+	return bits;
+}
+
+// same bound taken over the columns of a square matrix
+static double hadamardColumnBits(const std::vector<std::vector<long long>>& matrix) {
+	std::vector<double> norms(matrix.size(), 0);
+	for (size_t i = 0; i < matrix.size(); ++i) {
+		for (size_t j = 0; j < matrix.size(); ++j) {
+			double value = static_cast<double>(matrix[i][j]);
+			norms[j] += value * value;
+		}
+	}
+
+	double bits = 0;
+	for (double norm : norms) {
+		bits += 0.5 * std::log2(std::max(norm, 1.0));
+	}
+
+	return bits;
+}
+
+// inverse of value modulo a prime by fermat's little theorem
+static uint64_t inverseModulo(uint64_t value, uint64_t prime) {
+	uint64_t result = 1;
+	uint64_t power = prime - 2;
+	value %= prime;
+	while (power != 0) {
+		if (power & 1) {
+			result = result * value % prime;
+		}
+		value = value * value % prime;
+		power >>= 1;
+	}
+
+	return result;
+}
+
+// chinese remainder theorem: extend value mod modulus with rest mod prime,
+// modulus_inverse is the inverse of modulus modulo prime
+static void combine(bigInteger& value, const bigInteger& modulus, uint64_t modulus_inverse, uint64_t rest, uint64_t prime) {
+	uint64_t koef = (rest + prime - value.modulo(prime)) % prime * modulus_inverse % prime;
+
+	value += modulus * bigInteger(static_cast<long long>(koef));
+}
+
+// representative of value in (-modulus / 2, modulus / 2]
+static bigInteger symmetric(const bigInteger& value, const bigInteger& modulus) {
+	if (value + value > modulus) {
+		return value - modulus;
+	}
+
+	return value;
+}
+
+// find numerator / denominator congruent to value with both bounded by sqrt(modulus / 2)
+static bool rationalReconstruction(const bigInteger& value, const bigInteger& modulus, bigInteger& numerator, bigInteger& denominator) {
+	bigInteger r0 = modulus;
+	bigInteger r1 = value;
+	bigInteger t0 = 0;
+	bigInteger t1 = 1;
+	const bigInteger two = 2;
+
+	while (two * r1 * r1 > modulus) {
+		bigInteger quotient;
+		bigInteger remainder;
+		bigInteger::divide(r0, r1, quotient, remainder);
+		r0 = r1;
+		r1 = remainder;
+		bigInteger t = t0 - quotient * t1;
+		t0 = t1;
+		t1 = t;
+	}
+
+	if (t1.isZero() || two * t1 * t1 > modulus) {
+		return false;
+	}
+
+	numerator = t1.isNegative() ? -r1 : r1;
+	denominator = t1.abs();
+
+	return gcd(numerator, denominator) == bigInteger(1);
+}
+
+bool modularDeterminant(const std::vector<std::vector<long long>>& matrix, bigInteger& determinant, std::string& error) {
+	size_t n = matrix.size();
+
+	// the bound on |det| decides how many primes are needed
+	double needed_bits = std::min(hadamardBits(matrix, n), hadamardColumnBits(matrix)) + 1;
+	size_t primes = static_cast<size_t>(std::ceil(needed_bits / PRIME_BITS));
+	primes = std::max<size_t>(primes, 1);
+	if (primes > MODULAR_PRIMES.size()) {
+		error = "Semantic error: entries are too large for the exact determinant";
+		return false;
+	}
+
+	// the primes finished are the progress
+	std::vector<size_t> rests(primes);
+	std::atomic<size_t> finished{0};
+	parallelFor(0, primes, [&](size_t i) {
+		rests[i] = determinant_kernels[i](matrix);
+		reportProgress(++finished, primes);
+	});
+	if (isEvaluationCancelled()) {
+		error = "Evaluation cancelled";
+		return false;
+	}
+
+	bigInteger value = 0;
+	bigInteger modulus = 1;
+	for (size_t i = 0; i < primes; ++i) {
+		size_t prime = MODULAR_PRIMES[i];
+		combine(value, modulus, inverseModulo(modulus.modulo(prime), prime), rests[i], prime);
+		modulus *= bigInteger(static_cast<long long>(prime));
+	}
+
+	determinant = symmetric(value, modulus);
+
+	return true;
+}
+
+bool modularSolve(const std::vector<std::vector<long long>>& system,
+				  std::vector<std::pair<bigInteger, bigInteger>>& solution,
+				  std::string& error) {
+	size_t n = system.size();
+
+	// numerators are cramer determinants of [A | b] and denominators divide det(A),
+	// reconstruction is guaranteed once the modulus exceeds 2 * bound^2
+	double needed_bits = 2 * hadamardBits(system, n + 1) + 1;
+
+	std::vector<bigInteger> values(n, 0);
+	bigInteger modulus = 1;
+	double covered_bits = 0;
+	size_t next = 0;
+	bool is_singular = true;
+
+	// run batches of primes in parallel until the bound is covered, unlucky primes
+	// (those dividing det(A)) are dropped and replaced by the next batch
+	while (covered_bits <= needed_bits) {
+		size_t batch = static_cast<size_t>(std::ceil((needed_bits - covered_bits) / PRIME_BITS));
+		batch = std::max<size_t>(batch, 1);
+		if (next + batch > MODULAR_PRIMES.size()) {
+			error = "Semantic error: coefficients are too large for the exact solver";
+			return false;
+		}
+
+		std::vector<size_t> determinants(batch);
+		std::vector<std::vector<size_t>> rests(batch);
+		std::vector<char> is_lucky(batch);
+		parallelFor(0, batch, [&](size_t i) {
+			is_lucky[i] = solve_kernels[next + i](system, determinants[i], rests[i]);
+		});
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+
+		for (size_t i = 0; i < batch; ++i) {
+			if (!is_lucky[i]) {
+				continue;
+			}
+			is_singular = false;
+
+			size_t prime = MODULAR_PRIMES[next + i];
+			uint64_t modulus_inverse = inverseModulo(modulus.modulo(prime), prime);
+			for (size_t j = 0; j < n; ++j) {
+				combine(values[j], modulus, modulus_inverse, rests[i][j], prime);
+			}
+			modulus *= bigInteger(static_cast<long long>(prime));
+			covered_bits += std::log2(static_cast<double>(prime));
+		}
+
+		// det(A) vanishing modulo primes whose product exceeds the bound means it is zero
+		if (is_singular && (next + batch) * PRIME_BITS > needed_bits) {
+			return false;
+		}
+		next += batch;
+	}
+
+	solution.resize(n);
+	for (size_t j = 0; j < n; ++j) {
+		if (!rationalReconstruction(values[j], modulus, solution[j].first, solution[j].second)) {
+			error = "Semantic error: rational reconstruction failed";
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,227 @@
+#include "parallel.h"
+#include "residue.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+size_t workersCount() {
+	static const size_t count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	return count;
+}
+
+// pool of workers
+
+struct taskQueue {
+	std::mutex mutex_;
+	std::deque<std::function<void()>> tasks_;
+};
+
+// the calling thread works too, so the pool starts one thread less than there are workers
+class workerPool {
+public:
+	static workerPool& getPool();
+
+	~workerPool();
+
+	void push(std::function<void()> task);
+
+	// run one queued task, false if there is none
+	bool runOne();
+
+	// sleep until a task is queued or none of the pending ones is left
+	void sleep(const std::atomic<size_t>& pending);
+
+	// wake every sleeping thread, so that a waiting one sees its group has finished
+	void wakeAll();
+
+private:
+	workerPool();
+
+	void work(size_t index);
+	size_t getQueueIndex() const;
+
+	std::vector<std::unique_ptr<taskQueue>> queues_; // one for every thread of the pool, the last one for the other threads
+	std::vector<std::thread> threads_;
+	std::mutex sleep_mutex_;
+	std::condition_variable wake_;
+	std::atomic<size_t> queued_{0}; // tasks in the queues, counted before they are pushed
+	bool is_stopping_ = false;
+};
+
+// queue of the current thread, -1 outside of the pool
+static thread_local int worker_index = -1;
+
+workerPool& workerPool::getPool() {
+	static workerPool pool;
+
+	return pool;
+}
+
+workerPool::workerPool() {
+	size_t threads = workersCount() - 1;
+	for (size_t i = 0; i <= threads; ++i) {
+		queues_.emplace_back(new taskQueue());
+	}
+	for (size_t i = 0; i < threads; ++i) {
+		threads_.emplace_back(&workerPool::work, this, i);
+	}
+}
+
+workerPool::~workerPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		is_stopping_ = true;
+	}
+	wake_.notify_all();
+
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+}
+
+size_t workerPool::getQueueIndex() const {
+	return worker_index == -1 ? queues_.size() - 1 : worker_index;
+}
+
+void workerPool::push(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		++queued_;
+	}
+
+	taskQueue& queue = *queues_[getQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex_);
+		queue.tasks_.push_back(std::move(task));
+	}
+	wake_.notify_one();
+}
+
+// the newest task of the own queue, which is the most likely to have its data in the cache,
+// otherwise the oldest task of another queue, which is the most likely to split further
+bool workerPool::runOne() {
+	size_t index = getQueueIndex();
+	std::function<void()> task;
+	for (size_t shift = 0; shift < queues_.size() && !task; ++shift) {
+		taskQueue& queue = *queues_[(index + shift) % queues_.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex_);
+		if (queue.tasks_.empty()) {
+			continue;
+		}
+
+		if (shift == 0) {
+			task = std::move(queue.tasks_.back());
+			queue.tasks_.pop_back();
+		}
+		else {
+			task = std::move(queue.tasks_.front());
+			queue.tasks_.pop_front();
+		}
+	}
+
+	if (!task) {
+		return false;
+	}
+
+	--queued_;
+	task();
+
+	return true;
+}
+
+void workerPool::sleep(const std::atomic<size_t>& pending) {
+	std::unique_lock<std::mutex> lock(sleep_mutex_);
+	wake_.wait(lock, [this, &pending]() { return is_stopping_ || queued_ > 0 || pending == 0; });
+}
+
+void workerPool::wakeAll() {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+	}
+	wake_.notify_all();
+}
+
+void workerPool::work(size_t index) {
+	worker_index = index;
+	while (true) {
+		if (runOne()) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		wake_.wait(lock, [this]() { return is_stopping_ || queued_ > 0; });
+		if (is_stopping_) {
+			return;
+		}
+	}
+}
+
+// groups of tasks
+
+// residue<0> reads its modulus from the thread, so the task takes the one of the thread which gave it;
+// the last task to finish touches only the pool after its count drops, since the waiting thread
+// may return and destroy the group right away
+void taskGroup::run(std::function<void()> task) {
+	++pending_;
+
+	size_t modulus = residue<0>::modulus();
+	workerPool::getPool().push([this, modulus, task = std::move(task)]() {
+		{
+			modulusScope scope(modulus);
+			task();
+		}
+
+		if (--pending_ == 0) {
+			workerPool::getPool().wakeAll();
+		}
+	});
+}
+
+// the waiting thread sleeps with the workers, so a task pushed by any group wakes it as well,
+// also one of a group nested in the tasks left, which would otherwise only run on the workers
+void taskGroup::wait() {
+	workerPool& pool = workerPool::getPool();
+	while (pending_ > 0) {
+		if (!pool.runOne()) {
+			pool.sleep(pending_);
+		}
+	}
+}
+
+// contiguous chunks, the calling thread takes the first one and helps with the others
+void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body) {
+	if (begin >= end) {
+		return;
+	}
+
+	size_t workers = std::min(workersCount(), end - begin);
+	if (workers == 1) {
+		for (size_t i = begin; i < end; ++i) {
+			body(i);
+		}
+		return;
+	}
+
+	size_t chunk = (end - begin + workers - 1) / workers;
+	taskGroup group;
+	for (size_t start = begin + chunk; start < end; start += chunk) {
+		size_t finish = std::min(end, start + chunk);
+		group.run([&body, start, finish]() {
+			for (size_t i = start; i < finish; ++i) {
+				body(i);
+			}
+		});
+	}
+
+	for (size_t i = begin; i < std::min(end, begin + chunk); ++i) {
+		body(i);
+	}
+
+	group.wait();
+}
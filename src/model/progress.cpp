@@ -0,0 +1,22 @@
+#include "progress.h"
+
+// the kernels run on the workers of the pool, so the progress is one for the whole program
+static std::atomic<evaluationProgress*> current_progress{nullptr};
+
+void setEvaluationProgress(evaluationProgress* progress) {
+	current_progress = progress;
+}
+
+bool isEvaluationCancelled() {
+	evaluationProgress* progress = current_progress.load(std::memory_order_relaxed);
+
+	return progress && progress->is_cancelled_.load(std::memory_order_relaxed);
+}
+
+void reportProgress(size_t done, size_t total) {
+	evaluationProgress* progress = current_progress.load(std::memory_order_relaxed);
+	if (progress) {
+		progress->done_.store(done, std::memory_order_relaxed);
+		progress->total_.store(total, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,335 @@
+#include "rational.h"
+
+#include <climits>
+#include <numeric>
+
+// inline values never use LLONG_MIN, so that negation and gcd can not overflow
+
+static bool fitsInline(long long value) {
+	return value != LLONG_MIN;
+}
+
+// constructors and operator =
+
+rationalNumber::rationalNumber(long long value) {
+	setInline(value, 1);
+}
+
+rationalNumber::rationalNumber(long long numerator, long long denominator) {
+	setInline(numerator, denominator);
+}
+
+rationalNumber::rationalNumber(const bigInteger& numerator, const bigInteger& denominator) {
+	setBig(numerator, denominator);
+}
+
+rationalNumber::rationalNumber(const rationalNumber& other): numerator_(other.numerator_),
+															  denominator_(other.denominator_),
+															  big_(other.big_ ? new bigPart(*other.big_) : nullptr) {}
+
+rationalNumber& rationalNumber::operator=(const rationalNumber& other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	numerator_ = other.numerator_;
+	denominator_ = other.denominator_;
+	big_.reset(other.big_ ? new bigPart(*other.big_) : nullptr);
+
+	return *this;
+}
+
+// arithmetic assignments, every inline operation falls back to big integers on overflow
+
+rationalNumber& rationalNumber::operator+=(const rationalNumber& rhs) {
+	if (!big_ && !rhs.big_) {
+		long long common = std::gcd(denominator_, rhs.denominator_);
+		long long lhs_factor = rhs.denominator_ / common;
+		long long rhs_factor = denominator_ / common;
+		long long first, second, numerator, denominator;
+		if (!__builtin_mul_overflow(numerator_, lhs_factor, &first) &&
+			!__builtin_mul_overflow(rhs.numerator_, rhs_factor, &second) &&
+			!__builtin_add_overflow(first, second, &numerator) &&
+			!__builtin_mul_overflow(denominator_, lhs_factor, &denominator)) {
+			setInline(numerator, denominator);
+			return *this;
+		}
+	}
+
+	setBig(numerator() * rhs.denominator() + rhs.numerator() * denominator(), denominator() * rhs.denominator());
+
+	return *this;
+}
+
+rationalNumber& rationalNumber::operator-=(const rationalNumber& rhs) {
+	*this += -rhs;
+
+	return *this;
+}
+
+rationalNumber& rationalNumber::operator*=(const rationalNumber& rhs) {
+	if (!big_ && !rhs.big_) {
+		// cross cancellation keeps the result reduced
+		long long first = std::gcd(numerator_, rhs.denominator_);
+		long long second = std::gcd(rhs.numerator_, denominator_);
+		long long numerator, denominator;
+		if (!__builtin_mul_overflow(numerator_ / first, rhs.numerator_ / second, &numerator) &&
+			!__builtin_mul_overflow(denominator_ / second, rhs.denominator_ / first, &denominator) &&
+			fitsInline(numerator)) {
+			numerator_ = numerator;
+			denominator_ = denominator;
+			return *this;
+		}
+	}
+
+	setBig(numerator() * rhs.numerator(), denominator() * rhs.denominator());
+
+	return *this;
+}
+
+rationalNumber& rationalNumber::operator/=(const rationalNumber& rhs) {
+	if (!big_ && !rhs.big_) {
+		long long first = std::gcd(numerator_, rhs.numerator_);
+		long long second = std::gcd(denominator_, rhs.denominator_);
+		long long numerator, denominator;
+		if (!__builtin_mul_overflow(numerator_ / first, rhs.denominator_ / second, &numerator) &&
+			!__builtin_mul_overflow(denominator_ / second, rhs.numerator_ / first, &denominator)) {
+			setInline(numerator, denominator);
+			return *this;
+		}
+	}
+
+	setBig(numerator() * rhs.denominator(), denominator() * rhs.numerator());
+
+	return *this;
+}
+
+// unary minus
+
+rationalNumber rationalNumber::operator-() const {
+	if (!big_) {
+		return rationalNumber(-numerator_, denominator_);
+	}
+
+	return rationalNumber(-big_->numerator_, big_->denominator_);
+}
+
+// sign and representation
+
+bool rationalNumber::isZero() const {
+	return !big_ && numerator_ == 0;
+}
+
+bool rationalNumber::isNegative() const {
+	return big_ ? big_->numerator_.isNegative() : numerator_ < 0;
+}
+
+bool rationalNumber::isInteger() const {
+	return big_ ? big_->denominator_ == bigInteger(1) : denominator_ == 1;
+}
+
+bool rationalNumber::isInline() const {
+	return !big_;
+}
+
+bigInteger rationalNumber::numerator() const {
+	return big_ ? big_->numerator_ : bigInteger(numerator_);
+}
+
+bigInteger rationalNumber::denominator() const {
+	return big_ ? big_->denominator_ : bigInteger(denominator_);
+}
+
+// presentations
+
+double rationalNumber::toDouble() const {
+	if (!big_) {
+		return static_cast<double>(numerator_) / denominator_;
+	}
+
+	return big_->numerator_.toDouble() / big_->denominator_.toDouble();
+}
+
+std::string rationalNumber::toString() const {
+	if (isInteger()) {
+		return numerator().toString();
+	}
+
+	return numerator().toString() + "/" + denominator().toString();
+}
+
+int rationalNumber::compare(const rationalNumber& lhs, const rationalNumber& rhs) {
+	if (!lhs.big_ && !rhs.big_) {
+		__int128 first = static_cast<__int128>(lhs.numerator_) * rhs.denominator_;
+		__int128 second = static_cast<__int128>(rhs.numerator_) * lhs.denominator_;
+		return first < second ? -1 : (first > second ? 1 : 0);
+	}
+
+	bigInteger difference = lhs.numerator() * rhs.denominator() - rhs.numerator() * lhs.denominator();
+	if (difference.isZero()) {
+		return 0;
+	}
+
+	return difference.isNegative() ? -1 : 1;
+}
+
+// normalization
+
+void rationalNumber::setBig(bigInteger numerator, bigInteger denominator) {
+	bigInteger common = gcd(numerator, denominator);
+	if (common != bigInteger(1)) {
+		numerator /= common;
+		denominator /= common;
+	}
+	if (denominator.isNegative()) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	if (numerator.fitsInLongLong() && denominator.fitsInLongLong() &&
+		fitsInline(numerator.toLongLong()) && fitsInline(denominator.toLongLong())) {
+		numerator_ = numerator.toLongLong();
+		denominator_ = denominator.toLongLong();
+		big_.reset();
+		return;
+	}
+
+	big_.reset(new bigPart{numerator, denominator});
+}
+
+void rationalNumber::setInline(long long numerator, long long denominator) {
+	if (!fitsInline(numerator) || !fitsInline(denominator)) {
+		setBig(numerator, denominator);
+		return;
+	}
+
+	long long common = std::gcd(numerator, denominator);
+	numerator /= common;
+	denominator /= common;
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	numerator_ = numerator;
+	denominator_ = denominator;
+	big_.reset();
+}
+
+// more arithmetics
+
+rationalNumber operator+(const rationalNumber& lhs, const rationalNumber& rhs) {
+	rationalNumber copy = lhs;
+	copy += rhs;
+
+	return copy;
+}
+
+rationalNumber operator-(const rationalNumber& lhs, const rationalNumber& rhs) {
+	rationalNumber copy = lhs;
+	copy -= rhs;
+
+	return copy;
+}
+
+rationalNumber operator*(const rationalNumber& lhs, const rationalNumber& rhs) {
+	rationalNumber copy = lhs;
+	copy *= rhs;
+
+	return copy;
+}
+
+rationalNumber operator/(const rationalNumber& lhs, const rationalNumber& rhs) {
+	rationalNumber copy = lhs;
+	copy /= rhs;
+
+	return copy;
+}
+
+// comparisons
+
+bool operator==(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return rationalNumber::compare(lhs, rhs) == 0;
+}
+
+bool operator!=(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return !(lhs == rhs);
+}
+
+bool operator<(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return rationalNumber::compare(lhs, rhs) < 0;
+}
+
+bool operator>(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return rhs < lhs;
+}
+
+bool operator<=(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return !(lhs > rhs);
+}
+
+bool operator>=(const rationalNumber& lhs, const rationalNumber& rhs) {
+	return !(lhs < rhs);
+}
+
+// parse "a" or "a.b" into numerator and a power of ten denominator
+static bool parseDecimal(const std::string& text, bigInteger& numerator, bigInteger& denominator) {
+	numerator = 0;
+	denominator = 1;
+	bool is_negative = !text.empty() && text[0] == '-';
+	bool after_point = false;
+	bool has_digits = false;
+
+	for (size_t i = is_negative ? 1 : 0; i < text.length(); ++i) {
+		if (text[i] == '.' && !after_point) {
+			after_point = true;
+		}
+		else if (text[i] >= '0' && text[i] <= '9') {
+			numerator = numerator * bigInteger(10) + bigInteger(text[i] - '0');
+			if (after_point) {
+				denominator *= bigInteger(10);
+			}
+			has_digits = true;
+		}
+		else {
+			return false;
+		}
+	}
+
+	if (is_negative) {
+		numerator = -numerator;
+	}
+
+	return has_digits;
+}
+
+bool parseRational(const std::string& text, rationalNumber& number) {
+	size_t slash = text.find('/');
+	bigInteger numerator;
+	bigInteger denominator;
+	if (!parseDecimal(text.substr(0, slash), numerator, denominator)) {
+		return false;
+	}
+
+	if (slash != std::string::npos) {
+		bigInteger second_numerator;
+		bigInteger second_denominator;
+		if (!parseDecimal(text.substr(slash + 1), second_numerator, second_denominator) || second_numerator.isZero()) {
+			return false;
+		}
+		numerator *= second_denominator;
+		denominator *= second_numerator;
+	}
+
+	number = rationalNumber(numerator, denominator);
+
+	return true;
+}
+
+// output
+
+std::ostream& operator<<(std::ostream& out, const rationalNumber& number) {
+	out << number.toString();
+
+	return out;
+}
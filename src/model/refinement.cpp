@@ -0,0 +1,164 @@
+#include "refinement.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// same limit on refinement steps as lapack's dsgesv
+static const size_t MAX_REFINEMENT_STEPS = 30;
+
+// rows updated per elimination step before it is worth splitting them between threads
+static const size_t PARALLEL_ROWS = 128;
+
+// lu factorization with partial pivoting in place, permutation[i] is the original row of row i;
+// pivots below tolerance mean the matrix is singular as far as float can tell
+static bool factorize(Matrix<float>& lu, std::vector<size_t>& permutation, float tolerance, std::string& error) {
+	size_t n = lu.getRow();
+	permutation.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		permutation[i] = i;
+	}
+
+	for (size_t k = 0; k < n; ++k) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(k, n);
+
+		size_t pivot = k;
+		for (size_t i = k + 1; i < n; ++i) {
+			if (std::abs(lu[i][k]) > std::abs(lu[pivot][k])) {
+				pivot = i;
+			}
+		}
+		if (std::abs(lu[pivot][k]) <= tolerance) {
+			return false;
+		}
+		if (pivot != k) {
+			std::swap_ranges(lu[k], lu[k] + n, lu[pivot]);
+			std::swap(permutation[k], permutation[pivot]);
+		}
+
+		const float* pivot_row = lu[k];
+		auto update = [&](size_t i) {
+			float* row = lu[i];
+			float koef = row[k] / pivot_row[k];
+			row[k] = koef;
+			for (size_t j = k + 1; j < n; ++j) {
+				row[j] -= koef * pivot_row[j];
+			}
+		};
+
+		if (n - k - 1 >= PARALLEL_ROWS) {
+			parallelFor(k + 1, n, update);
+		}
+		else {
+			for (size_t i = k + 1; i < n; ++i) {
+				update(i);
+			}
+		}
+	}
+
+	return true;
+}
+
+// solve L U x = P rhs with the float factors
+static void substitute(const Matrix<float>& lu, const std::vector<size_t>& permutation,
+					   const std::vector<double>& rhs, std::vector<float>& x) {
+	size_t n = lu.getRow();
+	x.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		const float* row = lu[i];
+		float value = rhs[permutation[i]];
+		for (size_t j = 0; j < i; ++j) {
+			value -= row[j] * x[j];
+		}
+		x[i] = value;
+	}
+
+	for (size_t i = n; i-- > 0;) {
+		const float* row = lu[i];
+		float value = x[i];
+		for (size_t j = i + 1; j < n; ++j) {
+			value -= row[j] * x[j];
+		}
+		x[i] = value / row[i];
+	}
+}
+
+bool refinedSolve(const Matrix<double>& system, std::vector<double>& solution, size_t& steps, double& residual,
+				  std::string& error) {
+	size_t n = system.getRow();
+	steps = 0;
+	residual = 0;
+
+	Matrix<float> lu(n, n);
+	std::vector<double> rhs(n);
+	double norm = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double row_norm = 0;
+		for (size_t j = 0; j < n; ++j) {
+			lu[i][j] = static_cast<float>(system[i][j]);
+			row_norm += std::abs(system[i][j]);
+		}
+		rhs[i] = system[i][n];
+		norm = std::max(norm, row_norm);
+	}
+
+	std::vector<size_t> permutation;
+	if (!factorize(lu, permutation, n * FLT_EPSILON * norm, error)) {
+		return false;
+	}
+
+	std::vector<float> correction;
+	substitute(lu, permutation, rhs, correction);
+	solution.assign(correction.begin(), correction.end());
+
+	// stop once the residual is at the level of double rounding errors:
+	// ||b - A x|| <= sqrt(n) * eps * ||A|| * ||x||
+	std::vector<double> rest(n);
+	double previous = INFINITY;
+	for (;;) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(steps, MAX_REFINEMENT_STEPS);
+
+		for (size_t i = 0; i < n; ++i) {
+			const double* row = system[i];
+			double value = row[n];
+			for (size_t j = 0; j < n; ++j) {
+				value -= row[j] * solution[j];
+			}
+			rest[i] = value;
+		}
+
+		double rest_norm = 0;
+		double solution_norm = 0;
+		for (size_t i = 0; i < n; ++i) {
+			rest_norm = std::max(rest_norm, std::abs(rest[i]));
+			solution_norm = std::max(solution_norm, std::abs(solution[i]));
+		}
+		residual = rest_norm;
+
+		if (rest_norm <= std::sqrt(static_cast<double>(n)) * DBL_EPSILON * norm * solution_norm) {
+			return true;
+		}
+
+		// a residual that stops shrinking means A is too ill-conditioned for float factors
+		if (steps == MAX_REFINEMENT_STEPS || (steps > 0 && !(rest_norm < 0.5 * previous))) {
+			return false;
+		}
+		previous = rest_norm;
+
+		substitute(lu, permutation, rest, correction);
+		for (size_t i = 0; i < n; ++i) {
+			solution[i] += correction[i];
+		}
+		++steps;
+	}
+}
@@ -0,0 +1,292 @@
+#include "sketch.h"
+#include "parallel.h"
+#include "progress.h"
+#include "svd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// seed of the Gaussian sketches of the user's matrices, sketches of the same matrix are reproducible
+static const unsigned long long SKETCH_SEED = 20240607;
+
+// power iterations applied to the sketch before the singular values are taken
+static const int POWER_ITERATIONS = 2;
+
+// iterations of the norm estimate before giving up
+static const int MAX_NORM_ITERATIONS = 200;
+
+// share of its length a row keeps after projection before it counts as rounding noise
+static const double NOISE_LEVEL = 1e-8;
+
+// entries of a matrix-vector product before its rows are split between threads
+static const size_t PARALLEL_ENTRIES = 1 << 16;
+
+// m x l matrix of independent standard normal entries
+static Matrix<double> gaussian(size_t m, size_t l, std::mt19937_64& generator) {
+	std::normal_distribution<double> distribution;
+	Matrix<double> result(m, l);
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t j = 0; j < l; ++j) {
+			result[i][j] = distribution(generator);
+		}
+	}
+
+	return result;
+}
+
+// y = A x and y = A^T x
+static void multiply(const Matrix<double>& a, const std::vector<double>& x, std::vector<double>& y) {
+	size_t m = a.getRow();
+	y.assign(m, 0);
+	auto body = [&](size_t i) {
+		const double* row = a[i];
+		double sum = 0;
+		for (size_t j = 0; j < a.getCol(); ++j) {
+			sum += row[j] * x[j];
+		}
+		y[i] = sum;
+	};
+
+	if (m * a.getCol() >= PARALLEL_ENTRIES) {
+		parallelFor(0, m, body);
+		return;
+	}
+	for (size_t i = 0; i < m; ++i) {
+		body(i);
+	}
+}
+
+static void multiplyTransposed(const Matrix<double>& a, const std::vector<double>& x, std::vector<double>& y) {
+	y.assign(a.getCol(), 0);
+	for (size_t i = 0; i < a.getRow(); ++i) {
+		const double* row = a[i];
+		for (size_t j = 0; j < a.getCol(); ++j) {
+			y[j] += row[j] * x[i];
+		}
+	}
+}
+
+static double norm(const std::vector<double>& x) {
+	double sum = 0;
+	for (double value : x) {
+		sum += value * value;
+	}
+
+	return std::sqrt(sum);
+}
+
+// orthonormalize the rows of y against the rows of basis and each other by gram-schmidt
+// applied twice, rows whose norm drops below cutoff are dropped; the rest are appended;
+// a row that lost nearly all of its length is rounding noise and is dropped as well,
+// two passes can not make it orthogonal
+static void extendBasis(Matrix<double>& basis, const Matrix<double>& y, double cutoff) {
+	size_t m = y.getCol();
+	std::vector<std::vector<double>> rows;
+	for (size_t i = 0; i < basis.getRow(); ++i) {
+		rows.emplace_back(basis[i], basis[i] + m);
+	}
+	size_t old_count = rows.size();
+
+	for (size_t i = 0; i < y.getRow(); ++i) {
+		std::vector<double> row(y[i], y[i] + m);
+		double original = norm(row);
+		for (int pass = 0; pass < 2; ++pass) {
+			for (const std::vector<double>& q : rows) {
+				double koef = 0;
+				for (size_t j = 0; j < m; ++j) {
+					koef += q[j] * row[j];
+				}
+				for (size_t j = 0; j < m; ++j) {
+					row[j] -= koef * q[j];
+				}
+			}
+		}
+
+		double length = norm(row);
+		if (length <= cutoff || length <= NOISE_LEVEL * original || rows.size() == m) {
+			continue;
+		}
+		for (double& value : row) {
+			value /= length;
+		}
+		rows.push_back(row);
+	}
+
+	if (rows.size() == old_count) {
+		return;
+	}
+	basis = Matrix<double>(rows);
+}
+
+bool powerNorm(const Matrix<double>& matrix, double tolerance, double& result, std::string& error) {
+	std::mt19937_64 generator(SKETCH_SEED);
+	std::normal_distribution<double> distribution;
+	std::vector<double> x(matrix.getCol());
+	for (double& value : x) {
+		value = distribution(generator);
+	}
+
+	std::vector<double> y;
+	double estimate = 0;
+	for (int iteration = 0; iteration < MAX_NORM_ITERATIONS; ++iteration) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(iteration, MAX_NORM_ITERATIONS);
+
+		double length = norm(x);
+		if (length == 0) {
+			result = 0;
+			return true;
+		}
+		for (double& value : x) {
+			value /= length;
+		}
+
+		// ||A x|| for a unit x grows towards ||A||_2, x <- A^T A x
+		multiply(matrix, x, y);
+		double next = norm(y);
+		multiplyTransposed(matrix, y, x);
+		if (std::abs(next - estimate) <= tolerance * next) {
+			result = next;
+			return true;
+		}
+		estimate = next;
+	}
+
+	result = estimate;
+	error = "Semantic error: norm estimate did not converge";
+	return false;
+}
+
+bool sketchRank(const Matrix<double>& matrix, double tolerance, size_t oversampling, size_t& rank, std::string& error) {
+	size_t m = matrix.getRow();
+	size_t n = matrix.getCol();
+	size_t limit = std::min(m, n);
+	double scale;
+	if (!powerNorm(matrix, 1e-3, scale, error)) {
+		return false;
+	}
+	if (scale == 0) {
+		rank = 0;
+		return true;
+	}
+
+	std::mt19937_64 generator(SKETCH_SEED);
+	size_t probes = std::max<size_t>(oversampling, 1);
+	size_t block = std::max<size_t>(probes, 8);
+	// the probes bound the error by 10 sqrt(2 / pi) times their largest residual
+	// with probability at least 1 - 10^-probes (halko, martinsson and tropp)
+	double bound = tolerance * scale / (10 * std::sqrt(2 / M_PI));
+
+	// the basis grows until it spans the range, its size of the rank bound is the progress
+	Matrix<double> basis(0, m);
+	for (;;) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(basis.getRow(), limit);
+
+		// residual of fresh probes: (I - Q Q^T) A G
+		Matrix<double> residual = (matrix * gaussian(n, probes, generator)).transposed();
+		double largest = 0;
+		for (size_t i = 0; i < residual.getRow(); ++i) {
+			std::vector<double> row(residual[i], residual[i] + m);
+			for (size_t k = 0; k < basis.getRow(); ++k) {
+				double koef = 0;
+				for (size_t j = 0; j < m; ++j) {
+					koef += basis[k][j] * row[j];
+				}
+				for (size_t j = 0; j < m; ++j) {
+					row[j] -= koef * basis[k][j];
+				}
+			}
+			largest = std::max(largest, norm(row));
+		}
+		if (largest <= bound || basis.getRow() >= limit) {
+			break;
+		}
+
+		// the next block of the range
+		Matrix<double> y = (matrix * gaussian(n, block, generator)).transposed();
+		size_t before = basis.getRow();
+		extendBasis(basis, y, bound);
+		if (basis.getRow() == before) {
+			break;
+		}
+	}
+
+	// the products stop early once the evaluation is cancelled, which ends the loop above
+	if (isEvaluationCancelled()) {
+		error = "Evaluation cancelled";
+		return false;
+	}
+	if (basis.getRow() == 0) {
+		rank = 0;
+		return true;
+	}
+
+	// singular values of Q^T A above the tolerance
+	Matrix<double> u;
+	Matrix<double> v;
+	std::vector<double> sigma;
+	if (!jacobiSvd(Matrix<double>(basis * matrix), u, sigma, v, error)) {
+		return false;
+	}
+	rank = std::count_if(sigma.begin(), sigma.end(), [&](double value) {
+		return value > tolerance * sigma[0];
+	});
+
+	return true;
+}
+
+bool sketchSingularValues(const Matrix<double>& matrix, size_t count, size_t oversampling,
+						  std::vector<double>& values, std::string& error) {
+	size_t m = matrix.getRow();
+	size_t n = matrix.getCol();
+	size_t columns = std::min(count + oversampling, std::min(m, n));
+	std::mt19937_64 generator(SKETCH_SEED);
+
+	// Q spans the range of (A A^T)^q A G
+	Matrix<double> basis(0, m);
+	extendBasis(basis, (matrix * gaussian(n, columns, generator)).transposed(), 0);
+	Matrix<double> transposed = matrix.transposed();
+	for (int iteration = 0; iteration < POWER_ITERATIONS && basis.getRow() != 0; ++iteration) {
+		if (isEvaluationCancelled()) {
+			error = "Evaluation cancelled";
+			return false;
+		}
+		reportProgress(iteration, POWER_ITERATIONS);
+
+		Matrix<double> back(0, n);
+		extendBasis(back, basis * matrix, 0);
+		basis = Matrix<double>(0, m);
+		extendBasis(basis, back * transposed, 0);
+	}
+
+	// the products stop early once the evaluation is cancelled, which may leave the basis empty
+	if (isEvaluationCancelled()) {
+		error = "Evaluation cancelled";
+		return false;
+	}
+
+	values.assign(count, 0);
+	if (basis.getRow() == 0) {
+		return true;
+	}
+
+	Matrix<double> u;
+	Matrix<double> v;
+	std::vector<double> sigma;
+	if (!jacobiSvd(Matrix<double>(basis * matrix), u, sigma, v, error)) {
+		return false;
+	}
+	for (size_t i = 0; i < count && i < sigma.size(); ++i) {
+		values[i] = sigma[i];
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+#include "sparsematrix.h"
+#include "parallel.h"
+
+// nonzeros of a product before its rows are split between threads
+static const size_t PARALLEL_NONZEROS = 1 << 16;
+
+sparseMatrix::sparseMatrix(size_t row, size_t col): row_(row),
+													 col_(col),
+													 row_start_(row + 1, 0) {}
+
+sparseMatrix::sparseMatrix(const Matrix<double>& dense): row_(dense.getRow()),
+														  col_(dense.getCol()),
+														  row_start_(1, 0)
+{
+	for (size_t i = 0; i < row_; ++i) {
+		for (size_t j = 0; j < col_; ++j) {
+			if (dense[i][j] != 0) {
+				columns_.push_back(j);
+				values_.push_back(dense[i][j]);
+			}
+		}
+		row_start_.push_back(values_.size());
+	}
+}
+
+void sparseMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const {
+	y.resize(row_);
+	auto body = [&](size_t i) {
+		double sum = 0;
+		for (size_t k = row_start_[i]; k < row_start_[i + 1]; ++k) {
+			sum += values_[k] * x[columns_[k]];
+		}
+		y[i] = sum;
+	};
+
+	if (values_.size() >= PARALLEL_NONZEROS) {
+		parallelFor(0, row_, body);
+		return;
+	}
+
+	for (size_t i = 0; i < row_; ++i) {
+		body(i);
+	}
+}
+
+double sparseMatrix::density() const {
+	return row_ * col_ == 0 ? 0 : static_cast<double>(values_.size()) / (row_ * col_);
+}
+
+size_t sparseMatrix::getRow() const {
+	return row_;
+}
+
+size_t sparseMatrix::getCol() const {
+	return col_;
+}
+
+size_t sparseMatrix::nonZeros() const {
+	return values_.size();
+}
+
+const std::vector<size_t>& sparseMatrix::rowStart() const {
+	return row_start_;
+}
+
+const std::vector<size_t>& sparseMatrix::columns() const {
+	return columns_;
+}
+
+const std::vector<double>& sparseMatrix::values() const {
+	return values_;
+}
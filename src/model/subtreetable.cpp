@@ -0,0 +1,26 @@
+#include "subtreetable.h"
+#include <functional>
+
+size_t subtreeTable::getKey(const std::string& node, size_t left, size_t right) {
+	// numbers start from 1, 0 stands for a missing child
+	auto inserted = keys_.emplace(entry{node, left, right}, keys_.size() + 1);
+
+	return inserted.first->second;
+}
+
+void subtreeTable::clear() {
+	keys_.clear();
+}
+
+bool subtreeTable::entry::operator==(const entry& other) const {
+	return left_ == other.left_ && right_ == other.right_ && node_ == other.node_;
+}
+
+size_t subtreeTable::entryHash::operator()(const entry& value) const {
+	size_t hash = std::hash<std::string>()(value.node_);
+	for (size_t child : {value.left_, value.right_}) {
+		hash ^= child + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	}
+
+	return hash;
+}
@@ -0,0 +1,237 @@
+#include "svd.h"
+#include "parallel.h"
+#include "progress.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <numeric>
+
+// sweeps over all column pairs before the jacobi iteration gives up
+static const int MAX_SWEEPS = 60;
+
+// entries of a round before its pairs are split between threads
+static const size_t PARALLEL_ENTRIES = 1 << 14;
+
+// conjugate which keeps real scalars real
+static double conjugate(double value) {
+	return value;
+}
+
+static std::complex<double> conjugate(const std::complex<double>& value) {
+	return std::conj(value);
+}
+
+// rotate columns p and q of a column-major block until they are orthogonal,
+// the same rotation is applied to the columns of V; false if they already were
+// or if one of them is rounding noise, its squared norm at most negligible
+template <typename Scalar>
+static bool rotate(std::vector<Scalar>& a, size_t rows, std::vector<Scalar>& v, size_t n, size_t p, size_t q, double negligible) {
+	Scalar* first = &a[p * rows];
+	Scalar* second = &a[q * rows];
+
+	double alpha = 0;
+	double beta = 0;
+	Scalar gamma = 0;
+	for (size_t i = 0; i < rows; ++i) {
+		alpha += std::norm(first[i]);
+		beta += std::norm(second[i]);
+		gamma += conjugate(first[i]) * second[i];
+	}
+
+	double length = std::abs(gamma);
+	if (length == 0 || length <= DBL_EPSILON * std::sqrt(alpha * beta) || std::min(alpha, beta) <= negligible) {
+		return false;
+	}
+
+	// turn gamma real by the phase of the second column, then a real jacobi rotation
+	Scalar phase = conjugate(gamma) / length;
+	double zeta = (beta - alpha) / (2 * length);
+	double t = (zeta >= 0 ? 1 : -1) / (std::abs(zeta) + std::sqrt(1 + zeta * zeta));
+	double c = 1 / std::sqrt(1 + t * t);
+	double s = c * t;
+
+	for (size_t i = 0; i < rows; ++i) {
+		Scalar x = first[i];
+		Scalar y = phase * second[i];
+		first[i] = c * x - s * y;
+		second[i] = s * x + c * y;
+	}
+
+	Scalar* first_v = &v[p * n];
+	Scalar* second_v = &v[q * n];
+	for (size_t i = 0; i < n; ++i) {
+		Scalar x = first_v[i];
+		Scalar y = phase * second_v[i];
+		first_v[i] = c * x - s * y;
+		second_v[i] = s * x + c * y;
+	}
+
+	return true;
+}
+
+// svd of a matrix with at least as many rows as columns
+template <typename Scalar>
+static bool tallSvd(const Matrix<Scalar>& matrix, Matrix<Scalar>& u, std::vector<double>& sigma,
+					Matrix<Scalar>& v, std::string& error) {
+	size_t m = matrix.getRow();
+	size_t n = matrix.getCol();
+
+	// columns are stored contiguously, rotations work on whole columns
+	std::vector<Scalar> a(m * n);
+	std::vector<Scalar> w(n * n, Scalar(0));
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			a[j * m + i] = matrix[i][j];
+		}
+	}
+	for (size_t j = 0; j < n; ++j) {
+		w[j * n + j] = 1;
+	}
+
+	// columns of a rank deficient matrix shrink to rounding noise of the size eps ||A||
+	// and would keep rotating against each other forever
+	double frobenius = 0;
+	for (const Scalar& value : a) {
+		frobenius += std::norm(value);
+	}
+	double negligible = DBL_EPSILON * DBL_EPSILON * frobenius;
+
+	// round-robin tournament: every round pairs up all columns disjointly,
+	// a dummy player (index n) sits out when n is odd
+	size_t players = n + n % 2;
+	std::vector<size_t> order(players);
+	std::iota(order.begin(), order.end(), 0);
+	std::vector<char> rotated(players / 2);
+
+	// the number of sweeps is not known in advance, the rounds of the current one are the progress
+	bool converged = false;
+	for (int sweep = 0; sweep < MAX_SWEEPS && !converged; ++sweep) {
+		converged = true;
+		for (size_t round = 0; round + 1 < players; ++round) {
+			if (isEvaluationCancelled()) {
+				error = "Evaluation cancelled";
+				return false;
+			}
+			reportProgress(round, players - 1);
+
+			auto body = [&](size_t k) {
+				size_t p = order[k];
+				size_t q = order[players - 1 - k];
+				rotated[k] = p < n && q < n && rotate(a, m, w, n, std::min(p, q), std::max(p, q), negligible);
+			};
+			if (m * n >= PARALLEL_ENTRIES) {
+				parallelFor(0, players / 2, body);
+			}
+			else {
+				for (size_t k = 0; k < players / 2; ++k) {
+					body(k);
+				}
+			}
+
+			if (std::any_of(rotated.begin(), rotated.end(), [](char value) { return value; })) {
+				converged = false;
+			}
+			std::rotate(order.begin() + 1, order.end() - 1, order.end());
+		}
+	}
+
+	if (!converged) {
+		error = "Semantic error: singular value iteration did not converge";
+		return false;
+	}
+
+	// singular values are the column norms, sorted in decreasing order
+	std::vector<double> norms(n);
+	for (size_t j = 0; j < n; ++j) {
+		double norm = 0;
+		for (size_t i = 0; i < m; ++i) {
+			norm += std::norm(a[j * m + i]);
+		}
+		norms[j] = std::sqrt(norm);
+	}
+	std::vector<size_t> permutation(n);
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::stable_sort(permutation.begin(), permutation.end(), [&norms](size_t lhs, size_t rhs) {
+		return norms[lhs] > norms[rhs];
+	});
+
+	u = Matrix<Scalar>(m, n);
+	v = Matrix<Scalar>(n, n);
+	sigma.resize(n);
+	for (size_t k = 0; k < n; ++k) {
+		size_t j = permutation[k];
+		sigma[k] = norms[j];
+		for (size_t i = 0; i < m; ++i) {
+			u[i][k] = norms[j] == 0 ? Scalar(0) : a[j * m + i] / norms[j];
+		}
+		for (size_t i = 0; i < n; ++i) {
+			v[i][k] = w[j * n + i];
+		}
+	}
+
+	return true;
+}
+
+// conjugate transpose
+template <typename Scalar>
+static Matrix<Scalar> adjoint(const Matrix<Scalar>& matrix) {
+	Matrix<Scalar> result(matrix.getCol(), matrix.getRow());
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			result[j][i] = conjugate(matrix[i][j]);
+		}
+	}
+
+	return result;
+}
+
+template <typename Scalar>
+bool jacobiSvd(const Matrix<Scalar>& matrix, Matrix<Scalar>& u, std::vector<double>& sigma,
+			   Matrix<Scalar>& v, std::string& error) {
+	if (matrix.getRow() >= matrix.getCol()) {
+		return tallSvd(matrix, u, sigma, v, error);
+	}
+
+	// wide matrices: A^H = V S U^H
+	return tallSvd(adjoint(matrix), v, sigma, u, error);
+}
+
+template <typename Scalar>
+bool pseudoInverse(const Matrix<Scalar>& matrix, double epsilon, Matrix<Scalar>& result, std::string& error) {
+	Matrix<Scalar> u;
+	Matrix<Scalar> v;
+	std::vector<double> sigma;
+	if (!jacobiSvd(matrix, u, sigma, v, error)) {
+		return false;
+	}
+
+	// A^+ = V S^+ U^H
+	size_t m = matrix.getRow();
+	size_t n = matrix.getCol();
+	double tolerance = epsilon * std::max(m, n) * (sigma.empty() ? 0 : sigma[0]);
+	size_t kept = 0;
+	while (kept < sigma.size() && sigma[kept] > tolerance) {
+		++kept;
+	}
+
+	result = Matrix<Scalar>(n, m);
+	parallelFor(0, n, [&](size_t i) {
+		Scalar* row = result[i];
+		for (size_t k = 0; k < kept; ++k) {
+			Scalar koef = v[i][k] / sigma[k];
+			for (size_t j = 0; j < m; ++j) {
+				row[j] += koef * conjugate(u[j][k]);
+			}
+		}
+	});
+
+	return true;
+}
+
+template bool jacobiSvd(const Matrix<double>&, Matrix<double>&, std::vector<double>&, Matrix<double>&, std::string&);
+template bool jacobiSvd(const Matrix<std::complex<double>>&, Matrix<std::complex<double>>&, std::vector<double>&,
+						Matrix<std::complex<double>>&, std::string&);
+template bool pseudoInverse(const Matrix<double>&, double, Matrix<double>&, std::string&);
+template bool pseudoInverse(const Matrix<std::complex<double>>&, double, Matrix<std::complex<double>>&, std::string&);
@@ -84,6 +84,7 @@ void View::setUpInterface() {
 	displayDimensionsPopup();
 	displayListPopup();
 	displayEquationPopup();
+	displayProgressPopup();
 	displayErrors();
 
 	ImGui::End();
@@ -116,6 +117,8 @@ Query& View::getQuery() {
 // handle answer
 void View::processAnswer(const Answer& answer) {
 	query_.type_of_query_ = noQuery;
+	is_evaluating_ = false;
+	is_cancel_requested_ = false;
 	error_message_ = answer.error_message_;
 
 	if (error_message_ != "") {
@@ -132,6 +135,14 @@ void View::processAnswer(const Answer& answer) {
 			cur_available_variable_ = (cur_available_variable_ + 1) % configs_.MAX_VARIABLES_ALLOWED;
 		}
 
+		// the answer on the screen follows the variables it reads
+		for (const Answer& recomputed : answer.recomputed_) {
+			if (is_answer_ready_ == calcAns && recomputed.exp_ == answer_.exp_) {
+				answer_ = recomputed;
+				is_answer_ready_ = recomputed.error_message_ == "" ? calcAns : noAns;
+			}
+		}
+
 		return;
 	}
 
@@ -154,6 +165,22 @@ void View::processAnswer(const Answer& answer) {
 	return;
 }
 
+// progress of the query being processed
+void View::setProgress(size_t done, size_t total) {
+	if (!is_evaluating_) {
+		is_evaluating_ = true;
+		is_cancel_requested_ = false;
+		evaluation_start_ = std::chrono::steady_clock::now();
+	}
+
+	progress_done_ = done;
+	progress_total_ = total;
+}
+
+bool View::isCancelRequested() {
+	return is_cancel_requested_;
+}
+
 // private contructor for singleton patter
 View::View(): window_(nullptr),
 			  show_cursor_(true),
@@ -161,6 +188,8 @@ View::View(): window_(nullptr),
 			  cursor_cell_(std::make_pair(0, 0)),
 			  cur_exp_(0),
 			  type_("real"),
+			  solve_method_("direct"),
+			  preconditioner_("ilu"),
 			  show_type_popup_(false),
 			  modulo_pressed_(false),
 			  error_message_(""),
@@ -171,7 +200,11 @@ View::View(): window_(nullptr),
 			  show_equation_popup_(false),
 			  init_system_(false),
 			  is_ans_chosen_(false),
-			  is_answer_ready_(noAns)
+			  is_answer_ready_(noAns),
+			  is_evaluating_(false),
+			  is_cancel_requested_(false),
+			  progress_done_(0),
+			  progress_total_(0)
 {
 	variables_.resize(configs_.MAX_VARIABLES_ALLOWED);
 
@@ -374,6 +407,17 @@ void View::printSolutionToSystem() {
 	std::vector<bool> entries;
 	entries.resize(answer_.ans_matrix_[0].size() - 1);
 
+	// overdetermined systems are answered by the closest fit
+	if (answer_.is_least_squares_) {
+		std::string line = "Least squares solution, residual " + std::to_string(answer_.residual_);
+		ImGui::TextColored(color, line.c_str());
+	}
+
+	if (answer_.iterations_ != 0) {
+		std::string line = std::to_string(answer_.iterations_) + " iterations, residual " + std::to_string(answer_.residual_);
+		ImGui::TextColored(color, line.c_str());
+	}
+
 	// print out no solution
 	for (int i = 0; i < answer_.ans_matrix_.size(); ++i) {
 		if (isNoSolutionRow(answer_.ans_matrix_[i])) {
@@ -432,6 +476,24 @@ void View::printSolutionToSystem() {
 void View::printExpAns() {
 	ImVec4 color = ImVec4(0, 0, 0, 255);
 
+	// solve operators which ran an iterative method
+	if (answer_.iterations_ != 0) {
+		std::string line = std::to_string(answer_.iterations_) + " iterations, residual " + std::to_string(answer_.residual_);
+		ImGui::TextColored(color, line.c_str());
+	}
+
+	// answers in other types come already printed by the model
+	if (answer_.type_ != "real") {
+		if (answer_.is_ans_number_) {
+			ImGui::NewLine();
+			ImGui::TextColored(color, answer_.ans_string_.c_str());
+		}
+		else {
+			displayMatrix(answer_.ans_matrix_string_);
+		}
+		return;
+	}
+
 	if (answer_.is_ans_number_) {
 		std::string ans = std::to_string(answer_.ans_float_);
 		ans.erase(ans.find_last_not_of('0') + 1, std::string::npos);
@@ -634,6 +696,14 @@ void View::displayTypePopup() {
 
 		ImGui::SameLine();
 
+		if (ImGui::Button("rational")) {
+			type_ = "rational";
+			show_type_popup_ = false;
+			ImGui::CloseCurrentPopup();
+		}
+
+		ImGui::SameLine();
+
 		if (ImGui::Button("modulo") && !modulo_pressed_) {
 			type_ = "modulo ";
 			modulo_pressed_ = true;
@@ -725,6 +795,46 @@ void View::displayListPopup() {
 	ImGui::End();
 }
 
+// progress of a long query with a button to stop it, short queries finish before it shows up
+void View::displayProgressPopup() {
+	if (is_evaluating_) {
+		auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - evaluation_start_);
+		if (interval.count() > configs_.PROGRESS_POPUP_DELAY) {
+			ImGui::OpenPopup("Evaluating");
+		}
+	}
+
+	if (ImGui::BeginPopupModal("Evaluating", nullptr, ImGuiWindowFlags_NoMove |
+													  ImGuiWindowFlags_NoResize |
+													  ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		if (!is_evaluating_) {
+			ImGui::CloseCurrentPopup();
+			ImGui::EndPopup();
+			return;
+		}
+
+		// the kernel running reports the steps it has done
+		if (progress_total_ == 0) {
+			ImGui::Text("evaluating");
+		}
+		else {
+			std::string line = "step " + std::to_string(progress_done_) + " of " + std::to_string(progress_total_);
+			ImGui::Text(line.c_str());
+			ImGui::ProgressBar(float(progress_done_) / progress_total_, ImVec2(configs_.PROGRESS_BAR_WIDTH, 0));
+		}
+
+		if (is_cancel_requested_) {
+			ImGui::Text("cancelling");
+		}
+		else if (ImGui::Button("cancel")) {
+			is_cancel_requested_ = true;
+		}
+
+		ImGui::EndPopup();
+	}
+}
+
 void View::displayEquationPopup() {
 	if (show_equation_popup_) {
 		ImGui::OpenPopup("Equations");
@@ -746,7 +856,22 @@ void View::displayEquationPopup() {
 		if (no_of_equations < configs_.MIN_DIMENSION_ALLOWED) no_of_equations = configs_.MIN_DIMENSION_ALLOWED;
 		if (no_of_equations > configs_.MAX_DIMENSION_ALLOWED) no_of_equations = configs_.MAX_DIMENSION_ALLOWED;
 
+		// iterative methods are meant for large square systems
+		static int method = 0;
+		static int preconditioner = 2;
+		const char* methods[] = {"direct", "cg", "bicgstab", "gmres"};
+		const char* preconditioners[] = {"none", "jacobi", "ilu"};
+
+		ImGui::Text("Method: ");
+		ImGui::Combo("##method", &method, methods, IM_ARRAYSIZE(methods));
+
+		ImGui::Text("Preconditioner: ");
+		ImGui::Combo("##preconditioner", &preconditioner, preconditioners, IM_ARRAYSIZE(preconditioners));
+
 		if (ImGui::Button("enter")) {
+			solve_method_ = methods[method];
+			preconditioner_ = preconditioners[preconditioner];
+
 			equations_.resize(no_of_equations);
 			for (int i = 0; i < no_of_equations; ++i) {
 				equations_[i].resize(no_of_unknowns + 1);
@@ -1059,6 +1184,11 @@ void View::handleTypeButton(float width, float height) {
 
 void View::handleEqualButton(float width, float height) {
 	if (ImGui::Button("=", ImVec2(width, height))) {
+		// the query being processed is not replaced until its answer comes back
+		if (is_evaluating_ || query_.type_of_query_ != noQuery) {
+			return;
+		}
+
 		if (is_answer_ready_ == systemAns) {
 			is_answer_ready_ = noAns;
 			return;
@@ -1081,6 +1211,8 @@ void View::handleEqualButton(float width, float height) {
 			query_.is_ans_used_ = false;
 			query_.exp_ = "";
 			query_.matrix_ = equations_;
+			query_.solve_method_ = solve_method_;
+			query_.preconditioner_ = preconditioner_;
 
 			return;
 		}
@@ -1089,6 +1221,8 @@ void View::handleEqualButton(float width, float height) {
 		query_.type_of_query_ = calcExp;
 		query_.is_ans_used_ = false;
 		query_.exp_ = expressions_[cur_exp_];
+		query_.solve_method_ = solve_method_;
+		query_.preconditioner_ = preconditioner_;
 	}
 }
 
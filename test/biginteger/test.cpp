@@ -0,0 +1,33 @@
+#include "../../header/model/biginteger.h"
+
+#include <iostream>
+
+int main() {
+	bigInteger a(1234567890123456789LL);
+	bigInteger b(-987654321987LL);
+
+	std::cout << "Test1: plus" << std::endl;
+	std::cout << "Expected: 1234566902469134802" << std::endl;
+	std::cout << "Got: " << a + b << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: multiply" << std::endl;
+	std::cout << "Expected: -1219326312466803828664487119743" << std::endl;
+	std::cout << "Got: " << a * b << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: division" << std::endl;
+	bigInteger c = a * a * a;
+	std::cout << "Expected: -1543209847203954627186558 and 1234567890123456789" << std::endl;
+	std::cout << "Got: " << c / (a * b) << " and " << c / (a * a) << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: remainder" << std::endl;
+	std::cout << "Expected: 975294028776" << std::endl;
+	std::cout << "Got: " << a % b << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: gcd" << std::endl;
+	std::cout << "Expected: 3" << std::endl;
+	std::cout << "Got: " << gcd(a, b) << std::endl;
+}
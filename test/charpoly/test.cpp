@@ -0,0 +1,66 @@
+#include "../../header/model/berkowitz.h"
+#include "../../header/model/eigen.h"
+#include "../../header/model/rational.h"
+
+#include <cmath>
+#include <iostream>
+
+// rounded to six decimals, so that the last bits of the hessenberg reduction do not show
+static double rounded(double value) {
+	return std::round(value * 1e6) / 1e6 + 0.0;
+}
+
+int main() {
+	std::cout << "Test1: berkowitz on integers" << std::endl;
+	std::vector<long long> integer = berkowitz(Matrix<long long>({{1, 2}, {3, 4}}));
+	std::cout << "Expected: 1 -5 -2 " << std::endl;
+	std::cout << "Got: ";
+	for (long long coefficient : integer) {
+		std::cout << coefficient << " ";
+	}
+	std::cout << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: berkowitz on rationals" << std::endl;
+	std::vector<rationalNumber> rational = berkowitz(Matrix<rationalNumber>({{rationalNumber(1, 2), rationalNumber(1, 3)},
+																			 {rationalNumber(1, 4), rationalNumber(1)}}));
+	std::cout << "Expected: 1 -3/2 5/12 " << std::endl;
+	std::cout << "Got: ";
+	for (const rationalNumber& coefficient : rational) {
+		std::cout << coefficient << " ";
+	}
+	std::cout << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: berkowitz on a triangular matrix, (x - 2)(x - 3)(x - 6)" << std::endl;
+	integer = berkowitz(Matrix<long long>({{2, 0, 0}, {1, 3, 0}, {4, 5, 6}}));
+	std::cout << "Expected: 1 -11 36 -36 " << std::endl;
+	std::cout << "Got: ";
+	for (long long coefficient : integer) {
+		std::cout << coefficient << " ";
+	}
+	std::cout << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: hessenberg form in double agrees with berkowitz" << std::endl;
+	std::vector<double> real;
+	realCharacteristicPolynomial(Matrix<double>({{2, 0, 0}, {1, 3, 0}, {4, 5, 6}}), real);
+	std::cout << "Expected: 1 -11 36 -36 " << std::endl;
+	std::cout << "Got: ";
+	for (double coefficient : real) {
+		std::cout << rounded(coefficient) << " ";
+	}
+	std::cout << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: complex matrix, x^2 + 1" << std::endl;
+	std::vector<std::complex<double>> complex;
+	complexCharacteristicPolynomial(Matrix<double>({{0, 0}, {0, 0}}), Matrix<double>({{1, 0}, {0, -1}}), complex);
+	std::cout << "Expected: 1+0i 0+0i 1+0i " << std::endl;
+	std::cout << "Got: ";
+	for (const std::complex<double>& coefficient : complex) {
+		std::cout << rounded(coefficient.real()) << (rounded(coefficient.imag()) < 0 ? "-" : "+")
+				  << std::abs(rounded(coefficient.imag())) << "i ";
+	}
+	std::cout << std::endl;
+}
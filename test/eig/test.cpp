@@ -0,0 +1,66 @@
+#include "../../header/model/eigen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// rounded to six decimals, so that the last bits of the iteration do not show
+static double rounded(double value) {
+	return std::round(value * 1e6) / 1e6 + 0.0;
+}
+
+static void printValues(std::vector<std::complex<double>> values) {
+	std::sort(values.begin(), values.end(), [](const std::complex<double>& a, const std::complex<double>& b) {
+		return rounded(a.real()) != rounded(b.real()) ? a.real() < b.real() : a.imag() < b.imag();
+	});
+	for (const std::complex<double>& value : values) {
+		std::cout << rounded(value.real()) << (rounded(value.imag()) < 0 ? "-" : "+") << std::abs(rounded(value.imag())) << "i ";
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	std::string error;
+	std::vector<std::complex<double>> values;
+
+	std::cout << "Test1: triangular matrix" << std::endl;
+	realEigenvalues(Matrix<double>({{1, 2, 3}, {0, 4, 5}, {0, 0, 6}}), values, error);
+	std::cout << "Expected: 1+0i 4+0i 6+0i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: symmetric matrix" << std::endl;
+	realEigenvalues(Matrix<double>({{2, 1}, {1, 2}}), values, error);
+	std::cout << "Expected: 1+0i 3+0i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: rotation has a complex pair" << std::endl;
+	realEigenvalues(Matrix<double>({{0, -1}, {1, 0}}), values, error);
+	std::cout << "Expected: 0-1i 0+1i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: companion matrix of (x - 1)(x - 2)(x - 3)" << std::endl;
+	realEigenvalues(Matrix<double>({{6, -11, 6}, {1, 0, 0}, {0, 1, 0}}), values, error);
+	std::cout << "Expected: 1+0i 2+0i 3+0i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: complex diagonal matrix" << std::endl;
+	complexEigenvalues(Matrix<double>({{1, 0}, {0, 2}}), Matrix<double>({{1, 0}, {0, -1}}), values, error);
+	std::cout << "Expected: 1+1i 2-1i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: hermitian matrix" << std::endl;
+	complexEigenvalues(Matrix<double>({{2, 0}, {0, 2}}), Matrix<double>({{0, -1}, {1, 0}}), values, error);
+	std::cout << "Expected: 1+0i 3+0i " << std::endl;
+	std::cout << "Got: ";
+	printValues(values);
+}
@@ -0,0 +1,90 @@
+#include "../../header/model/krylov.h"
+
+#include <cmath>
+#include <iostream>
+
+// rounded to six decimals, the solvers stop at a relative residual of 1e-10
+static double rounded(double value) {
+	return std::round(value * 1e6) / 1e6 + 0.0;
+}
+
+static void printSolution(bool is_solved, const std::vector<double>& solution) {
+	std::cout << is_solved << " : ";
+	for (double value : solution) {
+		std::cout << rounded(value) << " ";
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	std::string error;
+	std::vector<double> solution;
+	size_t iterations;
+	double residual;
+	krylovOptions options;
+	options.preconditioner_ = iluPreconditioner;
+
+	// symmetric positive definite, the solution is 1 2 3
+	Matrix<double> symmetric({{4, -1, 0}, {-1, 4, -1}, {0, -1, 4}});
+	std::vector<double> symmetric_rhs = {2, 4, 10};
+
+	// not symmetric, the solution is 1 -1 2
+	Matrix<double> general({{4, 1, 0}, {2, 5, 1}, {0, 1, 3}});
+	std::vector<double> general_rhs = {3, -1, 5};
+
+	std::cout << "Test1: cg with ilu(0)" << std::endl;
+	options.method_ = cgMethod;
+	bool is_solved = krylovSolve(symmetric, symmetric_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 1 : 1 2 3 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: bicgstab with ilu(0)" << std::endl;
+	options.method_ = bicgstabMethod;
+	is_solved = krylovSolve(general, general_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 1 : 1 -1 2 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: gmres with ilu(0)" << std::endl;
+	options.method_ = gmresMethod;
+	is_solved = krylovSolve(general, general_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 1 : 1 -1 2 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: ilu(0) of a tridiagonal matrix is its lu, one iteration is enough" << std::endl;
+	krylovSolve(sparseMatrix(symmetric), symmetric_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 1 iterations" << std::endl;
+	std::cout << "Got: " << iterations << " iterations" << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: gmres with jacobi on the compressed matrix" << std::endl;
+	options.preconditioner_ = jacobiPreconditioner;
+	is_solved = krylovSolve(sparseMatrix(general), general_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 1 : 1 -1 2 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: iteration cap" << std::endl;
+	options.method_ = cgMethod;
+	options.preconditioner_ = noPreconditioner;
+	options.max_iterations_ = 1;
+	error = "";
+	is_solved = krylovSolve(symmetric, symmetric_rhs, options, solution, iterations, residual, error);
+	std::cout << "Expected: 0 and an error" << std::endl;
+	std::cout << "Got: " << is_solved << " and " << (error == "" ? "no error" : "an error") << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test7: method names" << std::endl;
+	solveMethod method;
+	preconditionerType preconditioner;
+	std::cout << "Expected: 1 1 0" << std::endl;
+	std::cout << "Got: " << (parseSolveMethod("bicgstab", method) && method == bicgstabMethod) << " "
+			  << (parsePreconditioner("ilu", preconditioner) && preconditioner == iluPreconditioner) << " "
+			  << parseSolveMethod("lu", method) << std::endl;
+}
@@ -0,0 +1,71 @@
+#include "../../header/model/leastsquares.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// rounded to nine decimals, the solution is accurate to double rounding errors
+static double rounded(double value) {
+	return std::round(value * 1e9) / 1e9 + 0.0;
+}
+
+static void printSolution(bool is_solved, const std::vector<double>& solution, double residual) {
+	std::cout << is_solved << " : ";
+	for (double value : solution) {
+		std::cout << rounded(value) << " ";
+	}
+	std::cout << "residual " << rounded(residual) << std::endl;
+}
+
+// tall system of m rows over the columns 1, i % 7 and i % 11
+static Matrix<double> tallSystem(size_t m) {
+	Matrix<double> system(m, 4);
+	for (size_t i = 0; i < m; ++i) {
+		system[i][0] = 1;
+		system[i][1] = i % 7;
+		system[i][2] = i % 11;
+	}
+
+	return system;
+}
+
+int main() {
+	std::cout << std::setprecision(9);
+	std::string error;
+	std::vector<double> solution;
+	double residual = 0;
+
+	// 2048 rows are split into blocks of at least 256 rows, one per worker,
+	// a machine with a single worker factors them as one block
+	std::cout << "Test1: tall consistent system" << std::endl;
+	Matrix<double> consistent = tallSystem(2048);
+	for (size_t i = 0; i < consistent.getRow(); ++i) {
+		consistent[i][3] = 1 + 2 * consistent[i][1] + 3 * consistent[i][2];
+	}
+	bool is_solved = leastSquaresSolve(consistent, solution, residual, error);
+	std::cout << "Expected: 1 : 1 2 3 residual 0" << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution, residual);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: tall inconsistent system" << std::endl;
+	Matrix<double> inconsistent = tallSystem(2048);
+	for (size_t i = 0; i < inconsistent.getRow(); ++i) {
+		inconsistent[i][3] = i % 13;
+	}
+	is_solved = leastSquaresSolve(inconsistent, solution, residual, error);
+	std::cout << "Expected: 1 : 6.00173391 -8.397e-06 -0.002394635 residual 169.30643" << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution, residual);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: columns which are not independent" << std::endl;
+	Matrix<double> deficient = tallSystem(1024);
+	for (size_t i = 0; i < deficient.getRow(); ++i) {
+		deficient[i][2] = 2 * deficient[i][1];
+		deficient[i][3] = i % 5;
+	}
+	is_solved = leastSquaresSolve(deficient, solution, residual, error);
+	std::cout << "Expected: 0 and empty error" << std::endl;
+	std::cout << "Got: " << is_solved << " and " << (error == "" ? "empty error" : error) << std::endl;
+}
@@ -0,0 +1,99 @@
+#include "../../header/model/matrixfunction.h"
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+// rounded to six decimals, so that the last bits of the approximants do not show
+static double rounded(double value) {
+	return std::round(value * 1e6) / 1e6 + 0.0;
+}
+
+static void printMatrix(const Matrix<double>& matrix) {
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			std::cout << rounded(matrix[i][j]) << " ";
+		}
+		std::cout << "; ";
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	std::string error;
+	Matrix<double> result;
+
+	std::cout << "Test1: exponential of a diagonal matrix" << std::endl;
+	exponential(Matrix<double>({{1, 0}, {0, 2}}), result, error);
+	std::cout << "Expected: 2.71828 0 ; 0 7.38906 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: exponential of a nilpotent matrix" << std::endl;
+	exponential(Matrix<double>({{0, 1}, {0, 0}}), result, error);
+	std::cout << "Expected: 1 1 ; 0 1 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: exponential of a skew-symmetric matrix is a rotation" << std::endl;
+	exponential(Matrix<double>({{0, -1}, {1, 0}}), result, error);
+	std::cout << "Expected: 0.540302 -0.841471 ; 0.841471 0.540302 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: exponential of a large norm matrix needs squaring" << std::endl;
+	exponential(Matrix<double>({{-20, 0}, {0, 10}}), result, error);
+	std::cout << "Expected: 0 0 ; 0 22026.5 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: square root of a symmetric matrix" << std::endl;
+	squareRoot(Matrix<double>({{5, 4}, {4, 5}}), result, error);
+	std::cout << "Expected: 2 1 ; 1 2 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: square root of a jordan block" << std::endl;
+	squareRoot(Matrix<double>({{1, 1}, {0, 1}}), result, error);
+	std::cout << "Expected: 1 0.5 ; 0 1 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test7: logarithm of a jordan block" << std::endl;
+	logarithm(Matrix<double>({{1, 1}, {0, 1}}), result, error);
+	std::cout << "Expected: 0 1 ; 0 0 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test8: logarithm undoes the exponential" << std::endl;
+	Matrix<double> exponent({{0.5, 0.2}, {-0.3, 0.1}});
+	Matrix<double> power;
+	exponential(exponent, power, error);
+	logarithm(power, result, error);
+	std::cout << "Expected: 0.5 0.2 ; -0.3 0.1 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(result);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test9: no real logarithm and square root with a negative eigenvalue" << std::endl;
+	bool is_logarithm = logarithm(Matrix<double>({{-1, 0}, {0, 1}}), result, error);
+	bool is_root = squareRoot(Matrix<double>({{-4, 0}, {0, 1}}), result, error);
+	std::cout << "Expected: 0 0" << std::endl;
+	std::cout << "Got: " << is_logarithm << " " << is_root << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test10: complex exponential" << std::endl;
+	Matrix<std::complex<double>> phase(1, 1);
+	Matrix<std::complex<double>> complex_result;
+	phase[0][0] = std::complex<double>(0, std::acos(-1.0));
+	exponential(phase, complex_result, error);
+	std::cout << "Expected: -1 0" << std::endl;
+	std::cout << "Got: " << rounded(complex_result[0][0].real()) << " " << rounded(complex_result[0][0].imag()) << std::endl;
+}
@@ -0,0 +1,133 @@
+#include "../../header/model/model.h"
+
+#include <iostream>
+
+static Answer setVariable(std::shared_ptr<Model> model, int variable, const std::vector<std::vector<std::string>>& matrix) {
+	Query query;
+	query.type_of_query_ = init;
+	query.type_ = "real";
+	query.is_ans_used_ = false;
+	query.variable_used_ = variable;
+	query.matrix_ = matrix;
+	return model->processQuery(query);
+}
+
+static Answer calc(std::shared_ptr<Model> model, const std::string& exp) {
+	Query query;
+	query.type_of_query_ = calcExp;
+	query.type_ = "rational";
+	query.exp_ = exp;
+	return model->processQuery(query);
+}
+
+static void printMatrix(const Answer& answer) {
+	for (const std::vector<std::string>& row : answer.ans_matrix_string_) {
+		for (const std::string& entry : row) {
+			std::cout << entry << " ";
+		}
+		std::cout << "; ";
+	}
+}
+
+static void printRewrites(const Answer& answer) {
+	for (const std::string& rule : answer.rewrites_) {
+		std::cout << rule << " ; ";
+	}
+	std::cout << "cubic " << answer.cubic_before_ << " -> " << answer.cubic_after_ << std::endl;
+}
+
+int main() {
+	std::shared_ptr<Model> model = Model::createModel();
+	setVariable(model, 0, {{"1", "2"}, {"3", "4"}});
+	setVariable(model, 1, {{"0", "1"}, {"1", "0"}});
+	setVariable(model, 2, {{"2", "0"}, {"0", "2"}});
+	setVariable(model, 3, {{"1", "1"}, {"1", "1"}});
+
+	std::cout << "Test1: sums written into the storage of the sum before" << std::endl;
+	Answer sum = calc(model, "A+B+C+D");
+	std::cout << "Expected: 4 4 ; 5 7 ; in place 2" << std::endl;
+	std::cout << "Got: ";
+	printMatrix(sum);
+	std::cout << "in place " << sum.in_place_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: a product scaled in place" << std::endl;
+	Answer scaled = calc(model, "2*(A*B)-C");
+	std::cout << "Expected: in place 2" << std::endl;
+	std::cout << "Got: in place " << scaled.in_place_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: a variable is never overwritten" << std::endl;
+	Answer variable = calc(model, "A+B");
+	std::cout << "Expected: in place 0" << std::endl;
+	std::cout << "Got: in place " << variable.in_place_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: a sum written into the storage of its right operand" << std::endl;
+	Answer right_sum = calc(model, "A+(B*C)");
+	std::cout << "Expected: 1 4 ; 5 4 ; in place 1" << std::endl;
+	std::cout << "Got: ";
+	printMatrix(right_sum);
+	std::cout << "in place " << right_sum.in_place_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: a difference written into the storage of its right operand" << std::endl;
+	Answer right_difference = calc(model, "A-(B*C)");
+	std::cout << "Expected: 1 0 ; 1 4 ; in place 1" << std::endl;
+	std::cout << "Got: ";
+	printMatrix(right_difference);
+	std::cout << "in place " << right_difference.in_place_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: inverses which cancel are removed before they are computed" << std::endl;
+	Answer inverses = calc(model, "inv(inv(A))");
+	std::cout << "Expected: inv(inv(X)) -> X ; cubic 2 -> 0" << std::endl;
+	std::cout << "Got: ";
+	printRewrites(inverses);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test7: a scalar taken out of the determinant in an exact field" << std::endl;
+	Answer scaled_det = calc(model, "det(2*A)");
+	std::cout << "Expected: -8 : det(c*X) -> c^n*det(X) ; constant folding ; cubic 1 -> 1" << std::endl;
+	std::cout << "Got: " << scaled_det.ans_string_ << " : ";
+	printRewrites(scaled_det);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test8: an entry of a product is a row times a column" << std::endl;
+	Answer entry = calc(model, "(A*B)[1,2]");
+	std::cout << "Expected: 1 : (X*Y)[r, c] -> X[r, :]*Y[:, c] ; tr(X*Y) -> tr(X, Y) ; cubic 1 -> 0" << std::endl;
+	std::cout << "Got: " << entry.ans_string_ << " : ";
+	printRewrites(entry);
+	std::cout << "--------------------" << std::endl;
+
+	setVariable(model, 4, {{"2", "1"}, {"1", "1"}});
+	std::cout << "Test9: the subtrees of a new expression are computed" << std::endl;
+	Answer first = calc(model, "inv(E)*B");
+	std::cout << "Expected: hits 0 misses 2" << std::endl;
+	std::cout << "Got: hits " << first.cache_hits_ << " misses " << first.cache_misses_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test10: the same expression again is read from the cache" << std::endl;
+	Answer again = calc(model, "inv(E)*B");
+	std::cout << "Expected: hits 1 misses 0" << std::endl;
+	std::cout << "Got: hits " << again.cache_hits_ << " misses " << again.cache_misses_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test11: a subtree shared with another expression is read from the cache" << std::endl;
+	Answer shared = calc(model, "inv(E)*C");
+	std::cout << "Expected: hits 1 misses 1" << std::endl;
+	std::cout << "Got: hits " << shared.cache_hits_ << " misses " << shared.cache_misses_ << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test12: a changed variable misses the subtrees which read it" << std::endl;
+	Answer changed = setVariable(model, 1, {{"1", "0"}, {"0", "1"}});
+	std::cout << "Expected: 1 -1 ; -1 2 ; hits 1 misses 1" << std::endl;
+	std::cout << "Got: ";
+	for (const Answer& recomputed : changed.recomputed_) {
+		if (recomputed.exp_ == "inv(E)*B") {
+			printMatrix(recomputed);
+			std::cout << "hits " << recomputed.cache_hits_ << " misses " << recomputed.cache_misses_;
+		}
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,59 @@
+#include "../../header/model/modular.h"
+
+#include <iostream>
+
+void printSolution(const std::vector<std::pair<bigInteger, bigInteger>>& solution) {
+	for (const std::pair<bigInteger, bigInteger>& unknown : solution) {
+		std::cout << unknown.first << "/" << unknown.second << " ";
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	std::string error;
+
+	std::cout << "Test1: determinant of a small matrix" << std::endl;
+	bigInteger determinant;
+	modularDeterminant({{2, 1}, {1, 3}}, determinant, error);
+	std::cout << "Expected: 5" << std::endl;
+	std::cout << "Got: " << determinant << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: determinant larger than one prime, put together by CRT" << std::endl;
+	std::vector<std::vector<long long>> large = {
+		{-304574436, -676053861, -152123001, 397871144, -896305688},
+		{-844444263, 763673106, 150797845, -797857272, -214689028},
+		{251527726, -875448262, 953574602, 89709946, -538939162},
+		{-919478676, -815429715, -68752979, -101982131, -849986617},
+		{-483180142, -805195284, 183364967, -88351981, -873061157}};
+	modularDeterminant(large, determinant, error);
+	std::cout << "Expected: -135092106598991605391258468222024685643165076" << std::endl;
+	std::cout << "Got: " << determinant << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: determinant of a singular matrix" << std::endl;
+	modularDeterminant({{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}, determinant, error);
+	std::cout << "Expected: 0" << std::endl;
+	std::cout << "Got: " << determinant << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: solve with fractions in the answer" << std::endl;
+	std::vector<std::pair<bigInteger, bigInteger>> solution;
+	modularSolve({{3, -7, 2, 11}, {5, 1, -4, 0}, {-2, 9, 6, -13}}, solution, error);
+	std::cout << "Expected: 62/187 -24/17 23/374 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: solve with large coefficients, rational reconstruction over several primes" << std::endl;
+	modularSolve({{123456789, 987654321, 1}, {555555555, -444444444, 2}}, solution, error);
+	std::cout << "Expected: 268861454/67062947599603719 34293553/67062947599603719 " << std::endl;
+	std::cout << "Got: ";
+	printSolution(solution);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: singular system" << std::endl;
+	bool is_solved = modularSolve({{1, 2, 3}, {2, 4, 5}}, solution, error);
+	std::cout << "Expected: 0 and empty error" << std::endl;
+	std::cout << "Got: " << is_solved << " and " << (error == "" ? "empty error" : error) << std::endl;
+}
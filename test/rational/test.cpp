@@ -0,0 +1,42 @@
+#include "../../header/model/rational.h"
+
+#include <iostream>
+
+int main() {
+	rationalNumber a(1, 3);
+	rationalNumber b(-5, 6);
+
+	std::cout << "Test1: plus" << std::endl;
+	std::cout << "Expected: -1/2" << std::endl;
+	std::cout << "Got: " << a + b << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: multiply and divide" << std::endl;
+	std::cout << "Expected: -5/18 and -2/5" << std::endl;
+	std::cout << "Got: " << a * b << " and " << a / b << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: promotion on overflow" << std::endl;
+	rationalNumber c(3037000499LL, 2);
+	rationalNumber d = c * c * c;
+	std::cout << "Expected: 28011385460385661648235251499/8 0" << std::endl;
+	std::cout << "Got: " << d << " " << d.isInline() << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: back inline after cancellation" << std::endl;
+	rationalNumber e = d / (c * c);
+	std::cout << "Expected: 3037000499/2 1" << std::endl;
+	std::cout << "Got: " << e << " " << e.isInline() << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: parse" << std::endl;
+	rationalNumber f;
+	parseRational("-0.25/1.5", f);
+	std::cout << "Expected: -1/6" << std::endl;
+	std::cout << "Got: " << f << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test6: comparisons" << std::endl;
+	std::cout << "Expected: 1 0 1" << std::endl;
+	std::cout << "Got: " << (b < a) << " " << (d < c) << " " << (f == rationalNumber(-1, 6)) << std::endl;
+}
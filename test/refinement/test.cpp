@@ -0,0 +1,72 @@
+#include "../../header/model/refinement.h"
+
+#include <cmath>
+#include <iostream>
+
+// rounded to nine decimals, the refinement reaches double accuracy
+static double rounded(double value) {
+	return std::round(value * 1e9) / 1e9 + 0.0;
+}
+
+static void printSolution(bool is_solved, const std::vector<double>& solution) {
+	std::cout << is_solved << " : ";
+	for (double value : solution) {
+		std::cout << rounded(value) << " ";
+	}
+}
+
+// hilbert matrix of order n with the sums of its rows on the right, so the solution is all ones
+static Matrix<double> hilbertSystem(size_t n) {
+	Matrix<double> system(n, n + 1);
+	for (size_t i = 0; i < n; ++i) {
+		double sum = 0;
+		for (size_t j = 0; j < n; ++j) {
+			system[i][j] = 1.0 / (i + j + 1);
+			sum += system[i][j];
+		}
+		system[i][n] = sum;
+	}
+
+	return system;
+}
+
+int main() {
+	std::string error;
+	std::vector<double> solution;
+	size_t steps = 0;
+	double residual = 0;
+
+	std::cout << "Test1: well conditioned system" << std::endl;
+	Matrix<double> system(3, 4);
+	system[0][0] = 4, system[0][1] = 1, system[0][2] = 0, system[0][3] = 6;
+	system[1][0] = 1, system[1][1] = 3, system[1][2] = 1, system[1][3] = 6;
+	system[2][0] = 0, system[2][1] = 1, system[2][2] = 2, system[2][3] = 0;
+	bool is_solved = refinedSolve(system, solution, steps, residual, error);
+	std::cout << "Expected: 1 : 1 2 -1 steps 1 residual below 1e-14: 1" << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "steps " << steps << " residual below 1e-14: " << (residual < 1e-14) << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: hilbert matrix, float factors need more corrections" << std::endl;
+	is_solved = refinedSolve(hilbertSystem(5), solution, steps, residual, error);
+	std::cout << "Expected: 1 : 1 1 1 1 1 steps 3 residual below 1e-14: 1" << std::endl;
+	std::cout << "Got: ";
+	printSolution(is_solved, solution);
+	std::cout << "steps " << steps << " residual below 1e-14: " << (residual < 1e-14) << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: singular system" << std::endl;
+	Matrix<double> singular(2, 3);
+	singular[0][0] = 1, singular[0][1] = 2, singular[0][2] = 3;
+	singular[1][0] = 2, singular[1][1] = 4, singular[1][2] = 5;
+	is_solved = refinedSolve(singular, solution, steps, residual, error);
+	std::cout << "Expected: 0 and empty error" << std::endl;
+	std::cout << "Got: " << is_solved << " and " << (error == "" ? "empty error" : error) << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: hilbert matrix too ill-conditioned for float factors" << std::endl;
+	is_solved = refinedSolve(hilbertSystem(10), solution, steps, residual, error);
+	std::cout << "Expected: 0 and empty error" << std::endl;
+	std::cout << "Got: " << is_solved << " and " << (error == "" ? "empty error" : error) << std::endl;
+}
@@ -0,0 +1,66 @@
+#include "../../header/model/sketch.h"
+
+#include <cmath>
+#include <iostream>
+
+// rounded to four decimals, the estimates are only as close as their tolerance
+static double rounded(double value) {
+	return std::round(value * 1e4) / 1e4 + 0.0;
+}
+
+// rank one matrices u_k v_k^T summed, so that the rank and the singular values are known
+static Matrix<double> lowRank(size_t rows, size_t cols, size_t rank) {
+	Matrix<double> matrix(rows, cols);
+	for (size_t k = 0; k < rank; ++k) {
+		for (size_t i = 0; i < rows; ++i) {
+			for (size_t j = 0; j < cols; ++j) {
+				matrix[i][j] += std::cos(double((k + 1) * i)) * std::sin(double((k + 2) * j + 1));
+			}
+		}
+	}
+	return matrix;
+}
+
+int main() {
+	std::string error;
+
+	std::cout << "Test1: rank of a sum of three rank one matrices" << std::endl;
+	size_t rank = 0;
+	sketchRank(lowRank(40, 30, 3), 1e-6, 10, rank, error);
+	std::cout << "Expected: 3" << std::endl;
+	std::cout << "Got: " << rank << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: rank of a full rank diagonal matrix" << std::endl;
+	Matrix<double> diagonal(6, 6);
+	for (size_t i = 0; i < 6; ++i) {
+		diagonal[i][i] = 6 - double(i);
+	}
+	sketchRank(diagonal, 1e-6, 10, rank, error);
+	std::cout << "Expected: 6" << std::endl;
+	std::cout << "Got: " << rank << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: leading singular values of the diagonal matrix" << std::endl;
+	std::vector<double> values;
+	sketchSingularValues(diagonal, 2, 4, values, error);
+	std::cout << "Expected: 6 5 " << std::endl;
+	std::cout << "Got: ";
+	for (double value : values) {
+		std::cout << rounded(value) << " ";
+	}
+	std::cout << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: norm of the diagonal matrix" << std::endl;
+	double norm = 0;
+	powerNorm(diagonal, 1e-10, norm, error);
+	std::cout << "Expected: 6" << std::endl;
+	std::cout << "Got: " << rounded(norm) << std::endl;
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: norm of a rank one matrix is |u| |v|" << std::endl;
+	powerNorm(Matrix<double>({{1, 2}, {2, 4}, {2, 4}}), 1e-10, norm, error);
+	std::cout << "Expected: 6.7082" << std::endl;
+	std::cout << "Got: " << rounded(norm) << std::endl;
+}
@@ -0,0 +1,104 @@
+#include "../../header/model/svd.h"
+
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+// rounded to six decimals, so that the last bits of the rotations do not show
+static double rounded(double value) {
+	return std::round(value * 1e6) / 1e6 + 0.0;
+}
+
+static void printValues(const std::vector<double>& values) {
+	for (double value : values) {
+		std::cout << rounded(value) << " ";
+	}
+	std::cout << std::endl;
+}
+
+static void printMatrix(const Matrix<double>& matrix) {
+	for (size_t i = 0; i < matrix.getRow(); ++i) {
+		for (size_t j = 0; j < matrix.getCol(); ++j) {
+			std::cout << rounded(matrix[i][j]) << " ";
+		}
+		std::cout << "; ";
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	std::string error;
+	Matrix<double> u;
+	Matrix<double> v;
+	std::vector<double> sigma;
+
+	std::cout << "Test1: diagonal matrix, singular values in decreasing order" << std::endl;
+	jacobiSvd(Matrix<double>({{3, 0}, {0, -4}}), u, sigma, v, error);
+	std::cout << "Expected: 4 3 " << std::endl;
+	std::cout << "Got: ";
+	printValues(sigma);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test2: tall matrix" << std::endl;
+	Matrix<double> tall({{1, 0}, {0, 1}, {1, 1}});
+	jacobiSvd(tall, u, sigma, v, error);
+	std::cout << "Expected: 1.73205 1 " << std::endl;
+	std::cout << "Got: ";
+	printValues(sigma);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test3: U diag(sigma) V^T gives the matrix back" << std::endl;
+	Matrix<double> product(tall.getRow(), tall.getCol());
+	for (size_t i = 0; i < product.getRow(); ++i) {
+		for (size_t j = 0; j < product.getCol(); ++j) {
+			for (size_t k = 0; k < sigma.size(); ++k) {
+				product[i][j] += u[i][k] * sigma[k] * v[j][k];
+			}
+		}
+	}
+	std::cout << "Expected: 1 0 ; 0 1 ; 1 1 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(product);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test4: rank one matrix" << std::endl;
+	jacobiSvd(Matrix<double>({{1, 1}, {1, 1}}), u, sigma, v, error);
+	std::cout << "Expected: 2 0 " << std::endl;
+	std::cout << "Got: ";
+	printValues(sigma);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test5: complex diagonal matrix" << std::endl;
+	Matrix<std::complex<double>> complex_u;
+	Matrix<std::complex<double>> complex_v;
+	Matrix<std::complex<double>> diagonal(2, 2);
+	diagonal[0][0] = std::complex<double>(0, 1);
+	diagonal[1][1] = std::complex<double>(2, 0);
+	jacobiSvd(diagonal, complex_u, sigma, complex_v, error);
+	std::cout << "Expected: 2 1 " << std::endl;
+	std::cout << "Got: ";
+	printValues(sigma);
+	std::cout << "--------------------" << std::endl;
+
+	Matrix<double> inverse;
+	std::cout << "Test6: pseudo-inverse of an invertible matrix is the inverse" << std::endl;
+	pseudoInverse(Matrix<double>({{1, 2}, {3, 4}}), DBL_EPSILON, inverse, error);
+	std::cout << "Expected: -2 1 ; 1.5 -0.5 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(inverse);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test7: pseudo-inverse of a rank one matrix" << std::endl;
+	pseudoInverse(Matrix<double>({{1, 1}, {1, 1}}), DBL_EPSILON, inverse, error);
+	std::cout << "Expected: 0.25 0.25 ; 0.25 0.25 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(inverse);
+	std::cout << "--------------------" << std::endl;
+
+	std::cout << "Test8: pseudo-inverse of a column" << std::endl;
+	pseudoInverse(Matrix<double>({{1}, {2}, {2}}), DBL_EPSILON, inverse, error);
+	std::cout << "Expected: 0.111111 0.222222 0.222222 ; " << std::endl;
+	std::cout << "Got: ";
+	printMatrix(inverse);
+}